@@ -0,0 +1,192 @@
+#include "drivers/block.hpp"
+#include "drivers/elevator.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+using namespace MiniOS;
+
+namespace {
+
+constexpr SectorNumber DEVICE_SECTORS = 64 * 1024 * 1024 / SECTOR_SIZE;
+constexpr uint32_t PAGE_SECTORS = PAGE_SIZE / SECTOR_SIZE;
+constexpr size_t RANDOM_IOS = 200000;
+constexpr TaskId WRITER_TASK = 1;
+constexpr TaskId READER_TASK = 2;
+
+std::unique_ptr<BlockDevice> makeDevice(bool fileBacked, size_t hardwareQueues) {
+    std::unique_ptr<BlockDevice> device;
+    if (fileBacked) {
+        std::string path = "/tmp/minios-bench-" + std::to_string(::getpid()) + ".img";
+        device = std::make_unique<FileBlockDevice>("file0", path, DEVICE_SECTORS, hardwareQueues);
+    } else {
+        device = std::make_unique<RamDisk>("ram0", DEVICE_SECTORS, hardwareQueues);
+    }
+    device->init();
+    return device;
+}
+
+void removeBacking() {
+    std::string path = "/tmp/minios-bench-" + std::to_string(::getpid()) + ".img";
+    ::unlink(path.c_str());
+}
+
+// Random 4 KB bios from `threads` CPUs, each with its own buffer.
+double runRandomIops(bool fileBacked, BlockOp op, size_t threads) {
+    auto device = makeDevice(fileBacked, threads);
+    BlockQueue queue(*device, threads);
+
+    const size_t each = RANDOM_IOS / threads;
+    std::atomic<uint64_t> completed{0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            InterruptController::setCurrentCpu(static_cast<CpuId>(t));
+            std::vector<uint8_t> buffer(PAGE_SIZE * DEFAULT_PLUG_DEPTH, 0xAB);
+            std::mt19937_64 rng(t + 1);
+            std::uniform_int_distribution<SectorNumber> page(0, DEVICE_SECTORS / PAGE_SECTORS - 1);
+            for (size_t i = 0; i < each; ++i) {
+                Bio bio;
+                bio.op = op;
+                bio.sector = page(rng) * PAGE_SECTORS;
+                bio.segments.push_back({buffer.data() + (i % DEFAULT_PLUG_DEPTH) * PAGE_SIZE,
+                                        static_cast<uint32_t>(PAGE_SIZE)});
+                bio.onComplete = [&completed](BlockStatus) {
+                    completed.fetch_add(1, std::memory_order_relaxed);
+                };
+                queue.submit(std::move(bio));
+            }
+            queue.unplug();
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    queue.run();
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    device->shutdown();
+    removeBacking();
+    return completed / elapsed;
+}
+
+// Streams the whole device in 4 KB bios. Returns MB/s and reports how many
+// requests the driver saw.
+double runSequential(bool fileBacked, BlockOp op, uint32_t maxRequestSectors, uint64_t& requests) {
+    auto device = makeDevice(fileBacked, 1);
+    BlockQueue queue(*device, 1, 128);
+    queue.setMaxRequestSectors(maxRequestSectors);
+
+    std::vector<uint8_t> buffer(PAGE_SIZE * 128, 0xCD);
+    auto start = std::chrono::steady_clock::now();
+    size_t i = 0;
+    for (SectorNumber sector = 0; sector < DEVICE_SECTORS; sector += PAGE_SECTORS, ++i) {
+        Bio bio;
+        bio.op = op;
+        bio.sector = sector;
+        bio.segments.push_back({buffer.data() + (i % 128) * PAGE_SIZE, static_cast<uint32_t>(PAGE_SIZE)});
+        queue.submit(std::move(bio));
+    }
+    queue.run();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    requests = queue.getStats().requests;
+    device->shutdown();
+    removeBacking();
+    return DEVICE_SECTORS * SECTOR_SIZE / (1024.0 * 1024.0) / elapsed;
+}
+
+
+// One task floods random 4 KB writes while another issues a 4 KB read
+// every 32 writes. Each dispatch round runs only 4 requests, so writes
+// pile up in the elevator faster than the device drains them.
+double runMixed(const std::string& elevator, TaskIoStats& reader, TaskIoStats& writer) {
+    auto device = makeDevice(false, 1);
+    BlockQueue queue(*device, 1);
+    queue.setElevator(elevator);
+    queue.setQueueDepth(4);
+
+    std::vector<uint8_t> buffer(PAGE_SIZE * 2, 0xEF);
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<SectorNumber> page(0, DEVICE_SECTORS / PAGE_SECTORS - 1);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < RANDOM_IOS; ++i) {
+        Bio bio;
+        bool read = i % 32 == 31;
+        bio.op = read ? BlockOp::Read : BlockOp::Write;
+        bio.task = read ? READER_TASK : WRITER_TASK;
+        bio.sector = page(rng) * PAGE_SECTORS;
+        bio.segments.push_back({buffer.data() + (read ? PAGE_SIZE : 0), static_cast<uint32_t>(PAGE_SIZE)});
+        queue.submit(std::move(bio));
+    }
+    queue.run();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    reader = queue.getTaskStats(READER_TASK).value_or(TaskIoStats{});
+    writer = queue.getTaskStats(WRITER_TASK).value_or(TaskIoStats{});
+    device->shutdown();
+    return elapsed;
+}
+}
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Critical);
+
+    std::cout << "\n=== Block Layer Benchmarks ===\n\n";
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << "Device size: " << DEVICE_SECTORS * SECTOR_SIZE / (1024 * 1024) << " MB\n\n";
+
+    std::cout << std::setw(10) << "Device" << " | " << std::setw(7) << "Queues" << " | "
+              << std::setw(12) << "Read IOPS" << " | " << std::setw(12) << "Write IOPS" << "\n";
+    std::cout << std::string(50, '-') << "\n";
+    for (bool fileBacked : {false, true}) {
+        for (size_t threads : {1, 4}) {
+            double reads = runRandomIops(fileBacked, BlockOp::Read, threads);
+            double writes = runRandomIops(fileBacked, BlockOp::Write, threads);
+            std::cout << std::setw(10) << (fileBacked ? "file" : "ram") << " | "
+                      << std::setw(7) << threads << " | "
+                      << std::setw(12) << std::fixed << std::setprecision(0) << reads << " | "
+                      << std::setw(12) << writes << "\n";
+        }
+    }
+
+    std::cout << "\n" << std::setw(10) << "Device" << " | " << std::setw(8) << "Merging" << " | "
+              << std::setw(10) << "Read MB/s" << " | " << std::setw(11) << "Write MB/s" << " | "
+              << "Requests" << "\n";
+    std::cout << std::string(60, '-') << "\n";
+    for (bool fileBacked : {false, true}) {
+        for (uint32_t maxSectors : {PAGE_SECTORS, MAX_REQUEST_SECTORS}) {
+            uint64_t requests = 0;
+            double reads = runSequential(fileBacked, BlockOp::Read, maxSectors, requests);
+            double writes = runSequential(fileBacked, BlockOp::Write, maxSectors, requests);
+            std::cout << std::setw(10) << (fileBacked ? "file" : "ram") << " | "
+                      << std::setw(8) << (maxSectors == PAGE_SECTORS ? "off" : "on") << " | "
+                      << std::setw(10) << std::setprecision(0) << reads << " | "
+                      << std::setw(11) << writes << " | " << requests << "\n";
+        }
+    }
+
+    std::cout << "\n" << std::setw(10) << "Elevator" << " | " << std::setw(15) << "Read mean us" << " | "
+              << std::setw(13) << "Read p99 us" << " | " << std::setw(15) << "Write mean us" << " | "
+              << "Total s" << "\n";
+    std::cout << std::string(75, '-') << "\n";
+    for (const char* elevator : {"noop", "deadline", "bfq"}) {
+        TaskIoStats reader;
+        TaskIoStats writer;
+        double elapsed = runMixed(elevator, reader, writer);
+        std::cout << std::setw(10) << elevator << " | "
+                  << std::setw(15) << std::setprecision(1) << reader.meanLatencyMicros() << " | "
+                  << std::setw(13) << reader.latencyPercentile(0.99) / 1000.0 << " | "
+                  << std::setw(15) << writer.meanLatencyMicros() << " | "
+                  << std::setprecision(2) << elapsed << "\n";
+    }
+    std::cout << "\n";
+    return 0;
+}
@@ -0,0 +1,267 @@
+#include "drivers/driver.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+
+using namespace MiniOS;
+
+namespace {
+
+constexpr size_t INTERRUPTS_PER_RUN = 10000000;
+constexpr InterruptNumber DEVICE_IRQ = 3;
+
+double measureEntryNanos(bool rawEntry) {
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    uint64_t handled = 0;
+    if (rawEntry) {
+        controller.registerHandler(DEVICE_IRQ, [](InterruptNumber, void* context, void*) {
+            (*static_cast<uint64_t*>(context))++;
+        }, &handled, "Device");
+    } else {
+        controller.registerHandler(DEVICE_IRQ, [&handled](InterruptNumber, void*) {
+            handled++;
+        }, "Device");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < INTERRUPTS_PER_RUN; ++i) {
+        controller.triggerInterrupt(DEVICE_IRQ);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    if (handled != INTERRUPTS_PER_RUN) {
+        std::cerr << "lost interrupts\n";
+    }
+    return elapsed / INTERRUPTS_PER_RUN;
+}
+
+// Top half counts the event and raises NetRx; the bottom half drains the
+// count every `batch` interrupts. Returns interrupts handled per second.
+double runSplitHandlers(size_t batch) {
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    struct Device {
+        InterruptController* controller;
+        uint64_t pending = 0;
+        uint64_t processed = 0;
+    } device{&controller};
+
+    controller.registerHandler(DEVICE_IRQ, [](InterruptNumber, void* context, void*) {
+        auto* dev = static_cast<Device*>(context);
+        dev->pending++;
+        dev->controller->raiseSoftirq(SoftirqId::NetRx);
+    }, &device, "Device");
+    controller.openSoftirq(SoftirqId::NetRx, [&device]() {
+        device.processed += device.pending;
+        device.pending = 0;
+    }, "NetRx");
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < INTERRUPTS_PER_RUN; ++i) {
+        controller.triggerInterrupt(DEVICE_IRQ);
+        if ((i + 1) % batch == 0) {
+            controller.runSoftirqs();
+        }
+    }
+    controller.runSoftirqs();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (device.processed != INTERRUPTS_PER_RUN) {
+        std::cerr << "lost bottom-half work\n";
+    }
+    return INTERRUPTS_PER_RUN / elapsed;
+}
+
+// Stand-in for the fixed cost of one handler call: reading device status,
+// acknowledging, re-arming.
+void deviceAck() {
+    for (volatile int i = 0; i < 100; i = i + 1) {
+    }
+}
+
+enum class Moderation { None, Fixed, Adaptive };
+
+CoalescingPolicy policyFor(Moderation moderation) {
+    CoalescingPolicy policy;
+    if (moderation == Moderation::Fixed) {
+        policy.maxEvents = 32;
+        policy.maxDelay = std::chrono::microseconds(200);
+    } else if (moderation == Moderation::Adaptive) {
+        policy.maxEvents = 64;
+        policy.maxDelay = std::chrono::microseconds(200);
+        policy.adaptive = true;
+        policy.targetRate = 20000;
+    }
+    return policy;
+}
+
+// CPU time per event when the device fires back to back.
+double measureFloodNanos(Moderation moderation) {
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    uint64_t handled = 0;
+    controller.registerCoalescedHandler(DEVICE_IRQ, [&handled](InterruptNumber, uint32_t events) {
+        deviceAck();
+        handled += events;
+    }, policyFor(moderation), "Device");
+
+    const size_t events = INTERRUPTS_PER_RUN / 10;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < events; ++i) {
+        controller.triggerInterrupt(DEVICE_IRQ);
+    }
+    controller.pollCoalescing(std::chrono::steady_clock::time_point::max());
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    if (handled != events) {
+        std::cerr << "lost coalesced events\n";
+    }
+    return elapsed / events;
+}
+
+// Mean time from an event to the handler seeing it when events arrive
+// every 100 us and the timer is polled continuously, as the main loop does.
+double measureQuietLatencyMicros(Moderation moderation) {
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    const size_t events = 2000;
+    std::vector<std::chrono::steady_clock::time_point> raisedAt(events);
+    double totalMicros = 0;
+    size_t delivered = 0;
+    controller.registerCoalescedHandler(DEVICE_IRQ, [&](InterruptNumber, uint32_t count) {
+        auto now = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; ++i, ++delivered) {
+            totalMicros += std::chrono::duration<double, std::micro>(now - raisedAt[delivered]).count();
+        }
+    }, policyFor(moderation), "Device");
+
+    for (size_t i = 0; i < events; ++i) {
+        raisedAt[i] = std::chrono::steady_clock::now();
+        controller.triggerInterrupt(DEVICE_IRQ);
+        auto next = raisedAt[i] + std::chrono::microseconds(100);
+        while (std::chrono::steady_clock::now() < next) {
+            controller.pollCoalescing();
+        }
+    }
+    controller.pollCoalescing(std::chrono::steady_clock::time_point::max());
+    return totalMicros / std::max<size_t>(delivered, 1);
+}
+
+// Every simulated CPU takes the same vector back to back; returns
+// interrupts handled per second across all of them.
+double runCpuScaling(size_t cpuCount) {
+    InterruptController controller(cpuCount);
+
+    struct alignas(64) PerCpu {
+        uint64_t handled = 0;
+    };
+    std::vector<PerCpu> perCpu(cpuCount);
+    controller.registerHandler(DEVICE_IRQ, [](InterruptNumber, void* context, void*) {
+        static_cast<PerCpu*>(context)[InterruptController::currentCpu()].handled++;
+    }, perCpu.data(), "Device");
+
+    const size_t each = INTERRUPTS_PER_RUN / cpuCount;
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> cpus;
+    for (CpuId c = 0; c < cpuCount; ++c) {
+        cpus.emplace_back([&, c]() {
+            InterruptController::setCurrentCpu(c);
+            controller.enableInterrupts();
+            ready++;
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < each; ++i) {
+                controller.triggerInterrupt(DEVICE_IRQ);
+            }
+        });
+    }
+    while (ready < cpuCount) {
+        std::this_thread::yield();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& cpu : cpus) {
+        cpu.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return each * cpuCount / elapsed;
+}
+
+// Cost of posting an IPI and servicing it on the receiving CPU.
+double measureIpiNanos(size_t iterations) {
+    InterruptController controller(2);
+    uint64_t received = 0;
+    controller.setIpiHandler(IpiType::Reschedule, [&received](CpuId) { received++; });
+
+    std::thread target([&]() {
+        InterruptController::setCurrentCpu(1);
+        controller.enableInterrupts();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            controller.sendIpi(1, IpiType::Reschedule);
+            controller.handlePendingInterrupts();
+        }
+        received = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    });
+    target.join();
+    return double(received) / iterations;
+}
+
+}
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Critical);
+
+    std::cout << "\n=== Interrupt Benchmarks ===\n\n";
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << "Interrupt entry (std::function handler): " << std::fixed << std::setprecision(1)
+              << measureEntryNanos(false) << " ns\n";
+    std::cout << "Interrupt entry (raw entry point):       "
+              << measureEntryNanos(true) << " ns\n";
+
+    std::cout << "\n" << std::setw(10) << "Batch" << " | " << std::setw(16) << "Handlers/sec" << "\n";
+    std::cout << std::string(30, '-') << "\n";
+    for (size_t batch : {1, 16, 256}) {
+        double rate = runSplitHandlers(batch);
+        std::cout << std::setw(10) << batch << " | "
+                  << std::setw(16) << std::setprecision(0) << rate << "\n";
+    }
+
+    std::cout << "\n" << std::setw(10) << "CPUs" << " | " << std::setw(16) << "Interrupts/sec" << "\n";
+    std::cout << std::string(30, '-') << "\n";
+    for (size_t cpus : {1, 2, 4}) {
+        double rate = runCpuScaling(cpus);
+        std::cout << std::setw(10) << cpus << " | "
+                  << std::setw(16) << std::setprecision(0) << rate << "\n";
+    }
+    std::cout << "IPI send + service: " << std::setprecision(1) << measureIpiNanos(1000000) << " ns\n";
+
+    std::cout << "\n" << std::setw(10) << "Moderation" << " | " << std::setw(14) << "Flood ns/event"
+              << " | " << std::setw(16) << "Quiet latency us" << "\n";
+    std::cout << std::string(46, '-') << "\n";
+    const std::pair<Moderation, const char*> modes[] = {
+        {Moderation::None, "none"}, {Moderation::Fixed, "32/200us"}, {Moderation::Adaptive, "adaptive"}};
+    for (const auto& [moderation, label] : modes) {
+        double flood = measureFloodNanos(moderation);
+        double quiet = measureQuietLatencyMicros(moderation);
+        std::cout << std::setw(10) << label << " | "
+                  << std::setw(14) << std::setprecision(1) << flood << " | "
+                  << std::setw(16) << quiet << "\n";
+    }
+    std::cout << "\n";
+    return 0;
+}
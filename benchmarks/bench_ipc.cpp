@@ -0,0 +1,487 @@
+#include "ipc/ipc.hpp"
+#include "ipc/transport.hpp"
+#include "ipc/schema.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace MiniOS;
+
+namespace {
+
+constexpr TaskId RECEIVER_ID = 1000;
+constexpr size_t MESSAGES_PER_RUN = 400000;
+
+double runSenders(int senderCount) {
+    IPCManager ipc;
+    ipc.registerTask(RECEIVER_ID);
+    for (int s = 1; s <= senderCount; ++s) {
+        ipc.registerTask(s);
+    }
+
+    const size_t perSender = MESSAGES_PER_RUN / senderCount;
+    const size_t total = perSender * senderCount;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> senders;
+    for (int s = 1; s <= senderCount; ++s) {
+        senders.emplace_back([&ipc, s, perSender]() {
+            uint64_t value = 0;
+            for (size_t i = 0; i < perSender; ++i) {
+                while (ipc.sendMessage(s, RECEIVER_ID, &value, sizeof(value)) == 0) {
+                    std::this_thread::yield();
+                }
+                value++;
+            }
+        });
+    }
+
+    size_t received = 0;
+    while (received < total) {
+        if (ipc.receiveMessage(RECEIVER_ID, false)) {
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& t : senders) {
+        t.join();
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total / elapsed;
+}
+
+// The receiving kernel runs in a forked child; the parent connects to it and
+// streams messages at a remote TaskId, then waits for the child's reply.
+double runCrossProcess(size_t total) {
+    std::string path = "/tmp/minios-bench-" + std::to_string(::getpid()) + ".sock";
+    const NodeId parentNode = 1;
+    const NodeId childNode = 2;
+
+    pid_t child = ::fork();
+    if (child == 0) {
+        {
+            IPCManager ipc;
+            ipc.registerTask(RECEIVER_ID);
+            IPCTransport transport(ipc, childNode);
+            transport.listen(path);
+
+            TaskId origin = 0;
+            for (size_t received = 0; received < total; ++received) {
+                origin = ipc.receiveMessage(RECEIVER_ID, true)->senderId;
+            }
+            ipc.sendMessage(RECEIVER_ID, origin, nullptr, 0, MessageType::Response);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        ::_exit(0);
+    }
+
+    IPCManager ipc;
+    ipc.registerTask(1);
+    IPCTransport transport(ipc, parentNode);
+    while (!transport.connect(path)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    const TaskId target = remoteTaskId(childNode, RECEIVER_ID);
+    uint64_t value = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < total; ++i) {
+        while (ipc.sendMessage(1, target, &value, sizeof(value)) == 0) {
+            std::this_thread::yield();
+        }
+        value++;
+    }
+    ipc.receiveMessage(1, true);
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ::waitpid(child, nullptr, 0);
+    return total / elapsed;
+}
+
+double runBatchedSender(size_t batchSize) {
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(RECEIVER_ID);
+
+    uint64_t value = 42;
+    std::vector<MessageSpec> specs(batchSize, MessageSpec(&value, sizeof(value)));
+    std::vector<Message> out;
+    out.reserve(batchSize);
+
+    const size_t rounds = MESSAGES_PER_RUN / batchSize;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < rounds; ++r) {
+        if (batchSize == 1) {
+            ipc.sendMessage(1, RECEIVER_ID, &value, sizeof(value));
+            ipc.receiveMessage(RECEIVER_ID, false);
+        } else {
+            ipc.sendBatch(1, RECEIVER_ID, specs);
+            out.clear();
+            ipc.receiveBatch(RECEIVER_ID, batchSize, out);
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (rounds * batchSize) / elapsed;
+}
+
+double runFanOut(size_t subscribers, size_t payloadSize, bool usePublish) {
+    IPCManager ipc;
+    const TaskId publisher = 1;
+    ipc.registerTask(publisher);
+    
+    TopicId topic = ipc.createTopic("fanout");
+    for (size_t i = 0; i < subscribers; ++i) {
+        TaskId sub = static_cast<TaskId>(RECEIVER_ID + i);
+        ipc.registerTask(sub);
+        ipc.subscribe(topic, sub);
+    }
+
+    std::vector<uint8_t> payload(payloadSize, 0xAB);
+    const size_t rounds = 200;
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < rounds; ++r) {
+        if (usePublish) {
+            ipc.publish(topic, publisher, payload.data(), payload.size());
+        } else {
+            for (size_t i = 0; i < subscribers; ++i) {
+                ipc.sendMessage(publisher, static_cast<TaskId>(RECEIVER_ID + i), 
+                                payload.data(), payload.size(), MessageType::Notification);
+            }
+        }
+        for (size_t i = 0; i < subscribers; ++i) {
+            ipc.receiveMessage(static_cast<TaskId>(RECEIVER_ID + i), false);
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / rounds;
+}
+
+double measureRoundTripMicros(size_t iterations) {
+    IPCManager ipc;
+    const TaskId client = 1;
+    const TaskId server = 2;
+    ipc.registerTask(client);
+    ipc.registerTask(server);
+
+    std::thread serverThread([&ipc, iterations]() {
+        for (size_t i = 0; i < iterations; ++i) {
+            auto request = ipc.receiveMessage(server, true);
+            ipc.sendMessage(server, request->senderId, nullptr, 0, MessageType::Response);
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        ipc.sendAndWaitReply(client, server, &i, sizeof(i), std::chrono::milliseconds(1000));
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    serverThread.join();
+    return elapsed / iterations;
+}
+
+double measureCallMicros(size_t iterations) {
+    IPCManager ipc;
+    const TaskId client = 1;
+    const TaskId server = 2;
+    ipc.registerTask(client);
+    ipc.registerTask(server);
+
+    std::thread serverThread([&ipc, iterations]() {
+        auto request = ipc.receiveCall(server);
+        for (size_t i = 1; i < iterations; ++i) {
+            request = ipc.replyWait(server, *request, nullptr, 0);
+        }
+        ipc.reply(server, *request, nullptr, 0);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        ipc.call(client, server, &i, sizeof(i));
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    serverThread.join();
+    return elapsed / iterations;
+}
+
+double runPipelinedCalls(size_t window, size_t total) {
+    IPCManager ipc;
+    const TaskId client = 1;
+    const TaskId server = 2;
+    ipc.registerTask(client);
+    ipc.registerTask(server);
+
+    std::thread serverThread([&ipc, total]() {
+        for (size_t i = 0; i < total; ++i) {
+            auto request = ipc.receiveCall(server);
+            ipc.replyTo(server, request->id, nullptr, 0);
+        }
+    });
+
+    std::vector<ReplyFuture> inFlight;
+    inFlight.reserve(window);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < total; sent += window) {
+        for (size_t i = 0; i < window; ++i) {
+            inFlight.push_back(ipc.callAsync(client, server, &i, sizeof(i)));
+        }
+        for (auto& future : inFlight) {
+            future.get();
+        }
+        inFlight.clear();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    serverThread.join();
+    return total / elapsed;
+}
+
+void measureWaitLatency(size_t portCount, double& waitSetMicros, double& scanMicros) {
+    IPCManager ipc;
+    const TaskId owner = 1;
+    Handle waitSet = ipc.createWaitSet(owner);
+    std::vector<Handle> ports;
+    for (size_t i = 0; i < portCount; ++i) {
+        ports.push_back(ipc.createPort(owner));
+        ipc.waitSetAdd(owner, waitSet, ports.back(), i);
+    }
+
+    const size_t rounds = 2000;
+    std::vector<WaitEvent> events;
+    uint64_t value = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        Handle target = ports[(r * 7919) % portCount];
+        ipc.sendToPort(owner, target, &value, sizeof(value));
+        events.clear();
+        ipc.waitForEvents(owner, waitSet, events, 16);
+        ipc.receiveFromPort(owner, events[0].handle);
+    }
+    waitSetMicros = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / rounds;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        Handle target = ports[(r * 7919) % portCount];
+        ipc.sendToPort(owner, target, &value, sizeof(value));
+        for (Handle port : ports) {
+            if (ipc.receiveFromPort(owner, port)) {
+                break;
+            }
+        }
+    }
+    scanMicros = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+void measureDoorbell(double& notifyNanos, double& messageNanos) {
+    IPCManager ipc;
+    const TaskId owner = 1;
+    ipc.registerTask(owner);
+    Handle doorbell = ipc.createNotification(owner);
+
+    const size_t rounds = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        ipc.signal(owner, doorbell, 1ull << (r & 63));
+        ipc.waitNotification(owner, doorbell, Deadline::min());
+    }
+    notifyNanos = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / rounds;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        ipc.sendMessage(owner, owner, nullptr, 0, MessageType::Signal);
+        ipc.receiveMessage(owner, false);
+    }
+    messageNanos = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / rounds;
+}
+
+struct TelemetryStruct {
+    uint32_t sensor;
+    double value;
+    uint16_t samples[1000];
+};
+
+using TelemetrySchema = Schema<1, 1, Scalar<uint32_t>, Scalar<double>, Array<uint16_t>>;
+
+// Builds and reads a ~2 KB structured payload: once as a struct copied in
+// with setData and out with getData, once through a builder and a view.
+void measureSchemaAccess(double& copyNanos, double& viewNanos) {
+    const size_t rounds = 200000;
+    uint64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        TelemetryStruct out{};
+        out.sensor = static_cast<uint32_t>(r);
+        out.value = 1.5;
+        out.samples[r % 1000] = 7;
+        Message msg(1, 1, 2, MessageType::Data);
+        msg.setData(out);
+        auto in = msg.getData<TelemetryStruct>();
+        checksum += in->sensor + in->samples[r % 1000];
+    }
+    copyNanos = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / rounds;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        Message msg(1, 1, 2, MessageType::Data);
+        SchemaBuilder<TelemetrySchema> builder(msg, {1000});
+        builder.set<0>(static_cast<uint32_t>(r));
+        builder.set<1>(1.5);
+        builder.setElement<2>(r % 1000, 7);
+        auto view = viewAs<TelemetrySchema>(msg);
+        checksum += view->get<0>() + view->array<2>()[r % 1000];
+    }
+    viewNanos = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count() / rounds;
+
+    if (checksum == 0) {
+        std::cout << "";
+    }
+}
+
+void measureControlLatency(double& controlMicros, double& dataMicros) {
+    IPCManager ipc;
+    const TaskId producer = 1;
+    ipc.registerTask(producer);
+    ipc.registerTask(RECEIVER_ID);
+
+    const size_t total = 200000;
+    const size_t signalEvery = 1000;
+
+    std::thread producerThread([&ipc, total]() {
+        uint64_t value = 0;
+        for (size_t i = 0; i < total; ++i) {
+            MessageType type = (i % signalEvery == 0) ? MessageType::Signal : MessageType::Data;
+            while (ipc.sendMessage(producer, RECEIVER_ID, &value, sizeof(value), type) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    double controlTotal = 0;
+    double dataTotal = 0;
+    size_t controlCount = 0;
+    size_t received = 0;
+    std::vector<Message> out;
+    while (received < total) {
+        out.clear();
+        size_t count = ipc.receiveBatch(RECEIVER_ID, 64, out);
+        auto now = std::chrono::steady_clock::now();
+        for (const auto& msg : out) {
+            double waited = std::chrono::duration<double, std::micro>(now - msg.timestamp).count();
+            if (msg.type == MessageType::Signal) {
+                controlTotal += waited;
+                controlCount++;
+            } else {
+                dataTotal += waited;
+            }
+        }
+        received += count;
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+    }
+    producerThread.join();
+
+    controlMicros = controlTotal / controlCount;
+    dataMicros = dataTotal / (total - controlCount);
+}
+
+}
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Critical);
+
+    std::cout << "\n=== IPC Benchmarks ===\n\n";
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+    std::cout << std::setw(10) << "Senders" << " | " << std::setw(14) << "Messages/sec" << "\n";
+    std::cout << std::string(28, '-') << "\n";
+
+    for (int senders : {1, 2, 4, 8}) {
+        double rate = runSenders(senders);
+        std::cout << std::setw(10) << senders << " | "
+                  << std::setw(14) << std::fixed << std::setprecision(0) << rate << "\n";
+    }
+
+    std::cout << "\nCross-process (shm ring + doorbell): " << std::setprecision(0)
+              << runCrossProcess(MESSAGES_PER_RUN) << " messages/sec\n";
+
+    std::cout << "\n" << std::setw(10) << "Batch" << " | " << std::setw(14) << "Messages/sec" << "\n";
+    std::cout << std::string(28, '-') << "\n";
+    for (size_t batch : {1, 8, 32, 128}) {
+        double rate = runBatchedSender(batch);
+        std::cout << std::setw(10) << batch << " | "
+                  << std::setw(14) << std::fixed << std::setprecision(0) << rate << "\n";
+    }
+
+    std::cout << "\n" << std::setw(10) << "Fan-out" << " | " << std::setw(14) << "Unicast us" 
+              << " | " << std::setw(14) << "Publish us" << "\n";
+    std::cout << std::string(46, '-') << "\n";
+    for (size_t payloadSize : {size_t(16), size_t(1024)}) {
+        double unicast = runFanOut(500, payloadSize, false);
+        double published = runFanOut(500, payloadSize, true);
+        std::cout << std::setw(6) << payloadSize << " B  | " 
+                  << std::setw(14) << std::setprecision(1) << unicast << " | "
+                  << std::setw(14) << published << "\n";
+    }
+
+    std::cout << "\nRPC round trip (sendAndWaitReply): " << std::setprecision(2)
+              << measureRoundTripMicros(20000) << " us\n";
+    std::cout << "RPC round trip (call/replyWait):    " << std::setprecision(2)
+              << measureCallMicros(20000) << " us\n";
+
+    double controlMicros = 0;
+    double dataMicros = 0;
+    measureControlLatency(controlMicros, dataMicros);
+    std::cout << "Queueing delay under saturation: control " << std::setprecision(1) << controlMicros
+              << " us, data " << dataMicros << " us\n";
+
+    double waitSetMicros = 0;
+    double scanMicros = 0;
+    measureWaitLatency(10000, waitSetMicros, scanMicros);
+    std::cout << "Readiness over 10000 ports: wait set " << std::setprecision(2) << waitSetMicros
+              << " us, polling " << scanMicros << " us\n";
+
+    double notifyNanos = 0;
+    double messageNanos = 0;
+    measureDoorbell(notifyNanos, messageNanos);
+    std::cout << "Doorbell signal + take: " << std::setprecision(0) << notifyNanos
+              << " ns, empty Signal message: " << messageNanos << " ns\n";
+
+    double copyNanos = 0;
+    double viewNanos = 0;
+    measureSchemaAccess(copyNanos, viewNanos);
+    std::cout << "2 KB structured payload: setData/getData " << std::setprecision(0) << copyNanos
+              << " ns, schema builder/view " << viewNanos << " ns\n";
+
+    std::cout << "\n" << std::setw(10) << "Window" << " | " << std::setw(14) << "Calls/sec" << "\n";
+    std::cout << std::string(28, '-') << "\n";
+    for (size_t window : {1, 16, 256}) {
+        double rate = runPipelinedCalls(window, 51200);
+        std::cout << std::setw(10) << window << " | "
+                  << std::setw(14) << std::setprecision(0) << rate << "\n";
+    }
+    std::cout << "\n";
+    return 0;
+}
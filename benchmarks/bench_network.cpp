@@ -0,0 +1,128 @@
+#include "drivers/network.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <atomic>
+
+using namespace MiniOS;
+
+namespace {
+
+constexpr size_t PACKETS_PER_RUN = 5000000;
+constexpr uint32_t PACKET_SIZE = 64;
+constexpr InterruptNumber NIC_IRQ = 40;
+
+struct RunResult {
+    double packetsPerSecond;
+    double packetsPerInterrupt;
+};
+
+// Send `batch` packets, then service the interrupt and NetRx the way the
+// kernel main loop does, all on one CPU.
+RunResult runLoopback(size_t batch) {
+    InterruptController controller;
+    controller.enableInterrupts();
+    NetworkStack stack(controller);
+    VirtualNic nic("lo", std::make_shared<FramePool>(4096), 1024);
+    nic.init();
+    stack.attach(nic, NIC_IRQ);
+
+    uint64_t received = 0;
+    nic.setReceiveHandler([&received](const PacketView*, size_t count) { received += count; });
+
+    std::vector<uint8_t> payload(PACKET_SIZE, 0x5A);
+    std::vector<PacketView> packets(batch, PacketView{payload.data(), PACKET_SIZE});
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < PACKETS_PER_RUN;) {
+        sent += nic.transmit(packets.data(), std::min(batch, PACKETS_PER_RUN - sent));
+        controller.handlePendingInterrupts();
+        controller.runSoftirqs();
+    }
+    while (received < PACKETS_PER_RUN) {
+        controller.runSoftirqs();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    NicStats stats = nic.getStats();
+    return {received / elapsed, double(stats.rxPackets) / std::max<uint64_t>(stats.interrupts, 1)};
+}
+
+// veth0 on CPU 0 sends to veth1, whose interrupt is routed to CPU 1.
+RunResult runPair(size_t batch) {
+    InterruptController controller(2);
+    NetworkStack stack(controller);
+    auto pool = std::make_shared<FramePool>(4096);
+    VirtualNic sender("veth0", pool, 1024);
+    VirtualNic receiver("veth1", pool, 1024);
+    VirtualNic::connect(sender, receiver);
+    sender.init();
+    receiver.init();
+    stack.attach(receiver, NIC_IRQ);
+    controller.setAffinity(NIC_IRQ, CpuMask(1) << 1);
+
+    std::atomic<uint64_t> received{0};
+    receiver.setReceiveHandler([&received](const PacketView*, size_t count) {
+        received.fetch_add(count, std::memory_order_relaxed);
+    });
+
+    std::atomic<bool> ready{false};
+    std::thread cpu1([&]() {
+        InterruptController::setCurrentCpu(1);
+        controller.enableInterrupts();
+        ready = true;
+        while (received.load(std::memory_order_relaxed) < PACKETS_PER_RUN) {
+            controller.handlePendingInterrupts();
+            controller.runSoftirqs();
+        }
+    });
+    while (!ready) {
+        std::this_thread::yield();
+    }
+
+    std::vector<uint8_t> payload(PACKET_SIZE, 0x5A);
+    std::vector<PacketView> packets(batch, PacketView{payload.data(), PACKET_SIZE});
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < PACKETS_PER_RUN;) {
+        size_t accepted = sender.transmit(packets.data(), std::min(batch, PACKETS_PER_RUN - sent));
+        sent += accepted;
+        if (accepted == 0) {
+            std::this_thread::yield();
+        }
+    }
+    cpu1.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    NicStats stats = receiver.getStats();
+    return {received / elapsed, double(stats.rxPackets) / std::max<uint64_t>(stats.interrupts, 1)};
+}
+
+}
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Critical);
+
+    std::cout << "\n=== Network Benchmarks ===\n\n";
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << "Packet size: " << PACKET_SIZE << " bytes\n\n";
+
+    std::cout << std::setw(10) << "Backend" << " | " << std::setw(6) << "Batch" << " | "
+              << std::setw(12) << "Packets/sec" << " | " << std::setw(16) << "Packets/interrupt" << "\n";
+    std::cout << std::string(53, '-') << "\n";
+    for (size_t batch : {1, 8, 64, 256}) {
+        RunResult loopback = runLoopback(batch);
+        std::cout << std::setw(10) << "loopback" << " | " << std::setw(6) << batch << " | "
+                  << std::setw(12) << std::fixed << std::setprecision(0) << loopback.packetsPerSecond << " | "
+                  << std::setw(16) << std::setprecision(1) << loopback.packetsPerInterrupt << "\n";
+    }
+    for (size_t batch : {1, 64}) {
+        RunResult pair = runPair(batch);
+        std::cout << std::setw(10) << "pair" << " | " << std::setw(6) << batch << " | "
+                  << std::setw(12) << std::setprecision(0) << pair.packetsPerSecond << " | "
+                  << std::setw(16) << std::setprecision(1) << pair.packetsPerInterrupt << "\n";
+    }
+    std::cout << "\n";
+    return 0;
+}
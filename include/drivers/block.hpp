@@ -0,0 +1,234 @@
+#pragma once
+
+#include "drivers/driver.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MiniOS {
+
+using SectorNumber = uint64_t;
+
+constexpr size_t SECTOR_SIZE = 512;
+// Merged requests are capped at this many sectors (512 KB).
+constexpr uint32_t MAX_REQUEST_SECTORS = 1024;
+// A software queue is dispatched once this many bios are waiting on it.
+constexpr size_t DEFAULT_PLUG_DEPTH = 32;
+// Requests handed to the driver per dispatch round, like hardware tags.
+constexpr size_t DEFAULT_QUEUE_DEPTH = 64;
+constexpr size_t IO_LATENCY_BUCKETS = 32;
+
+constexpr uint32_t BLOCK_IOCTL_GET_SECTORS = 0;
+constexpr uint32_t BLOCK_IOCTL_SEEK = 1;
+
+enum class BlockOp {
+    Read,
+    Write,
+    // Orders everything submitted before it ahead of everything after it.
+    Flush
+};
+
+enum class BlockStatus {
+    Ok,
+    IoError,
+    OutOfRange,
+    Invalid
+};
+
+// One scatter-gather element. Bio lengths must add up to whole sectors.
+struct BioSegment {
+    uint8_t* data;
+    uint32_t length;
+};
+
+using BioCompletion = std::function<void(BlockStatus)>;
+
+// A single I/O as submitted: a run of sectors and the memory it moves
+// to or from. onComplete runs on whichever thread dispatched it.
+struct Bio {
+    BlockOp op = BlockOp::Read;
+    SectorNumber sector = 0;
+    std::vector<BioSegment> segments;
+    BioCompletion onComplete;
+    // Who the I/O is charged to by the elevator and the latency stats.
+    TaskId task = 0;
+    // Set by BlockQueue::submit().
+    std::chrono::steady_clock::time_point submittedAt;
+
+    uint32_t sectorCount() const;
+};
+
+// What a driver executes: contiguous bios of the same op and task, merged
+// by the request queue and kept in sector order.
+struct BlockRequest {
+    BlockOp op;
+    SectorNumber sector;
+    uint32_t sectors;
+    TaskId task;
+    std::vector<Bio> bios;
+};
+
+// A DriverType::Block device. The block layer drives it through
+// execute(); the byte-stream read()/write() inherited from Driver work on
+// whole sectors at a position set with BLOCK_IOCTL_SEEK.
+class BlockDevice : public Driver {
+public:
+    BlockDevice(const std::string& name, SectorNumber sectors, size_t hardwareQueues = 1);
+    ~BlockDevice() override = default;
+
+    ssize_t read(void* buffer, size_t count) override;
+    ssize_t write(const void* buffer, size_t count) override;
+    bool ioctl(uint32_t command, void* arg) override;
+
+    // Runs one request to completion. May be called concurrently for
+    // different hardware queues.
+    virtual BlockStatus execute(size_t hardwareQueue, BlockRequest& request) = 0;
+
+    SectorNumber getSectorCount() const { return sectors_; }
+    size_t getHardwareQueueCount() const { return hardwareQueues_; }
+
+protected:
+    SectorNumber sectors_;
+    size_t hardwareQueues_;
+    SectorNumber position_;
+};
+
+class RamDisk : public BlockDevice {
+public:
+    RamDisk(const std::string& name, SectorNumber sectors, size_t hardwareQueues = 1);
+    ~RamDisk() override = default;
+
+    bool init() override;
+    bool shutdown() override;
+    BlockStatus execute(size_t hardwareQueue, BlockRequest& request) override;
+
+private:
+    std::unique_ptr<uint8_t[]> memory_;
+};
+
+// Backed by a host file, created and sized on init(). Each request is one
+// preadv/pwritev, so merging directly cuts the number of host syscalls.
+class FileBlockDevice : public BlockDevice {
+public:
+    FileBlockDevice(const std::string& name, const std::string& path, SectorNumber sectors,
+                    size_t hardwareQueues = 1);
+    ~FileBlockDevice() override;
+
+    bool init() override;
+    bool shutdown() override;
+    BlockStatus execute(size_t hardwareQueue, BlockRequest& request) override;
+
+private:
+    std::string path_;
+    int fd_;
+};
+
+struct BlockQueueStats {
+    uint64_t bios;
+    uint64_t requests;
+    uint64_t merges;
+    uint64_t sectors;
+    uint64_t errors;
+};
+
+// Submit-to-completion latency of one task's bios on one queue.
+struct TaskIoStats {
+    uint64_t ios = 0;
+    uint64_t sectors = 0;
+    uint64_t totalLatencyNs = 0;
+    uint64_t maxLatencyNs = 0;
+    // Bucket b counts latencies in [2^b, 2^(b+1)) ns.
+    std::array<uint64_t, IO_LATENCY_BUCKETS> latency{};
+
+    double meanLatencyMicros() const { return ios ? totalLatencyNs / 1000.0 / ios : 0; }
+    // Upper bound of the bucket holding the given quantile, 0 when empty.
+    uint64_t latencyPercentile(double quantile) const;
+};
+
+class Elevator;
+
+// Multi-queue request queue for one device. Bios are staged on the
+// submitting CPU's software queue; when it is unplugged the batch is
+// sorted by sector, adjacent bios of the same op and task are merged, and
+// the resulting requests are handed to the device's elevator. Each
+// dispatch round then takes up to queueDepth requests in the order the
+// elevator picks and runs them on the hardware queue the dispatching CPU
+// maps to. Bios that overlap while both are in flight complete in no
+// particular order.
+class BlockQueue {
+public:
+    explicit BlockQueue(BlockDevice& device, size_t cpuCount = 1,
+                        size_t plugDepth = DEFAULT_PLUG_DEPTH);
+    ~BlockQueue();
+
+    BlockQueue(const BlockQueue&) = delete;
+    BlockQueue& operator=(const BlockQueue&) = delete;
+
+    // Rejects bios outside the device or not made of whole sectors; the
+    // completion is not called in that case.
+    bool submit(Bio bio);
+    // Hands the calling CPU's staged bios to the elevator and runs one
+    // dispatch round; returns requests dispatched.
+    size_t unplug();
+    // Hands every CPU's staged bios to the elevator and dispatches until
+    // it is empty.
+    size_t run();
+    // Submits, dispatches and returns the bio's status.
+    BlockStatus submitAndWait(Bio bio);
+
+    // Requests already queued move over to the new elevator.
+    bool setElevator(std::unique_ptr<Elevator> elevator);
+    bool setElevator(const std::string& name);
+    std::string getElevatorName() const;
+    size_t getPendingRequests() const;
+
+    void setMaxRequestSectors(uint32_t sectors) { maxRequestSectors_ = std::max<uint32_t>(sectors, 1); }
+    void setQueueDepth(size_t depth) { queueDepth_ = std::max<size_t>(depth, 1); }
+    BlockQueueStats getStats() const;
+    std::optional<TaskIoStats> getTaskStats(TaskId task) const;
+    std::string getQueueReport() const;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) SoftwareQueue {
+        std::mutex mutex;
+        std::vector<Bio> staged;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) HardwareQueue {
+        std::mutex mutex;
+        std::atomic<uint64_t> requests{0};
+    };
+
+    size_t flushPlug(std::vector<Bio>& bios);
+    void mergeRun(std::vector<Bio>& bios, size_t begin, size_t end, std::vector<BlockRequest>& requests);
+    size_t dispatchRound(size_t maxRequests);
+    void execute(std::vector<BlockRequest>& requests);
+
+    BlockDevice& device_;
+    size_t plugDepth_;
+    size_t queueDepth_;
+    uint32_t maxRequestSectors_;
+    std::vector<std::unique_ptr<SoftwareQueue>> softwareQueues_;
+    std::vector<std::unique_ptr<HardwareQueue>> hardwareQueues_;
+
+    mutable std::mutex elevatorMutex_;
+    std::unique_ptr<Elevator> elevator_;
+
+    std::atomic<uint64_t> bios_;
+    std::atomic<uint64_t> merges_;
+    std::atomic<uint64_t> sectors_;
+    std::atomic<uint64_t> errors_;
+
+    mutable std::mutex taskStatsMutex_;
+    std::unordered_map<TaskId, TaskIoStats> taskStats_;
+};
+
+}
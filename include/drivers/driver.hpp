@@ -2,11 +2,16 @@
 
 #include "kernel/types.hpp"
 #include "utils/logger.hpp"
+#include <array>
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <functional>
 #include <queue>
 #include <memory>
+#include <optional>
+#include <chrono>
 
 namespace MiniOS {
 
@@ -20,43 +25,249 @@ enum class InterruptType {
     GeneralProtection = 13
 };
 
+constexpr size_t INTERRUPT_VECTORS = 256;
+constexpr size_t SOFTIRQ_VECTORS = 32;
+// runSoftirqs() re-checks for newly raised softirqs this many times before
+// leaving the rest for its next call.
+constexpr size_t SOFTIRQ_MAX_RESTART = 10;
+constexpr size_t MAX_CPUS = 64;
+
+using CpuId = uint32_t;
+using CpuMask = uint64_t;
+constexpr CpuMask ALL_CPUS = ~CpuMask(0);
+
 using InterruptHandler = std::function<void(InterruptNumber, void*)>;
+// Top-half entry point. Registered with a context pointer so the dispatch
+// is one indirect call with no std::function in between.
+using InterruptEntry = void (*)(InterruptNumber, void* context, void* data);
+using SoftirqHandler = std::function<void()>;
+// Receives the number of events folded into this invocation.
+using CoalescedHandler = std::function<void(InterruptNumber, uint32_t events)>;
+// Runs on the CPU that received the IPI.
+using IpiHandler = std::function<void(CpuId)>;
+
+// Bottom halves in the order runSoftirqs() services them.
+enum class SoftirqId : uint32_t {
+    Timer = 0,
+    NetTx = 1,
+    NetRx = 2,
+    Block = 3,
+    Tasklet = 4
+};
+
+enum class IpiType : uint32_t {
+    Reschedule = 0,
+    // Runs the functions queued with callOnCpu().
+    CallFunction = 1
+};
 
+// `enabled` and `affinity` may change while other CPUs take the interrupt;
+// the entry point itself is only set up before interrupts are enabled.
 struct InterruptDescriptor {
-    InterruptNumber number;
+    InterruptEntry entry = nullptr;
+    void* context = nullptr;
+    std::atomic<bool> enabled{false};
+    std::atomic<CpuMask> affinity{ALL_CPUS};
+    // Calls into the vector still running; unregistering waits for zero.
+    mutable std::atomic<uint32_t> inFlight{0};
     InterruptHandler handler;
     std::string name;
-    uint64_t triggerCount;
-    bool enabled;
+};
+
+// Fire after maxEvents events or maxDelay after the first of them, whichever
+// comes first; a zero delay waits for the count alone. With adaptive set,
+// maxEvents is only the ceiling: the live threshold follows the observed
+// event rate so the handler runs about targetRate times a second under
+// load and once per event when the device is quiet.
+struct CoalescingPolicy {
+    uint32_t maxEvents = 1;
+    std::chrono::microseconds maxDelay{0};
+    bool adaptive = false;
+    uint32_t targetRate = 10000;
+};
 
-    InterruptDescriptor(InterruptNumber num, InterruptHandler h, const std::string& n)
-        : number(num), handler(std::move(h)), name(n), triggerCount(0), enabled(true) {}
+struct CoalescingStats {
+    uint64_t events;
+    uint64_t deliveries;
+    uint32_t threshold;
 };
 
+// Deferred work scheduled from a top half. Scheduling one that is already
+// pending is a no-op, so it runs once however many interrupts asked for it.
+struct Tasklet {
+    explicit Tasklet(std::function<void()> fn) : function(std::move(fn)) {}
+
+    std::function<void()> function;
+    std::atomic<bool> scheduled{false};
+    Tasklet* next = nullptr;
+    uint64_t runCount = 0;
+};
+
+// Interrupts are split Linux-style: the top half registered per vector runs
+// inline in triggerInterrupt() and should only acknowledge the device and
+// raise a softirq or schedule a tasklet. The kernel's main loop drains
+// pending bottom halves in batches through runSoftirqs().
+//
+// Each simulated CPU is a thread that has called setCurrentCpu(); threads
+// that never do act as CPU 0. Enable state, counters, pending softirqs and
+// tasklets are per CPU and only written by that CPU, so CPUs never contend
+// on the interrupt path. Reports sum the per-CPU counters when read.
+// Handlers are registered before interrupts are enabled.
 class InterruptController {
 public:
-    InterruptController();
-    ~InterruptController() = default;
+    explicit InterruptController(size_t cpuCount = 1);
+    ~InterruptController();
+
+    static void setCurrentCpu(CpuId cpu);
+    static CpuId currentCpu();
+    size_t getCpuCount() const { return cpus_.size(); }
 
     bool registerHandler(InterruptNumber interrupt, InterruptHandler handler, const std::string& name);
+    bool registerHandler(InterruptNumber interrupt, InterruptEntry entry, void* context,
+                         const std::string& name);
+    // A coalesced vector routed to several CPUs batches per CPU and may run
+    // its handler on two of them at once.
+    bool registerCoalescedHandler(InterruptNumber interrupt, CoalescedHandler handler,
+                                  const CoalescingPolicy& policy, const std::string& name);
+    // Disables the vector and waits for calls already inside it to return,
+    // so the handler and its coalescing state can be freed. Never call it
+    // from the vector's own handler.
     bool unregisterHandler(InterruptNumber interrupt);
     
+    // Takes the interrupt on the calling CPU.
     void triggerInterrupt(InterruptNumber interrupt, void* data = nullptr);
+    // Device side: posts the interrupt to a CPU in the vector's affinity
+    // mask, preferring the caller's, and returns that CPU. It runs there
+    // at the next handlePendingInterrupts() with no data pointer.
+    std::optional<CpuId> raiseInterrupt(InterruptNumber interrupt);
+    // Services posted interrupts and IPIs on the calling CPU while its
+    // interrupts are enabled; returns how many ran.
+    size_t handlePendingInterrupts();
     
     void enableInterrupt(InterruptNumber interrupt);
     void disableInterrupt(InterruptNumber interrupt);
     bool isEnabled(InterruptNumber interrupt) const;
+    bool setAffinity(InterruptNumber interrupt, CpuMask mask);
+    CpuMask getAffinity(InterruptNumber interrupt) const;
 
+    // These act on the calling CPU.
     void enableInterrupts();
     void disableInterrupts();
-    bool areInterruptsEnabled() const { return interruptsEnabled_; }
+    bool areInterruptsEnabled() const;
 
+    void setIpiHandler(IpiType type, IpiHandler handler);
+    bool sendIpi(CpuId cpu, IpiType type);
+    bool callOnCpu(CpuId cpu, std::function<void()> function);
+
+    bool openSoftirq(SoftirqId id, SoftirqHandler handler, const std::string& name);
+    // Call while no CPU can be running the softirq.
+    bool closeSoftirq(SoftirqId id);
+    // Raises on the calling CPU; safe from any thread.
+    void raiseSoftirq(SoftirqId id) {
+        localCpu().pendingSoftirqs.fetch_or(1u << static_cast<uint32_t>(id), std::memory_order_release);
+    }
+    void scheduleTasklet(Tasklet& tasklet);
+    bool hasPendingSoftirqs() const {
+        return localCpu().pendingSoftirqs.load(std::memory_order_acquire) != 0;
+    }
+    // Runs every softirq pending on the calling CPU; returns how many ran.
+    size_t runSoftirqs();
+
+    // Resets every CPU's moderation state; call while the vector is quiet.
+    bool setCoalescingPolicy(InterruptNumber interrupt, const CoalescingPolicy& policy);
+    // Sums events and calls over all CPUs; threshold is the highest of them.
+    std::optional<CoalescingStats> getCoalescingStats(InterruptNumber interrupt) const;
+    // Delivers every batch on the calling CPU whose delay has run out;
+    // returns how many.
+    size_t pollCoalescing(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    uint64_t getInterruptCount(InterruptNumber interrupt) const;
+    uint64_t getInterruptCount(InterruptNumber interrupt, CpuId cpu) const;
     std::string getInterruptReport() const;
 
 private:
-    std::map<InterruptNumber, InterruptDescriptor> handlers_;
-    bool interruptsEnabled_;
-    uint64_t totalInterrupts_;
+    struct Softirq {
+        SoftirqHandler handler;
+        std::string name;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) CpuState {
+        std::atomic<bool> interruptsEnabled{false};
+        std::atomic<uint64_t> handled{0};
+        std::atomic<uint64_t> ignored{0};
+        std::atomic<uint64_t> ipis{0};
+        std::atomic<uint64_t> softirqBatches{0};
+        std::atomic<uint64_t> softirqDeferrals{0};
+        std::array<std::atomic<uint64_t>, INTERRUPT_VECTORS> counts{};
+        std::array<std::atomic<uint64_t>, SOFTIRQ_VECTORS> softirqRuns{};
+
+        // Written by other CPUs.
+        alignas(CACHE_LINE_SIZE) std::array<std::atomic<uint64_t>, INTERRUPT_VECTORS / 64> pendingIrqs{};
+        std::atomic<uint32_t> pendingIpis{0};
+        std::atomic<uint32_t> pendingSoftirqs{0};
+        std::atomic<Tasklet*> tasklets{nullptr};
+        std::mutex callMutex;
+        std::vector<std::function<void()>> calls;
+    };
+
+    // Each CPU moderates the events it takes on its own, with its own rate
+    // estimate, so the coalescing path needs no lock.
+    struct alignas(CACHE_LINE_SIZE) CoalescingState {
+        uint32_t pending = 0;
+        std::atomic<uint32_t> threshold{1};
+        std::chrono::steady_clock::time_point firstEventAt;
+        std::chrono::steady_clock::time_point lastDeliveryAt;
+        double eventRate = 0;
+        std::atomic<uint64_t> events{0};
+        std::atomic<uint64_t> deliveries{0};
+    };
+
+    struct Coalescer {
+        Coalescer(InterruptNumber irq, size_t cpuCount) : interrupt(irq), cpus(cpuCount) {}
+
+        InterruptNumber interrupt;
+        CoalescedHandler handler;
+        CoalescingPolicy policy;
+        std::vector<CoalescingState> cpus;
+
+        void reset(const CoalescingPolicy& newPolicy);
+    };
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    CpuId localCpuId() const;
+    CpuState& localCpu() const;
+    static void invokeHandler(InterruptNumber interrupt, void* context, void* data);
+    bool installHandler(InterruptNumber interrupt, InterruptEntry entry, void* context,
+                        InterruptHandler handler, const std::string& name);
+    static void coalesceEvent(InterruptNumber interrupt, void* context, void* data);
+    static void deliverBatch(Coalescer& coalescer, CoalescingState& state,
+                             std::chrono::steady_clock::time_point now);
+    Coalescer* findCoalescer(InterruptNumber interrupt) const;
+    // A pinned vector cannot finish unregistering; pin before reading its
+    // entry or coalescer and unpin once done with them.
+    void pinVector(InterruptNumber interrupt) const {
+        vectors_[interrupt].inFlight.fetch_add(1, std::memory_order_seq_cst);
+    }
+    void unpinVector(InterruptNumber interrupt) const {
+        vectors_[interrupt].inFlight.fetch_sub(1, std::memory_order_release);
+    }
+    void dispatch(CpuState& cpu, InterruptNumber interrupt, void* data);
+    void runTasklets();
+    void runCalls(CpuState& cpu);
+
+    std::vector<std::unique_ptr<CpuState>> cpus_;
+    CpuMask onlineMask_;
+    std::array<InterruptDescriptor, INTERRUPT_VECTORS> vectors_;
+    size_t registeredCount_;
+
+    // Owned; a slot is cleared before its coalescer is freed.
+    std::array<std::atomic<Coalescer*>, INTERRUPT_VECTORS> coalescers_{};
+    std::array<std::atomic<uint64_t>, INTERRUPT_VECTORS / 64> coalescedVectors_{};
+    std::array<Softirq, SOFTIRQ_VECTORS> softirqs_;
+    std::array<IpiHandler, 2> ipiHandlers_;
 };
 
 enum class DriverType {
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "drivers/block.hpp"
+#include <chrono>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace MiniOS {
+
+// Defaults follow Linux mq-deadline.
+constexpr std::chrono::milliseconds DEADLINE_READ_EXPIRE{500};
+constexpr std::chrono::milliseconds DEADLINE_WRITE_EXPIRE{5000};
+constexpr size_t DEADLINE_FIFO_BATCH = 16;
+constexpr size_t DEADLINE_WRITES_STARVED = 2;
+// Sectors a task may be served in a row before the next one is picked.
+constexpr uint32_t BFQ_DEFAULT_BUDGET = 2 * MAX_REQUEST_SECTORS;
+
+// I/O scheduling policy for one BlockQueue. Requests arrive already merged
+// and never include flushes; the queue drains the elevator before one.
+// Calls are serialised by the queue.
+class Elevator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~Elevator() = default;
+
+    virtual const char* getName() const = 0;
+    virtual void insert(BlockRequest request, Clock::time_point now) = 0;
+    // The request the device should run next, or nothing when empty.
+    virtual std::optional<BlockRequest> dispatch(Clock::time_point now) = 0;
+    virtual size_t size() const = 0;
+};
+
+// First come, first served.
+class NoopElevator : public Elevator {
+public:
+    const char* getName() const override { return "noop"; }
+    void insert(BlockRequest request, Clock::time_point now) override;
+    std::optional<BlockRequest> dispatch(Clock::time_point now) override;
+    size_t size() const override { return fifo_.size(); }
+
+private:
+    std::deque<BlockRequest> fifo_;
+};
+
+// Reads and writes each sit in a sector-sorted tree and an arrival FIFO.
+// Dispatch sweeps upward through one direction in batches of fifoBatch,
+// prefers reads unless writes have been passed over writesStarved times,
+// and jumps to the FIFO head once its deadline has passed.
+class DeadlineElevator : public Elevator {
+public:
+    DeadlineElevator(std::chrono::nanoseconds readExpire = DEADLINE_READ_EXPIRE,
+                     std::chrono::nanoseconds writeExpire = DEADLINE_WRITE_EXPIRE,
+                     size_t fifoBatch = DEADLINE_FIFO_BATCH,
+                     size_t writesStarved = DEADLINE_WRITES_STARVED);
+
+    const char* getName() const override { return "deadline"; }
+    void insert(BlockRequest request, Clock::time_point now) override;
+    std::optional<BlockRequest> dispatch(Clock::time_point now) override;
+    size_t size() const override;
+
+private:
+    struct Entry;
+    using Fifo = std::list<Entry>;
+    using SortedTree = std::multimap<SectorNumber, Fifo::iterator>;
+
+    struct Entry {
+        BlockRequest request;
+        Clock::time_point deadline;
+        SortedTree::iterator position;
+    };
+
+    struct Direction {
+        Fifo fifo;
+        SortedTree sorted;
+    };
+
+    BlockRequest take(size_t direction, SortedTree::iterator position);
+
+    std::chrono::nanoseconds expire_[2];
+    size_t fifoBatch_;
+    size_t writesStarved_;
+    Direction directions_[2];
+    std::optional<size_t> batchDirection_;
+    size_t batchCount_;
+    size_t starved_;
+    SectorNumber nextSector_;
+};
+
+// Budget fair queueing. Each task has its own sector-sorted queue and a
+// virtual finish time that grows by sectors served / weight. The task with
+// the smallest finish time gets the device until it has used its budget or
+// run out of requests, so one streaming task cannot hold off the others
+// and small random readers see latency proportional to their own load.
+// Unlike Linux BFQ there is no idling for a task's next request.
+class BudgetFairElevator : public Elevator {
+public:
+    explicit BudgetFairElevator(uint32_t budgetSectors = BFQ_DEFAULT_BUDGET);
+
+    const char* getName() const override { return "bfq"; }
+    void insert(BlockRequest request, Clock::time_point now) override;
+    std::optional<BlockRequest> dispatch(Clock::time_point now) override;
+    size_t size() const override { return size_; }
+
+    // Share of the device relative to other tasks; 1 by default.
+    void setWeight(TaskId task, uint32_t weight);
+
+private:
+    struct TaskQueue {
+        std::multimap<SectorNumber, BlockRequest> requests;
+        double finish = 0;
+        uint32_t weight = 1;
+    };
+
+    void selectTask();
+
+    uint32_t budget_;
+    std::unordered_map<TaskId, TaskQueue> tasks_;
+    TaskQueue* active_;
+    uint32_t remaining_;
+    SectorNumber nextSector_;
+    double virtualTime_;
+    size_t size_;
+};
+
+// "noop", "deadline" or "bfq" with default tunables; nullptr otherwise.
+std::unique_ptr<Elevator> makeElevator(const std::string& name);
+
+}
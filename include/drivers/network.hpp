@@ -0,0 +1,220 @@
+#pragma once
+
+#include "drivers/driver.hpp"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MiniOS {
+
+// One frame holds a packet of up to this many bytes.
+constexpr size_t FRAME_SIZE = 2048;
+constexpr size_t DEFAULT_NIC_RING_SIZE = 512;
+// Packets one NAPI poll may take before the next device gets a turn.
+constexpr size_t NAPI_WEIGHT = 64;
+// Packets one NetRx run may take before it re-raises itself and yields.
+constexpr size_t NET_RX_BUDGET = 300;
+
+constexpr uint32_t NET_IOCTL_GET_FRAME_SIZE = 0;
+
+using FrameIndex = uint32_t;
+
+struct PacketDescriptor {
+    FrameIndex frame;
+    uint32_t length;
+};
+
+// Bytes of one packet. Views passed to a receive handler are only valid
+// until it returns.
+struct PacketView {
+    const uint8_t* data;
+    uint32_t length;
+};
+
+using PacketHandler = std::function<void(const PacketView* packets, size_t count)>;
+
+// Fixed-size frames shared by the NICs of one backend. Descriptors carry
+// frame indices, so a packet crosses from one NIC to another without a copy.
+class FramePool {
+public:
+    explicit FramePool(size_t frames);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // Returns how many frames were written to `out`.
+    size_t allocate(FrameIndex* out, size_t count);
+    void release(const PacketDescriptor* descriptors, size_t count);
+
+    uint8_t* data(FrameIndex frame) { return memory_.get() + size_t(frame) * FRAME_SIZE; }
+    size_t getFrameCount() const { return frames_; }
+    size_t available() const;
+
+private:
+    std::unique_ptr<uint8_t[]> memory_;
+    size_t frames_;
+    mutable std::mutex mutex_;
+    std::vector<FrameIndex> free_;
+};
+
+// Single-producer, single-consumer descriptor ring, the shape of a NIC's
+// hardware rings. Each side keeps a cached copy of the other's index and
+// only reloads it when the ring looks full or empty.
+class DescriptorRing {
+public:
+    // Capacity is rounded up to a power of two.
+    explicit DescriptorRing(size_t capacity);
+
+    DescriptorRing(const DescriptorRing&) = delete;
+    DescriptorRing& operator=(const DescriptorRing&) = delete;
+
+    size_t push(const PacketDescriptor* descriptors, size_t count);
+    size_t pop(PacketDescriptor* out, size_t maxCount);
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    size_t mask_;
+    std::unique_ptr<PacketDescriptor[]> slots_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+    size_t cachedHead_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_;
+    size_t cachedTail_;
+};
+
+struct NicStats {
+    uint64_t txPackets;
+    uint64_t txBytes;
+    // Packets transmit() turned away because the TX ring or pool was full.
+    uint64_t txBusy;
+    uint64_t rxPackets;
+    uint64_t rxBytes;
+    uint64_t rxDropped;
+    uint64_t interrupts;
+    uint64_t polls;
+};
+
+class NetworkStack;
+
+// A DriverType::Network device with RX and TX descriptor rings over a
+// shared FramePool. The backend is the other end of the wire: a NIC on its
+// own loops back to itself, and connect() wires two NICs back to back.
+// Moving descriptors from the TX ring to the peer's RX ring plays the
+// part of the hardware and happens inline on transmit, and again from
+// poll() once the receiver has made room.
+//
+// The RX interrupt is masked when it fires and stays masked while NAPI
+// polling keeps up with the ring, so under load the device is driven by
+// polling alone and goes back to interrupts once a poll comes up short.
+class VirtualNic : public Driver {
+public:
+    VirtualNic(const std::string& name, std::shared_ptr<FramePool> pool,
+               size_t ringSize = DEFAULT_NIC_RING_SIZE);
+    ~VirtualNic() override = default;
+
+    bool init() override;
+    bool shutdown() override;
+    // One packet per call. Without a receive handler, received packets
+    // wait in a backlog for read().
+    ssize_t read(void* buffer, size_t count) override;
+    ssize_t write(const void* buffer, size_t count) override;
+    bool ioctl(uint32_t command, void* arg) override;
+
+    // Both NICs must use the same pool and neither may be connected yet.
+    static bool connect(VirtualNic& a, VirtualNic& b);
+
+    // Copies the packets into frames and queues them; returns how many were
+    // accepted, in order.
+    size_t transmit(const PacketView* packets, size_t count);
+    // Receives every packet taken by poll(), in batches of up to NAPI_WEIGHT.
+    void setReceiveHandler(PacketHandler handler) { receiveHandler_ = std::move(handler); }
+
+    // Takes up to `budget` packets off the RX ring. Only one CPU may poll a
+    // NIC at a time; NetworkStack guarantees that for attached NICs.
+    size_t poll(size_t budget);
+    bool hasPendingRx() const { return !rxRing_.empty(); }
+
+    InterruptNumber getIrq() const { return irq_; }
+    NicStats getStats() const;
+
+private:
+    friend class NetworkStack;
+
+    void kickTx();
+    void signalRx();
+    // Re-arms the RX interrupt after a short poll. Returns false when
+    // packets raced in and the caller should keep polling.
+    bool completePoll();
+    void deliverToBacklog(const PacketView* packets, size_t count);
+
+    std::shared_ptr<FramePool> pool_;
+    VirtualNic* peer_;
+    NetworkStack* stack_;
+    InterruptNumber irq_;
+
+    std::mutex txMutex_;
+    DescriptorRing txRing_;
+    DescriptorRing rxRing_;
+    std::atomic<bool> irqArmed_;
+    PacketHandler receiveHandler_;
+
+    std::mutex backlogMutex_;
+    std::deque<std::vector<uint8_t>> backlog_;
+
+    std::atomic<uint64_t> txPackets_;
+    std::atomic<uint64_t> txBytes_;
+    std::atomic<uint64_t> txBusy_;
+    std::atomic<uint64_t> rxPackets_;
+    std::atomic<uint64_t> rxBytes_;
+    std::atomic<uint64_t> rxDropped_;
+    std::atomic<uint64_t> interrupts_;
+    std::atomic<uint64_t> polls_;
+};
+
+// Ties NICs to the interrupt controller. A NIC's top half puts it on the
+// interrupted CPU's poll list and raises NetRx; the NetRx softirq polls
+// each listed NIC for up to NAPI_WEIGHT packets, at most NET_RX_BUDGET per
+// run, and drops a NIC from the list once it is drained.
+class NetworkStack {
+public:
+    explicit NetworkStack(InterruptController& controller);
+    ~NetworkStack();
+
+    NetworkStack(const NetworkStack&) = delete;
+    NetworkStack& operator=(const NetworkStack&) = delete;
+
+    // Registers the NIC's top half on `irq`. The NIC must outlive the stack.
+    bool attach(VirtualNic& nic, InterruptNumber irq);
+    std::string getNetworkReport() const;
+
+private:
+    friend class VirtualNic;
+
+    struct alignas(CACHE_LINE_SIZE) PollList {
+        std::mutex mutex;
+        std::deque<VirtualNic*> devices;
+    };
+
+    static void interruptEntry(InterruptNumber interrupt, void* context, void* data);
+    void schedule(VirtualNic& nic);
+    void netRxAction();
+    PollList& localPollList();
+
+    InterruptController& controller_;
+    std::vector<std::unique_ptr<PollList>> pollLists_;
+    std::vector<VirtualNic*> devices_;
+    bool softirqOpen_;
+};
+
+}
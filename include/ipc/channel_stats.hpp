@@ -0,0 +1,106 @@
+#pragma once
+
+#include "kernel/types.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MiniOS {
+
+constexpr size_t LATENCY_BUCKETS = 32;
+// Single receives read the clock for one in this many messages per channel;
+// batch receives read it once and time every message.
+constexpr uint64_t LATENCY_SAMPLE_INTERVAL = 16;
+// Channel endpoint used when a receive timed out without a sender filter.
+constexpr TaskId ANY_SENDER = 0xFFFFFFFFu;
+
+struct ChannelSnapshot {
+    TaskId sender;
+    TaskId receiver;
+    uint64_t sent;
+    uint64_t received;
+    uint64_t bytes;
+    uint64_t drops;
+    uint64_t timeouts;
+    uint64_t depthHighWater;
+    // Bucket b counts sampled enqueue-to-dequeue latencies in [2^b, 2^(b+1)) ns.
+    std::array<uint64_t, LATENCY_BUCKETS> latency;
+
+    // Upper bound of the bucket holding the given quantile, 0 when empty.
+    uint64_t latencyPercentile(double quantile) const;
+};
+
+// Per (sender, receiver) traffic counters. Every thread records into its own
+// shard with plain relaxed stores, so the send and receive paths never share
+// a cache line; snapshot() merges the shards. A thread's shard is folded
+// into a shared total when the thread exits.
+class ChannelStats {
+public:
+    ChannelStats();
+    ~ChannelStats();
+
+    ChannelStats(const ChannelStats&) = delete;
+    ChannelStats& operator=(const ChannelStats&) = delete;
+
+    void recordSend(TaskId sender, TaskId receiver, uint64_t count, uint64_t bytes, size_t depth);
+    void recordDrop(TaskId sender, TaskId receiver, uint64_t count = 1);
+    void recordReceive(TaskId sender, TaskId receiver, std::chrono::steady_clock::time_point sentAt);
+    void recordReceive(TaskId sender, TaskId receiver, std::chrono::steady_clock::time_point sentAt,
+                       std::chrono::steady_clock::time_point now);
+    void recordTimeout(TaskId sender, TaskId receiver);
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    std::vector<ChannelSnapshot> snapshot() const;
+    std::string getChannelReport(size_t limit) const;
+
+private:
+    friend struct LocalShards;
+
+    struct Counters {
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> drops{0};
+        std::atomic<uint64_t> timeouts{0};
+        std::atomic<uint64_t> depthHighWater{0};
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latency{};
+    };
+
+    // Written by one thread only; the mutex guards the map's shape against
+    // a concurrent snapshot, not the counters.
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, std::unique_ptr<Counters>> channels;
+        uint64_t lastKey = 0;
+        Counters* last = nullptr;
+    };
+
+    static uint64_t channelKey(TaskId sender, TaskId receiver) {
+        return (uint64_t(sender) << 32) | receiver;
+    }
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    Counters& counters(TaskId sender, TaskId receiver);
+    Shard& localShard();
+    void retireShard(Shard* shard);
+    static void recordLatency(Counters& c, std::chrono::steady_clock::duration latency);
+
+    uint64_t instanceId_;
+    std::atomic<bool> enabled_;
+    mutable std::mutex shardsMutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    // Counters of threads that have exited, guarded by shardsMutex_.
+    std::unordered_map<uint64_t, std::unique_ptr<Counters>> retired_;
+};
+
+}
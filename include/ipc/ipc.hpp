@@ -1,25 +1,81 @@
 #pragma once
 
 #include "kernel/types.hpp"
+#include "ipc/payload.hpp"
+#include "ipc/channel_stats.hpp"
+#include "mm/memory_manager.hpp"
 #include "utils/logger.hpp"
-#include <queue>
+#include "utils/epoch.hpp"
 #include <map>
+#include <unordered_map>
+#include <array>
 #include <vector>
 #include <optional>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
 #include <cstring>
 
 namespace MiniOS {
 
 constexpr size_t MAX_MESSAGE_SIZE = 4096;
+constexpr size_t DEFAULT_QUEUE_CAPACITY = 1024;
+constexpr size_t DEFAULT_QUEUE_BYTES = DEFAULT_QUEUE_CAPACITY * MAX_MESSAGE_SIZE;
+constexpr size_t PENDING_CALL_SHARDS = 16;
+constexpr size_t REGISTRY_CHUNK_BITS = 10;
+constexpr size_t REGISTRY_CHUNK_SIZE = size_t(1) << REGISTRY_CHUNK_BITS;
+constexpr size_t REGISTRY_CHUNKS = 1024;
+constexpr size_t MAX_IPC_TASKS = REGISTRY_CHUNK_SIZE * REGISTRY_CHUNKS;
+
+// TaskIds at or above MAX_IPC_TASKS name tasks on another kernel instance:
+// the bits above NODE_ID_SHIFT select the node, the rest the task there.
+using NodeId = uint32_t;
+constexpr size_t NODE_ID_SHIFT = 20;
+constexpr NodeId MAX_NODES = NodeId(1) << (32 - NODE_ID_SHIFT);
+static_assert(MAX_IPC_TASKS == size_t(1) << NODE_ID_SHIFT, "remote ids start above the registry");
+
+inline TaskId remoteTaskId(NodeId node, TaskId task) {
+    return static_cast<TaskId>((node << NODE_ID_SHIFT) | (task & (MAX_IPC_TASKS - 1)));
+}
+inline NodeId nodeOf(TaskId task) { return task >> NODE_ID_SHIFT; }
+inline TaskId localTaskOf(TaskId task) { return task & (MAX_IPC_TASKS - 1); }
 
 enum class MessageType {
     Data,
     Signal,
     Request,
     Response,
-    Notification
+    Notification,
+    Grant
+};
+
+constexpr size_t MESSAGE_TYPE_COUNT = 6;
+
+enum class MessagePriority : uint8_t {
+    Low,
+    Normal,
+    High,
+    Control
+};
+
+constexpr size_t MESSAGE_PRIORITY_COUNT = 4;
+
+inline MessagePriority defaultPriorityFor(MessageType type) {
+    switch (type) {
+        case MessageType::Signal: return MessagePriority::Control;
+        case MessageType::Notification: return MessagePriority::High;
+        default: return MessagePriority::Normal;
+    }
+}
+
+struct PageGrant {
+    RegionId region;
+    GrantMode mode;
+    uint32_t pageCount;
 };
 
 struct Message {
@@ -27,7 +83,9 @@ struct Message {
     TaskId senderId;
     TaskId receiverId;
     MessageType type;
-    std::vector<uint8_t> payload;
+    MessagePriority priority;
+    MessageId correlationId;
+    MessagePayload payload;
     std::chrono::steady_clock::time_point timestamp;
     bool isBlocking;
 
@@ -36,15 +94,17 @@ struct Message {
         , senderId(sender)
         , receiverId(receiver)
         , type(t)
+        , priority(defaultPriorityFor(t))
+        , correlationId(0)
         , timestamp(std::chrono::steady_clock::now())
         , isBlocking(false)
     {}
 
-    void setPayload(const void* data, size_t size) {
-        if (size <= MAX_MESSAGE_SIZE) {
-            payload.resize(size);
-            std::memcpy(payload.data(), data, size);
+    bool setPayload(const void* data, size_t size) {
+        if (size > MAX_MESSAGE_SIZE) {
+            return false;
         }
+        return payload.assign(data, size);
     }
 
     template<typename T>
@@ -63,59 +123,611 @@ struct Message {
     }
 };
 
-class MessageQueue {
+struct MessageSpec {
+    const void* data;
+    size_t size;
+    MessageType type;
+    MessageId correlationId;
+    std::optional<MessagePriority> priority;
+
+    MessageSpec(const void* d, size_t s, MessageType t = MessageType::Data, MessageId correlation = 0)
+        : data(d), size(s), type(t), correlationId(correlation) {}
+};
+
+struct MessageFilter {
+    std::optional<TaskId> sender;
+    std::optional<MessageType> type;
+    std::optional<MessageId> correlationId;
+
+    static MessageFilter fromSender(TaskId sender) { return {sender, std::nullopt, std::nullopt}; }
+    static MessageFilter ofType(MessageType type) { return {std::nullopt, type, std::nullopt}; }
+    static MessageFilter forCorrelation(MessageId id) { return {std::nullopt, std::nullopt, id}; }
+
+    bool matches(const Message& msg) const {
+        return (!sender || msg.senderId == *sender) &&
+               (!type || msg.type == *type) &&
+               (!correlationId || msg.correlationId == *correlationId);
+    }
+};
+
+enum class OverflowPolicy {
+    FailFast,
+    Block,
+    DropOldest
+};
+
+struct QueueLimits {
+    size_t maxMessages = DEFAULT_QUEUE_CAPACITY;
+    size_t maxBytes = DEFAULT_QUEUE_BYTES;
+    OverflowPolicy policy = OverflowPolicy::FailFast;
+};
+
+// Space a sender may use before it hits the receiver's limits.
+struct SendWindow {
+    size_t messages;
+    size_t bytes;
+};
+
+// Resolves to the reply, or to nullopt if the call was cancelled or one of
+// the two tasks unregistered first.
+using ReplyFuture = std::future<std::optional<Message>>;
+
+using PortId = uint32_t;
+using Handle = uint32_t;
+
+constexpr Handle INVALID_HANDLE = 0;
+
+constexpr uint32_t RIGHT_SEND = 1u << 0;
+constexpr uint32_t RIGHT_RECEIVE = 1u << 1;
+constexpr uint32_t RIGHT_GRANT = 1u << 2;
+
+constexpr size_t NOTIFICATION_OBSERVERS = 4;
+
+constexpr uint32_t WAIT_READABLE = 1u << 0;
+constexpr uint32_t WAIT_HANGUP = 1u << 1;
+
+struct WaitEvent {
+    Handle handle;
+    uint64_t cookie;
+    uint32_t events;
+};
+
+class HandleTable;
+
+using TopicId = uint32_t;
+using SubscriptionId = uint32_t;
+using TopicFilter = std::function<bool(const Message&)>;
+
+constexpr TopicId INVALID_TOPIC_ID = 0;
+
+struct Subscription {
+    SubscriptionId id;
+    TaskId subscriber;
+    TopicFilter filter;
+};
+
+struct Topic {
+    TopicId id;
+    std::string name;
+    std::vector<Subscription> subscriptions;
+    std::atomic<uint64_t> publishCount;
+
+    Topic(TopicId topicId, const std::string& topicName)
+        : id(topicId), name(topicName), publishCount(0) {}
+};
+
+// Single-message handover point for synchronous calls. The owner arms it
+// and parks; a peer that finds it armed writes the message straight into the
+// slot instead of going through the ring.
+class Rendezvous {
+public:
+    Rendezvous() = default;
+
+    Rendezvous(const Rendezvous&) = delete;
+    Rendezvous& operator=(const Rendezvous&) = delete;
+
+    bool arm();
+    bool disarm();
+    bool deliver(Message& msg);
+    std::optional<Message> tryTake();
+    std::optional<Message> take(Deadline deadline);
+    void close();
+
+private:
+    enum State : uint32_t { Empty, Armed, Writing, Full };
+
+    bool waitForState(State target, Deadline deadline);
+
+    std::atomic<uint32_t> state_{Empty};
+    std::optional<Message> slot_;
+    std::atomic<uint32_t> sleepers_{0};
+    std::atomic<bool> closed_{false};
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+// Bounded multi-producer/single-consumer ring. Producers claim slots with a
+// CAS on tail_; each slot's sequence number tells the consumer when the
+// message stored in it has been published.
+class MessageRing {
+public:
+    explicit MessageRing(size_t capacity);
+    ~MessageRing();
+
+    MessageRing(const MessageRing&) = delete;
+    MessageRing& operator=(const MessageRing&) = delete;
+
+    bool enqueue(Message& msg);
+    size_t enqueueBatch(Message* messages, size_t count);
+    const Message* peek() const;
+    std::optional<Message> dequeue();
+    size_t dequeueBatch(std::vector<Message>& out, size_t maxCount);
+
+    size_t size() const;
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<size_t> sequence;
+        alignas(Message) unsigned char storage[sizeof(Message)];
+
+        Message* message() { return reinterpret_cast<Message*>(storage); }
+        const Message* message() const { return reinterpret_cast<const Message*>(storage); }
+    };
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_;
+};
+
+// Receives a callback whenever a queue it watches may have become readable or
+// was closed. Calls can be spurious and arrive from any producer thread.
+class ReadinessObserver {
 public:
-    explicit MessageQueue(TaskId owner);
+    virtual ~ReadinessObserver() = default;
+    virtual void onReady() = 0;
+};
+
+// Anything a wait set can watch: it reports its current readiness as a
+// WAIT_* mask and accepts observers that are told when it may have become
+// ready. attach() returns false once the source has no room for another.
+class WaitSource {
+public:
+    virtual ~WaitSource() = default;
+    virtual uint32_t poll() const = 0;
+    virtual bool attach(ReadinessObserver* observer) = 0;
+    virtual void detach(ReadinessObserver* observer) = 0;
+};
+
+// A 64-bit doorbell. Senders OR bits into the word with a single atomic
+// operation and the receiver reads and clears all of them at once; only the
+// transition from zero wakes anyone, so repeated signals cost nothing extra.
+// Up to NOTIFICATION_OBSERVERS observers, such as a bound mailbox and the
+// wait sets watching it, are told about that transition.
+class Notification : public WaitSource {
+public:
+    Notification() : bits_(0), waiters_(0), observers_{} {}
+
+    Notification(const Notification&) = delete;
+    Notification& operator=(const Notification&) = delete;
+
+    void signal(uint64_t bits);
+    uint64_t take() { return bits_.exchange(0, std::memory_order_acq_rel); }
+    uint64_t wait(Deadline deadline);
+    uint64_t peek() const { return bits_.load(std::memory_order_acquire); }
+
+    uint32_t poll() const override { return peek() != 0 ? WAIT_READABLE : 0; }
+    bool attach(ReadinessObserver* observer) override;
+    void detach(ReadinessObserver* observer) override;
+
+private:
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> bits_;
+    std::atomic<uint32_t> waiters_;
+    std::array<std::atomic<ReadinessObserver*>, NOTIFICATION_OBSERVERS> observers_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+// A task's mailbox: one ring per priority level plus a bitmap of levels that
+// may hold messages. The consumer drains levels by weighted round robin so
+// control traffic overtakes bulk data without starving it; messages a
+// selective receive stashed are served in the same rounds as their level.
+//
+// Producers reserve message and byte credits before touching a ring. Under
+// DropOldest the newest message is always accepted: its producer evicts the
+// oldest messages of the lowest non-empty level until the queue is back
+// within its limits. Eviction and the consumer's ring reads are serialised
+// by evictMutex_, which FailFast and Block queues never touch. Messages the
+// consumer already stashed are out of the producers' reach and are trimmed
+// on its next receive instead.
+//
+// A notification bound to the queue wakes blocked receivers too; its pending
+// bits are handed out as a Signal message once the rings are empty.
+class MessageQueue : private ReadinessObserver {
+public:
+    explicit MessageQueue(TaskId owner, size_t capacity = DEFAULT_QUEUE_CAPACITY);
+    MessageQueue(TaskId owner, const QueueLimits& limits);
+    ~MessageQueue();
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
     
-    void enqueue(Message msg);
+    // The message is only moved from when it was accepted.
+    bool enqueue(Message&& msg);
+    size_t enqueueBatch(Message* messages, size_t count);
     std::optional<Message> dequeue();
-    std::optional<Message> peek() const;
+    size_t dequeueBatch(std::vector<Message>& out, size_t maxCount);
+    std::optional<Message> dequeueMatching(const MessageFilter& filter);
+    // Only the consumer may call peek(); the view is valid until its next
+    // dequeue(), and under DropOldest only until the next enqueue().
+    const Message* peek() const;
+    bool hasArrival() const { return peekRing() != nullptr; }
+
+    template<typename Predicate>
+    bool waitUntil(Deadline deadline, Predicate ready);
+    bool waitForSpace(size_t bytes, Deadline deadline);
+    // The observer is invoked under an epoch guard; retire it through the
+    // EpochDomain after detaching.
+    void setReadinessObserver(ReadinessObserver* observer);
+    bool exchangeReadinessObserver(ReadinessObserver* expected, ReadinessObserver* observer);
+    bool bindNotification(std::shared_ptr<Notification> notification);
+    std::optional<Message> takeSignal();
+    bool hasSignal() const;
+    void close();
+    bool isClosed() const { return closed_.load(std::memory_order_acquire); }
     
-    bool isEmpty() const { return messages_.empty(); }
-    size_t size() const { return messages_.size(); }
+    bool isEmpty() const { return size() == 0; }
+    size_t size() const;
+    // Admitted but not yet dequeued; cheaper than size() on the send path.
+    size_t depth() const { return queuedMessages_.load(std::memory_order_relaxed); }
+    size_t capacity() const { return limits_.maxMessages; }
+    const QueueLimits& limits() const { return limits_; }
+    SendWindow window() const;
+    uint64_t evictedCount() const { return evicted_.load(std::memory_order_relaxed); }
     TaskId getOwner() const { return owner_; }
 
+    Rendezvous& callSlot() { return callSlot_; }
+    Rendezvous& replySlot() { return replySlot_; }
+
+    // The IPCManager registry holds one reference and callers that park on
+    // the queue hold another, so they need not stay pinned to the epoch.
+    // release() returns true when the caller dropped the last one.
+    void retain() { references_.fetch_add(1, std::memory_order_relaxed); }
+    bool release() { return references_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
 private:
+    // Messages a selective receive skipped over are moved out of the ring
+    // into consumer-private nodes linked into arrival order plus per-sender,
+    // per-type, per-correlation and per-priority lists.
+    struct StashNode;
+
+    struct StashLinks {
+        StashNode* prev = nullptr;
+        StashNode* next = nullptr;
+    };
+
+    struct StashList {
+        StashNode* head = nullptr;
+        StashNode* tail = nullptr;
+    };
+
+    enum StashIndex { ByArrival, BySender, ByType, ByCorrelation, ByPriority, StashIndexCount };
+
+    struct StashNode {
+        std::optional<Message> message;
+        std::array<StashLinks, StashIndexCount> links;
+    };
+
+    MessageRing* ringFor(MessagePriority priority);
+    int readyLevel() const;
+    int nextLevel() const;
+    std::optional<Message> dequeueLevel(int level);
+    std::optional<Message> takeLevel(int level);
+    void markReady(int level);
+    void clearReadyIfEmpty(int level);
+    void chargeLevel(int level, size_t count);
+
+    bool admit(size_t bytes);
+    bool enqueueEvicting(Message& msg);
+    bool evictFromRings();
+    void retire(size_t count, size_t bytes);
+    bool hasSpace(size_t bytes) const;
+    void evictOverflow();
+
+    const Message* peekRing() const;
+    std::optional<Message> dequeueRing();
+    void wakeWaiters();
+    void notifyObserver();
+    void onReady() override { wakeWaiters(); }
+
+    void drainRingToStash();
+    void stash(Message msg);
+    Message unstash(StashNode* node);
+    StashNode* findStashed(const MessageFilter& filter);
+    void linkNode(StashList& list, StashNode* node, StashIndex index);
+    void unlinkNode(StashList& list, StashNode* node, StashIndex index);
+
     TaskId owner_;
-    std::queue<Message> messages_;
-    mutable std::mutex mutex_;
+    QueueLimits limits_;
+    size_t capacity_;
+    std::array<std::atomic<MessageRing*>, MESSAGE_PRIORITY_COUNT> rings_;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> readyLevels_;
+    std::array<size_t, MESSAGE_PRIORITY_COUNT> levelBudget_;
+
+    StashList arrival_;
+    std::unordered_map<TaskId, StashList> bySender_;
+    std::array<StashList, MESSAGE_TYPE_COUNT> byType_;
+    std::unordered_map<MessageId, StashList> byCorrelation_;
+    std::array<StashList, MESSAGE_PRIORITY_COUNT> byPriority_;
+    std::vector<std::unique_ptr<StashNode>> stashNodes_;
+    std::vector<StashNode*> freeStashNodes_;
+    std::atomic<size_t> stashed_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> queuedMessages_;
+    std::atomic<size_t> queuedBytes_;
+    std::atomic<uint64_t> evicted_;
+    std::mutex evictMutex_;
+    std::atomic<uint32_t> spaceWaiters_;
+    std::mutex spaceMutex_;
+    std::condition_variable spaceCondition_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> waiters_;
+    std::atomic<bool> closed_;
+    std::mutex waitMutex_;
+    std::condition_variable waitCondition_;
+    std::atomic<ReadinessObserver*> observer_;
+    std::atomic<Notification*> bound_;
+    std::shared_ptr<Notification> boundOwner_;
+    std::atomic<uint32_t> references_;
+
+    alignas(CACHE_LINE_SIZE) Rendezvous callSlot_;
+    alignas(CACHE_LINE_SIZE) Rendezvous replySlot_;
+};
+
+// Parks the consumer until ready() holds, the deadline passes or the queue is
+// closed. Producers only touch waitMutex_ when waiters_ is non-zero.
+template<typename Predicate>
+bool MessageQueue::waitUntil(Deadline deadline, Predicate ready) {
+    std::unique_lock<std::mutex> lock(waitMutex_);
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    auto done = [&]() { return isClosed() || ready(); };
+    bool satisfied;
+    if (deadline == NO_DEADLINE) {
+        waitCondition_.wait(lock, done);
+        satisfied = true;
+    } else {
+        satisfied = waitCondition_.wait_until(lock, deadline, done);
+    }
+    
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return satisfied && !isClosed();
+}
+
+// Carries messages addressed to remote TaskIds to the node that owns them.
+// forward() returns false when the message could not be handed off.
+class RemoteRouter {
+public:
+    virtual ~RemoteRouter() = default;
+    virtual bool forward(Message& msg) = 0;
 };
 
 class IPCManager {
 public:
     IPCManager();
-    ~IPCManager() = default;
+    ~IPCManager();
+
+    IPCManager(const IPCManager&) = delete;
+    IPCManager& operator=(const IPCManager&) = delete;
 
-    bool registerTask(TaskId taskId);
+    bool registerTask(TaskId taskId, const QueueLimits& limits = QueueLimits());
     bool unregisterTask(TaskId taskId);
 
     MessageId sendMessage(TaskId sender, TaskId receiver, 
                          const void* data, size_t size, 
                          MessageType type = MessageType::Data,
-                         bool blocking = false);
+                         bool blocking = false,
+                         MessageId correlationId = 0,
+                         std::optional<MessagePriority> priority = std::nullopt);
+    // A blocking send that gives up once the deadline passes.
+    MessageId sendMessage(TaskId sender, TaskId receiver,
+                         const void* data, size_t size, Deadline deadline,
+                         MessageType type = MessageType::Data,
+                         MessageId correlationId = 0,
+                         std::optional<MessagePriority> priority = std::nullopt);
+    // Sends a message whose payload the caller already wrote in place, e.g.
+    // with a SchemaBuilder. The id is assigned here. Waits for space when
+    // blocking or under the Block policy, but not past the deadline.
+    MessageId sendPrepared(Message&& msg, bool blocking = false, Deadline deadline = NO_DEADLINE);
     
     MessageId sendAsync(TaskId sender, TaskId receiver, 
                         const void* data, size_t size,
                         MessageType type = MessageType::Data);
     
+    size_t sendBatch(TaskId sender, TaskId receiver, const MessageSpec* specs, size_t count,
+                     MessageId* firstId = nullptr);
+    size_t sendBatch(TaskId sender, TaskId receiver, const std::vector<MessageSpec>& specs,
+                     MessageId* firstId = nullptr);
+    
     std::optional<Message> receiveMessage(TaskId receiver, bool blocking = true);
+    std::optional<Message> receiveMessage(TaskId receiver, Deadline deadline);
     std::optional<Message> receiveMessageFrom(TaskId receiver, TaskId sender, bool blocking = true);
+    std::optional<Message> receiveMessageFrom(TaskId receiver, TaskId sender, Deadline deadline);
+    std::optional<Message> receiveMatching(TaskId receiver, const MessageFilter& filter,
+                                           Deadline deadline = Deadline::min());
+    size_t receiveBatch(TaskId receiver, size_t maxCount, std::vector<Message>& out,
+                        Deadline deadline = Deadline::min());
 
     bool hasMessages(TaskId taskId) const;
     size_t getMessageCount(TaskId taskId) const;
+    SendWindow getSendWindow(TaskId receiver) const;
+    // Sleeps until the receiver's queue could take `bytes` more; false if it
+    // is gone, closed, or still full at the deadline.
+    bool waitForSpace(TaskId receiver, size_t bytes, Deadline deadline);
+
+    TopicId createTopic(const std::string& name);
+    bool destroyTopic(TopicId topic);
+    TopicId findTopic(const std::string& name) const;
+    SubscriptionId subscribe(TopicId topic, TaskId subscriber, TopicFilter filter = nullptr);
+    bool unsubscribe(TopicId topic, SubscriptionId subscription);
+    size_t getSubscriberCount(TopicId topic) const;
+    size_t publish(TopicId topic, TaskId publisher, const void* data, size_t size,
+                   MessageType type = MessageType::Notification);
+
+    std::optional<Message> call(TaskId client, TaskId server, const void* data, size_t size,
+                                Deadline deadline = NO_DEADLINE);
+    std::optional<Message> receiveCall(TaskId server, Deadline deadline = NO_DEADLINE);
+    bool reply(TaskId server, const Message& request, const void* data, size_t size);
+    std::optional<Message> replyWait(TaskId server, const Message& request,
+                                     const void* data, size_t size,
+                                     Deadline deadline = NO_DEADLINE);
+
+    ReplyFuture callAsync(TaskId client, TaskId server, const void* data, size_t size,
+                          MessageId* requestId = nullptr);
+    bool replyTo(TaskId server, MessageId requestId, const void* data, size_t size);
+    bool cancelCall(MessageId requestId);
+    size_t getPendingCallCount() const;
+
+    Handle createPort(TaskId owner, const QueueLimits& limits = QueueLimits());
+    Handle grantHandle(TaskId from, Handle handle, TaskId to, uint32_t rights);
+    bool closeHandle(TaskId task, Handle handle);
+    MessageId sendToPort(TaskId sender, Handle port, const void* data, size_t size,
+                         MessageType type = MessageType::Data);
+    std::optional<Message> receiveFromPort(TaskId owner, Handle port, 
+                                           Deadline deadline = Deadline::min());
+
+    Handle createNotification(TaskId owner);
+    bool signal(TaskId sender, Handle notification, uint64_t bits);
+    uint64_t waitNotification(TaskId owner, Handle notification, Deadline deadline = NO_DEADLINE);
+    bool bindNotification(TaskId task, Handle notification);
+    // A receive-only handle on the task's own mailbox, for watching it
+    // from a wait set.
+    Handle openMailbox(TaskId task);
+
+    Handle createWaitSet(TaskId owner);
+    bool waitSetAdd(TaskId owner, Handle waitSet, Handle source, uint64_t cookie);
+    bool waitSetRemove(TaskId owner, Handle waitSet, Handle source);
+    size_t waitForEvents(TaskId owner, Handle waitSet, std::vector<WaitEvent>& events,
+                         size_t maxEvents, Deadline deadline = NO_DEADLINE);
+
+    using TaskStateHook = std::function<void(TaskId)>;
+    using HandoffHook = std::function<void(TaskId from, TaskId to, bool blockFrom)>;
+    void setBlockingHooks(TaskStateHook onBlock, TaskStateHook onWake);
+    void setHandoffHook(HandoffHook onHandoff) { onHandoff_ = std::move(onHandoff); }
+
+    void attachMemoryManager(MemoryManager* memoryManager) { memoryManager_ = memoryManager; }
+    void setRemoteRouter(RemoteRouter* router) { remoteRouter_.store(router, std::memory_order_release); }
+    // Hands messages that arrived from another node to their local
+    // receivers. Returns how many were consumed from the front; the rest were
+    // refused by a full queue and are left intact for a retry.
+    size_t deliverRemote(Message* messages, size_t count);
+
+    MessageId sendPageGrant(TaskId sender, TaskId receiver, RegionId region, GrantMode mode);
+    bool acceptPageGrant(TaskId receiver, const Message& grant, PageNumber baseVirtualPage,
+                         MemoryProtection protection = MemoryProtection::ReadWrite);
+    bool releasePageGrant(const Message& grant);
 
     std::optional<Message> sendAndWaitReply(TaskId sender, TaskId receiver,
                                             const void* data, size_t size,
                                             std::chrono::milliseconds timeout);
 
+    // Per (sender, receiver) counters merged from every thread's shard.
+    std::vector<ChannelSnapshot> getChannelStats() const { return channelStats_.snapshot(); }
+    void setChannelTracing(bool enabled) { channelStats_.setEnabled(enabled); }
+    std::string getChannelReport(size_t limit = 10) const { return channelStats_.getChannelReport(limit); }
+
     std::string getIPCReport() const;
 
 private:
-    std::map<TaskId, std::unique_ptr<MessageQueue>> messageQueues_;
-    MessageId nextMessageId_;
-    uint64_t totalMessagesSent_;
-    uint64_t totalMessagesReceived_;
-    mutable std::mutex mutex_;
+    struct PendingCall {
+        TaskId client;
+        TaskId server;
+        std::promise<std::optional<Message>> promise;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) PendingShard {
+        mutable std::mutex mutex;
+        std::unordered_map<MessageId, PendingCall> calls;
+    };
+
+    // Queues are indexed directly by TaskId through a two-level table. Chunks
+    // live as long as the manager; queues are retired through the epoch
+    // domain, so callers must hold an EpochDomain::Guard or a QueueRef.
+    struct RegistryChunk {
+        std::array<std::atomic<MessageQueue*>, REGISTRY_CHUNK_SIZE> queues;
+    };
+
+    // A registered queue kept alive past the epoch guard it was found under.
+    class QueueRef {
+    public:
+        explicit QueueRef(MessageQueue* queue) : queue_(queue) {
+            if (queue_) {
+                queue_->retain();
+            }
+        }
+        ~QueueRef() {
+            if (queue_ && queue_->release()) {
+                delete queue_;
+            }
+        }
+
+        QueueRef(const QueueRef&) = delete;
+        QueueRef& operator=(const QueueRef&) = delete;
+
+        MessageQueue& operator*() const { return *queue_; }
+        MessageQueue* operator->() const { return queue_; }
+        explicit operator bool() const { return queue_ != nullptr; }
+
+    private:
+        MessageQueue* queue_;
+    };
+
+    MessageQueue* findQueue(TaskId taskId) const;
+    // For callers that may block: they hold the reference, not a guard.
+    QueueRef referenceQueue(TaskId taskId) const;
+    MessageId forwardRemote(Message&& msg, bool blocking);
+    std::optional<Message> prepareMessage(TaskId sender, TaskId receiver, const void* data, size_t size,
+                                          MessageType type, MessageId correlationId,
+                                          std::optional<MessagePriority> priority);
+    PendingShard& pendingShard(MessageId requestId) { 
+        return pendingCalls_[requestId % PENDING_CALL_SHARDS]; 
+    }
+    std::shared_ptr<HandleTable> handleTable(TaskId task, bool create = false);
+    template<typename Fn>
+    bool withCapability(TaskId task, Handle handle, uint32_t rights, Fn&& fn) const;
+    bool completeCall(MessageId requestId, TaskId server, std::optional<Message> result);
+    void failPendingCalls(TaskId taskId);
+    void blockWaiter(TaskId taskId);
+    void wakeWaiter(TaskId taskId);
+    bool waitToEnqueue(MessageQueue& queue, Message& msg, bool blocking, Deadline deadline);
+
+    std::array<std::atomic<RegistryChunk*>, REGISTRY_CHUNKS> registry_;
+    std::atomic<size_t> registeredCount_;
+    std::mutex registryMutex_;
+    MemoryManager* memoryManager_;
+    TaskStateHook onBlock_;
+    TaskStateHook onWake_;
+    HandoffHook onHandoff_;
+    std::atomic<MessageId> nextMessageId_;
+    std::atomic<uint64_t> totalMessagesSent_;
+    std::atomic<uint64_t> totalMessagesReceived_;
+    std::atomic<uint64_t> totalMessagesDropped_;
+    std::atomic<uint64_t> directCalls_;
+    std::atomic<uint64_t> queuedCalls_;
+    std::map<TopicId, std::unique_ptr<Topic>> topics_;
+    TopicId nextTopicId_;
+    SubscriptionId nextSubscriptionId_;
+    mutable std::shared_mutex topicMutex_;
+    std::array<PendingShard, PENDING_CALL_SHARDS> pendingCalls_;
+    std::unordered_map<TaskId, std::shared_ptr<HandleTable>> handleTables_;
+    std::atomic<PortId> nextPortId_;
+    mutable std::shared_mutex handleMutex_;
+    std::atomic<RemoteRouter*> remoteRouter_;
+    ChannelStats channelStats_;
 };
 
 }
@@ -0,0 +1,210 @@
+#pragma once
+
+#include "kernel/types.hpp"
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <cstring>
+
+namespace MiniOS {
+
+constexpr size_t INLINE_PAYLOAD_SIZE = 56;
+constexpr size_t MIN_POOLED_PAYLOAD_SIZE = 128;
+constexpr size_t PAYLOAD_SIZE_CLASSES = 6;
+
+// Size-class pools for payloads that do not fit inline. Blocks are recycled
+// through a per-thread cache first and a shared free list second, so the
+// heap is only touched while a pool is warming up.
+class PayloadPool {
+public:
+    static PayloadPool& instance();
+
+    uint8_t* acquire(size_t sizeClass);
+    void release(uint8_t* block, size_t sizeClass);
+
+    static std::optional<size_t> sizeClassFor(size_t size);
+    static constexpr size_t classSize(size_t sizeClass) {
+        return MIN_POOLED_PAYLOAD_SIZE << sizeClass;
+    }
+
+    uint64_t getBlocksCreated() const;
+    std::string getPoolReport() const;
+
+private:
+    friend struct PayloadCache;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) SizeClass {
+        std::mutex mutex;
+        FreeBlock* head = nullptr;
+        size_t freeCount = 0;
+        std::atomic<uint64_t> blocksCreated{0};
+    };
+
+    PayloadPool() = default;
+    ~PayloadPool();
+
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    FreeBlock* takeBatch(size_t sizeClass, size_t maxCount, size_t& taken);
+    void returnBatch(size_t sizeClass, FreeBlock* head, FreeBlock* tail, size_t count);
+
+    std::array<SizeClass, PAYLOAD_SIZE_CLASSES> classes_;
+};
+
+// Immutable, reference-counted payload shared by every copy of a multicast
+// message. The bytes follow the header in the same allocation.
+class SharedPayload {
+public:
+    static SharedPayload* create(const void* data, size_t size);
+
+    void retain(uint32_t count = 1) { refs_.fetch_add(count, std::memory_order_relaxed); }
+    void release(uint32_t count = 1);
+
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+    size_t size() const { return size_; }
+    uint32_t refCount() const { return refs_.load(std::memory_order_acquire); }
+
+private:
+    explicit SharedPayload(size_t size) : refs_(1), size_(static_cast<uint32_t>(size)) {}
+
+    alignas(16) std::atomic<uint32_t> refs_;
+    uint32_t size_;
+};
+
+class MessagePayload {
+public:
+    MessagePayload() noexcept : block_(nullptr), size_(0), sizeClass_(INLINE_CLASS) {}
+
+    ~MessagePayload() { reset(); }
+
+    MessagePayload(const MessagePayload& other) : MessagePayload() {
+        copyFrom(other);
+    }
+
+    MessagePayload(MessagePayload&& other) noexcept : MessagePayload() {
+        steal(other);
+    }
+
+    MessagePayload& operator=(const MessagePayload& other) {
+        if (this != &other) {
+            reset();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    MessagePayload& operator=(MessagePayload&& other) noexcept {
+        if (this != &other) {
+            reset();
+            steal(other);
+        }
+        return *this;
+    }
+
+    bool assign(const void* src, size_t size) {
+        uint8_t* dest = allocate(size);
+        if (!dest && size > 0) {
+            return false;
+        }
+        if (size > 0) {
+            std::memcpy(dest, src, size);
+        }
+        return true;
+    }
+
+    uint8_t* allocate(size_t size) {
+        if (size <= INLINE_PAYLOAD_SIZE) {
+            reset();
+            size_ = static_cast<uint32_t>(size);
+            return inline_;
+        }
+
+        auto sizeClass = PayloadPool::sizeClassFor(size);
+        if (!sizeClass) {
+            return nullptr;
+        }
+
+        if (sizeClass_ != *sizeClass || isShared()) {
+            reset();
+            block_ = PayloadPool::instance().acquire(*sizeClass);
+            sizeClass_ = static_cast<uint8_t>(*sizeClass);
+        }
+        size_ = static_cast<uint32_t>(size);
+        return block_;
+    }
+
+    // Takes over one reference the caller already holds on shared.
+    void adoptShared(SharedPayload* shared) {
+        reset();
+        shared_ = shared;
+        size_ = static_cast<uint32_t>(shared->size());
+        sizeClass_ = SHARED_CLASS;
+    }
+
+    void reset() {
+        if (isShared()) {
+            shared_->release();
+        } else if (sizeClass_ != INLINE_CLASS) {
+            PayloadPool::instance().release(block_, sizeClass_);
+        }
+        sizeClass_ = INLINE_CLASS;
+        size_ = 0;
+    }
+
+    const uint8_t* data() const {
+        if (isInline()) {
+            return inline_;
+        }
+        return isShared() ? shared_->data() : block_;
+    }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool isInline() const { return sizeClass_ == INLINE_CLASS; }
+    bool isShared() const { return sizeClass_ == SHARED_CLASS; }
+    const SharedPayload* shared() const { return isShared() ? shared_ : nullptr; }
+
+private:
+    static constexpr uint8_t INLINE_CLASS = 0xFF;
+    static constexpr uint8_t SHARED_CLASS = 0xFE;
+
+    void copyFrom(const MessagePayload& other) {
+        if (other.isShared()) {
+            other.shared_->retain();
+            adoptShared(other.shared_);
+        } else {
+            assign(other.data(), other.size());
+        }
+    }
+
+    void steal(MessagePayload& other) noexcept {
+        size_ = other.size_;
+        sizeClass_ = other.sizeClass_;
+        if (other.isInline()) {
+            std::memcpy(inline_, other.inline_, other.size_);
+        } else {
+            if (other.isShared()) {
+                shared_ = other.shared_;
+            } else {
+                block_ = other.block_;
+            }
+            other.sizeClass_ = INLINE_CLASS;
+        }
+        other.size_ = 0;
+    }
+
+    union {
+        alignas(8) uint8_t inline_[INLINE_PAYLOAD_SIZE];
+        uint8_t* block_;
+        SharedPayload* shared_;
+    };
+    uint32_t size_;
+    uint8_t sizeClass_;
+};
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "ipc/ipc.hpp"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+namespace MiniOS {
+
+class Port : public WaitSource {
+public:
+    Port(PortId id, TaskId owner, const QueueLimits& limits);
+    ~Port() override;
+
+    uint32_t poll() const override;
+    bool attach(ReadinessObserver* observer) override;
+    void detach(ReadinessObserver* observer) override;
+
+    void close() { queue_.close(); }
+
+    PortId getId() const { return id_; }
+    TaskId getOwner() const { return owner_; }
+    MessageQueue& queue() { return queue_; }
+
+private:
+    PortId id_;
+    TaskId owner_;
+    MessageQueue queue_;
+    std::mutex observerMutex_;
+    ReadinessObserver* observer_;
+};
+
+// A task's own mailbox as a wait-set source, so one wait covers direct
+// messages, bound signals and ports alike. It keeps a reference on the
+// queue, which reports a hangup once the task unregisters.
+class Mailbox : public WaitSource {
+public:
+    // The caller holds the queue under an epoch guard; the mailbox retains it.
+    explicit Mailbox(MessageQueue* queue);
+    ~Mailbox() override;
+
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    uint32_t poll() const override;
+    bool attach(ReadinessObserver* observer) override;
+    void detach(ReadinessObserver* observer) override;
+
+private:
+    MessageQueue* queue_;
+};
+
+// Epoll-style readiness set. A source that becomes ready pushes its member
+// onto the ready list at most once, so wait() costs O(ready sources) no
+// matter how many are registered. Events are level-triggered: a member that
+// is still ready after being reported goes back on the list.
+class WaitSet {
+public:
+    WaitSet() : closed_(false) {}
+    ~WaitSet();
+
+    WaitSet(const WaitSet&) = delete;
+    WaitSet& operator=(const WaitSet&) = delete;
+
+    bool add(Handle handle, std::shared_ptr<WaitSource> source, uint64_t cookie);
+    bool remove(Handle handle);
+    size_t wait(std::vector<WaitEvent>& events, size_t maxEvents, Deadline deadline);
+    void close();
+
+    size_t memberCount() const;
+
+private:
+    struct Member : ReadinessObserver {
+        Member(WaitSet* set, Handle h, std::shared_ptr<WaitSource> src, uint64_t c)
+            : owner(set), handle(h), source(std::move(src)), cookie(c), queued(false), removed(false) {}
+
+        void onReady() override { owner->markReady(this); }
+
+        WaitSet* owner;
+        Handle handle;
+        std::shared_ptr<WaitSource> source;
+        uint64_t cookie;
+        std::atomic<bool> queued;
+        bool removed;
+    };
+
+    void markReady(Member* member);
+    void retireMember(Member* member);
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::unordered_map<Handle, Member*> members_;
+    std::deque<Member*> ready_;
+    bool closed_;
+};
+
+enum class CapabilityKind {
+    Port,
+    WaitSet,
+    Notification,
+    Mailbox
+};
+
+struct Capability {
+    CapabilityKind kind;
+    uint32_t rights;
+    std::shared_ptr<Port> port;
+    std::shared_ptr<WaitSet> waitSet;
+    std::shared_ptr<Notification> notification;
+    std::shared_ptr<Mailbox> mailbox;
+
+    std::shared_ptr<WaitSource> source() const {
+        if (port) {
+            return port;
+        }
+        if (mailbox) {
+            return mailbox;
+        }
+        return notification;
+    }
+};
+
+// Per-task capability table. Handles are only meaningful to the task that
+// owns the table; passing one to another task goes through a grant.
+class HandleTable {
+public:
+    HandleTable() : nextHandle_(1) {}
+
+    Handle insert(Capability capability);
+    std::optional<Capability> lookup(Handle handle, uint32_t requiredRights) const;
+    // Runs fn on the capability in place, without copying its references.
+    template<typename Fn>
+    bool visit(Handle handle, uint32_t requiredRights, Fn&& fn) const;
+    std::optional<Capability> remove(Handle handle);
+    std::vector<Capability> clear();
+    size_t size() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<Handle, Capability> entries_;
+    Handle nextHandle_;
+};
+
+template<typename Fn>
+bool HandleTable::visit(Handle handle, uint32_t requiredRights, Fn&& fn) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(handle);
+    if (it == entries_.end() || (it->second.rights & requiredRights) != requiredRights) {
+        return false;
+    }
+    return fn(it->second);
+}
+
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "ipc/ipc.hpp"
+#include <array>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace MiniOS {
+
+// Declarative payload layouts. A schema lists its fields in order; fixed
+// fields are stored inline, variable fields as an {offset, length} slot in
+// the fixed section pointing into a trailing data region:
+//
+//   [SchemaHeader][field 0][field 1]...[variable data]
+//
+// Fields may only be appended. A reader accepts payloads written with a
+// shorter fixed section and reports the missing trailing fields as absent,
+// so older senders keep working after a schema grows.
+
+struct SchemaHeader {
+    uint16_t schemaId;
+    uint16_t version;
+    uint32_t fixedSize;
+};
+
+struct VariableSlot {
+    uint32_t offset;
+    uint32_t length;
+};
+
+template<typename T>
+struct Scalar {
+    static_assert(std::is_trivially_copyable_v<T>, "scalar fields must be trivially copyable");
+    using type = T;
+    using element = T;
+    static constexpr bool VARIABLE = false;
+    static constexpr size_t FIXED_SIZE = sizeof(T);
+};
+
+template<typename T>
+struct Array {
+    static_assert(std::is_trivially_copyable_v<T>, "array elements must be trivially copyable");
+    using element = T;
+    static constexpr bool VARIABLE = true;
+    static constexpr size_t FIXED_SIZE = sizeof(VariableSlot);
+};
+
+using Bytes = Array<uint8_t>;
+
+template<uint16_t Id, uint16_t Version, typename... Fields>
+struct Schema {
+    static constexpr uint16_t ID = Id;
+    static constexpr uint16_t VERSION = Version;
+    static constexpr size_t FIELD_COUNT = sizeof...(Fields);
+
+    template<size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    static constexpr std::array<size_t, FIELD_COUNT> SIZES = {Fields::FIXED_SIZE...};
+    static constexpr std::array<size_t, FIELD_COUNT> ELEMENT_SIZES = {sizeof(typename Fields::element)...};
+    static constexpr std::array<bool, FIELD_COUNT> IS_VARIABLE = {Fields::VARIABLE...};
+
+    static constexpr size_t offsetOf(size_t field) {
+        size_t offset = sizeof(SchemaHeader);
+        for (size_t i = 0; i < field; ++i) {
+            offset += SIZES[i];
+        }
+        return offset;
+    }
+
+    static constexpr size_t variableIndex(size_t field) {
+        size_t index = 0;
+        for (size_t i = 0; i < field; ++i) {
+            index += IS_VARIABLE[i] ? 1 : 0;
+        }
+        return index;
+    }
+
+    static constexpr size_t FIXED_SIZE = offsetOf(FIELD_COUNT);
+    static constexpr size_t VARIABLE_COUNT = variableIndex(FIELD_COUNT);
+
+    using Lengths = std::array<size_t, VARIABLE_COUNT>;
+};
+
+// Read-only window onto the elements of a variable field. Elements are
+// loaded with memcpy, so the payload needs no particular alignment.
+template<typename T>
+class ArrayView {
+public:
+    ArrayView() : data_(nullptr), count_(0) {}
+    ArrayView(const uint8_t* data, size_t count) : data_(data), count_(count) {}
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const uint8_t* data() const { return data_; }
+
+    T operator[](size_t index) const {
+        T value;
+        std::memcpy(&value, data_ + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t count_;
+};
+
+// Zero-copy accessor over a payload. parse() validates the header and every
+// variable slot once; the accessors afterwards only index into the payload.
+template<typename S>
+class SchemaView {
+public:
+    static std::optional<SchemaView> parse(const uint8_t* data, size_t size);
+    static std::optional<SchemaView> parse(const MessagePayload& payload) {
+        return parse(payload.data(), payload.size());
+    }
+
+    uint16_t version() const { return version_; }
+
+    template<size_t I>
+    bool has() const { return S::offsetOf(I) + S::SIZES[I] <= fixedSize_; }
+
+    template<size_t I>
+    typename S::template Field<I>::type get() const {
+        using T = typename S::template Field<I>::type;
+        T value{};
+        if (has<I>()) {
+            std::memcpy(&value, data_ + S::offsetOf(I), sizeof(T));
+        }
+        return value;
+    }
+
+    template<size_t I>
+    ArrayView<typename S::template Field<I>::element> array() const {
+        using T = typename S::template Field<I>::element;
+        static_assert(S::IS_VARIABLE[I], "array() needs a variable field");
+        if (!has<I>()) {
+            return {};
+        }
+        VariableSlot slot = slotAt(S::offsetOf(I));
+        return {data_ + slot.offset, slot.length / sizeof(T)};
+    }
+
+    template<size_t I>
+    std::string_view text() const {
+        auto bytes = array<I>();
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+private:
+    SchemaView(const uint8_t* data, uint16_t version, uint32_t fixedSize)
+        : data_(data), version_(version), fixedSize_(fixedSize) {}
+
+    VariableSlot slotAt(size_t offset) const {
+        VariableSlot slot;
+        std::memcpy(&slot, data_ + offset, sizeof(slot));
+        return slot;
+    }
+
+    const uint8_t* data_;
+    uint16_t version_;
+    uint32_t fixedSize_;
+};
+
+template<typename S>
+std::optional<SchemaView<S>> SchemaView<S>::parse(const uint8_t* data, size_t size) {
+    SchemaHeader header;
+    if (!data || size < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.schemaId != S::ID || header.fixedSize < sizeof(header) || header.fixedSize > size) {
+        return std::nullopt;
+    }
+
+    SchemaView view(data, header.version, header.fixedSize);
+    for (size_t i = 0; i < S::FIELD_COUNT; ++i) {
+        size_t offset = S::offsetOf(i);
+        if (!S::IS_VARIABLE[i] || offset + S::SIZES[i] > header.fixedSize) {
+            continue;
+        }
+        VariableSlot slot = view.slotAt(offset);
+        if (slot.offset < header.fixedSize ||
+            uint64_t(slot.offset) + slot.length > size ||
+            slot.length % S::ELEMENT_SIZES[i] != 0) {
+            return std::nullopt;
+        }
+    }
+    return view;
+}
+
+// Lays a schema out directly in a message's payload storage (inline bytes or
+// a pooled block) so the bytes written here are the ones that travel through
+// the queue. Variable lengths are given in elements, in field order.
+template<typename S>
+class SchemaBuilder {
+public:
+    explicit SchemaBuilder(MessagePayload& payload, const typename S::Lengths& lengths = {});
+    explicit SchemaBuilder(Message& msg, const typename S::Lengths& lengths = {})
+        : SchemaBuilder(msg.payload, lengths) {}
+
+    static size_t sizeFor(const typename S::Lengths& lengths);
+
+    bool ok() const { return base_ != nullptr; }
+
+    template<size_t I>
+    void set(const typename S::template Field<I>::type& value) {
+        static_assert(!S::IS_VARIABLE[I], "set() needs a fixed field");
+        std::memcpy(base_ + S::offsetOf(I), &value, sizeof(value));
+    }
+
+    // Writable storage for a variable field, sized by the constructor.
+    template<size_t I>
+    uint8_t* data() {
+        static_assert(S::IS_VARIABLE[I], "data() needs a variable field");
+        VariableSlot slot;
+        std::memcpy(&slot, base_ + S::offsetOf(I), sizeof(slot));
+        return base_ + slot.offset;
+    }
+
+    template<size_t I>
+    void setElement(size_t index, const typename S::template Field<I>::element& value) {
+        std::memcpy(data<I>() + index * sizeof(value), &value, sizeof(value));
+    }
+
+    template<size_t I>
+    void assign(const void* source) {
+        VariableSlot slot;
+        std::memcpy(&slot, base_ + S::offsetOf(I), sizeof(slot));
+        if (slot.length > 0) {
+            std::memcpy(base_ + slot.offset, source, slot.length);
+        }
+    }
+
+private:
+    static size_t alignUp(size_t value) { return (value + 7) & ~size_t(7); }
+
+    uint8_t* base_;
+};
+
+template<typename S>
+size_t SchemaBuilder<S>::sizeFor(const typename S::Lengths& lengths) {
+    size_t size = alignUp(S::FIXED_SIZE);
+    for (size_t i = 0, v = 0; i < S::FIELD_COUNT; ++i) {
+        if (S::IS_VARIABLE[i]) {
+            size += alignUp(lengths[v++] * S::ELEMENT_SIZES[i]);
+        }
+    }
+    return size;
+}
+
+template<typename S>
+SchemaBuilder<S>::SchemaBuilder(MessagePayload& payload, const typename S::Lengths& lengths)
+    : base_(nullptr)
+{
+    size_t size = sizeFor(lengths);
+    if (size > MAX_MESSAGE_SIZE) {
+        return;
+    }
+    base_ = payload.allocate(size);
+    if (!base_) {
+        return;
+    }
+
+    std::memset(base_, 0, S::FIXED_SIZE);
+    SchemaHeader header{S::ID, S::VERSION, static_cast<uint32_t>(S::FIXED_SIZE)};
+    std::memcpy(base_, &header, sizeof(header));
+
+    size_t cursor = alignUp(S::FIXED_SIZE);
+    for (size_t i = 0, v = 0; i < S::FIELD_COUNT; ++i) {
+        if (!S::IS_VARIABLE[i]) {
+            continue;
+        }
+        VariableSlot slot{static_cast<uint32_t>(cursor),
+                          static_cast<uint32_t>(lengths[v++] * S::ELEMENT_SIZES[i])};
+        std::memcpy(base_ + S::offsetOf(i), &slot, sizeof(slot));
+        std::memset(base_ + cursor + slot.length, 0, alignUp(slot.length) - slot.length);
+        cursor += alignUp(slot.length);
+    }
+}
+
+template<typename S>
+std::optional<SchemaView<S>> viewAs(const Message& msg) {
+    return SchemaView<S>::parse(msg.payload);
+}
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "ipc/ipc.hpp"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MiniOS {
+
+constexpr size_t DEFAULT_RING_BYTES = 1 << 20;
+constexpr size_t TRANSPORT_RECEIVE_BATCH = 256;
+
+// Fixed-size frame header written in front of every payload in a ring.
+struct WireFrame {
+    uint32_t length;
+    MessageId id;
+    TaskId sender;
+    TaskId receiver;
+    MessageId correlationId;
+    uint8_t type;
+    uint8_t priority;
+    uint16_t reserved;
+};
+
+// Single-producer, single-consumer byte ring living in memory shared by two
+// processes. Frames never wrap: when the tail of the buffer is too short the
+// producer writes a padding marker and starts again at offset zero.
+//
+// The consumer raises `sleeping` before it blocks on the socket; a producer
+// that observes it clears it and sends one doorbell byte.
+class ShmRing {
+public:
+    struct alignas(CACHE_LINE_SIZE) Header {
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> sleeping;
+        uint64_t capacity;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring indices must be address-free");
+
+    static size_t regionSize(size_t capacity) { return sizeof(Header) + capacity; }
+
+    ShmRing() : header_(nullptr), data_(nullptr), mask_(0), cachedHead_(0), corrupt_(false) {}
+    ShmRing(void* region, size_t capacity, bool initialize);
+
+    bool write(const Message& msg, TaskId receiver);
+
+    // Hands each frame to fn(frame, payload); a false return leaves that
+    // frame in the ring and stops the drain. The peer can write anything
+    // into the ring, so every index and length is checked against the
+    // ring before use; a frame that fails marks the ring corrupt.
+    template<typename Fn>
+    size_t drain(size_t maxFrames, Fn&& fn);
+
+    bool corrupt() const { return corrupt_; }
+    bool empty() const;
+    bool armDoorbell();
+    void disarmDoorbell() { header_->sleeping.store(0, std::memory_order_relaxed); }
+    bool takeDoorbell();
+
+private:
+    static constexpr uint32_t PADDING = 0xFFFFFFFFu;
+
+    static size_t frameBytes(size_t payload) {
+        return (sizeof(WireFrame) + payload + 7) & ~size_t(7);
+    }
+
+    Header* header_;
+    uint8_t* data_;
+    uint64_t mask_;
+    uint64_t cachedHead_;
+    bool corrupt_;
+};
+
+template<typename Fn>
+size_t ShmRing::drain(size_t maxFrames, Fn&& fn) {
+    uint64_t capacity = mask_ + 1;
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t tail = header_->tail.load(std::memory_order_acquire);
+    size_t count = 0;
+
+    if (corrupt_ || tail - head > capacity || (head & 7) != 0) {
+        corrupt_ = true;
+        return 0;
+    }
+
+    while (head != tail && count < maxFrames) {
+        uint64_t offset = head & mask_;
+        uint64_t contiguous = capacity - offset;
+        uint64_t available = tail - head;
+
+        uint32_t length;
+        std::memcpy(&length, data_ + offset, sizeof(length));
+        if (length == PADDING) {
+            if (contiguous > available) {
+                corrupt_ = true;
+                break;
+            }
+            head += contiguous;
+            continue;
+        }
+
+        // Copy the header out so the peer cannot change it after the checks.
+        WireFrame frame;
+        if (sizeof(WireFrame) > contiguous) {
+            corrupt_ = true;
+            break;
+        }
+        std::memcpy(&frame, data_ + offset, sizeof(WireFrame));
+        uint64_t bytes = frameBytes(frame.length);
+        if (frame.length > MAX_MESSAGE_SIZE || bytes > contiguous || bytes > available) {
+            corrupt_ = true;
+            break;
+        }
+        if (!fn(frame, data_ + offset + sizeof(WireFrame))) {
+            break;
+        }
+        head += bytes;
+        count++;
+    }
+
+    header_->head.store(head, std::memory_order_release);
+    return count;
+}
+
+// Bridges IPCManager queues between kernel instances in separate host
+// processes. Each peer link is one Unix domain socket, used for the
+// handshake (which passes a memfd holding both rings) and afterwards only
+// for doorbells; message data moves through the shared rings.
+//
+// Messages to remoteTaskId(node, task) are routed to the link for that node,
+// and arriving messages carry the sender's global id so replies route back.
+class IPCTransport : public RemoteRouter {
+public:
+    IPCTransport(IPCManager& ipc, NodeId localNode, size_t ringBytes = DEFAULT_RING_BYTES);
+    ~IPCTransport() override;
+
+    IPCTransport(const IPCTransport&) = delete;
+    IPCTransport& operator=(const IPCTransport&) = delete;
+
+    bool listen(const std::string& path);
+    bool connect(const std::string& path);
+    void shutdown();
+
+    bool forward(Message& msg) override;
+
+    NodeId getLocalNode() const { return localNode_; }
+    bool isConnected(NodeId node) const;
+    uint64_t getFramesSent() const { return framesSent_.load(std::memory_order_relaxed); }
+    uint64_t getFramesReceived() const { return framesReceived_.load(std::memory_order_relaxed); }
+    std::string getTransportReport() const;
+
+private:
+    struct Hello {
+        uint32_t magic;
+        NodeId node;
+        uint64_t ringBytes;
+    };
+
+    struct Link {
+        NodeId peer = 0;
+        int socket = -1;
+        void* region = nullptr;
+        size_t regionBytes = 0;
+        ShmRing outbound;
+        ShmRing inbound;
+        std::mutex sendMutex;
+        std::atomic<bool> connected{false};
+        std::thread receiver;
+        std::vector<Message> backlog;
+    };
+
+    bool addLink(int socket, NodeId peer, void* region, size_t regionBytes, bool initiator);
+    void acceptLoop();
+    void receiveLoop(Link* link);
+    size_t deliverFrames(Link* link);
+    size_t flushBacklog(Link* link);
+
+    IPCManager& ipc_;
+    NodeId localNode_;
+    size_t ringBytes_;
+
+    int listenSocket_;
+    std::string listenPath_;
+    std::thread acceptThread_;
+    std::atomic<bool> running_;
+
+    std::array<std::atomic<Link*>, MAX_NODES> links_;
+    std::vector<std::unique_ptr<Link>> ownedLinks_;
+    mutable std::mutex linksMutex_;
+
+    std::atomic<uint64_t> framesSent_;
+    std::atomic<uint64_t> framesReceived_;
+    std::atomic<uint64_t> doorbells_;
+};
+
+}
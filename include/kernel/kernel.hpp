@@ -2,10 +2,13 @@
 
 #include "kernel/types.hpp"
 #include "scheduler/scheduler.hpp"
+#include "scheduler/futex.hpp"
 #include "mm/memory_manager.hpp"
 #include "fs/filesystem.hpp"
 #include "ipc/ipc.hpp"
 #include "drivers/driver.hpp"
+#include "drivers/block.hpp"
+#include "drivers/network.hpp"
 #include "utils/logger.hpp"
 #include <memory>
 #include <atomic>
@@ -40,11 +43,13 @@ public:
     void shutdown();
 
     Scheduler& getScheduler() { return *scheduler_; }
+    FutexTable& getFutexTable() { return *futexTable_; }
     MemoryManager& getMemoryManager() { return *memoryManager_; }
     FileSystem& getFileSystem() { return *fileSystem_; }
     IPCManager& getIPCManager() { return *ipcManager_; }
     DriverManager& getDriverManager() { return *driverManager_; }
     InterruptController& getInterruptController() { return *interruptController_; }
+    NetworkStack& getNetworkStack() { return *networkStack_; }
 
     KernelState getState() const { return state_; }
     uint64_t getUptime() const;
@@ -67,11 +72,13 @@ private:
     void handleTimerInterrupt(InterruptNumber num, void* data);
 
     std::unique_ptr<Scheduler> scheduler_;
+    std::unique_ptr<FutexTable> futexTable_;
     std::unique_ptr<MemoryManager> memoryManager_;
     std::unique_ptr<FileSystem> fileSystem_;
     std::unique_ptr<IPCManager> ipcManager_;
     std::unique_ptr<DriverManager> driverManager_;
     std::unique_ptr<InterruptController> interruptController_;
+    std::unique_ptr<NetworkStack> networkStack_;
 
     KernelState state_;
     std::atomic<bool> running_;
@@ -80,6 +87,8 @@ private:
 
     static constexpr const char* VERSION = "0.1.0";
     static constexpr const char* NAME = "MiniOS";
+    static constexpr SectorNumber RAM_DISK_SECTORS = 2048;
+    static constexpr size_t LOOPBACK_FRAMES = 1024;
 };
 
 #define SYSCALL(id, ...) MiniOS::SystemCall::dispatch(MiniOS::SystemCallId::id, ##__VA_ARGS__)
@@ -8,6 +8,7 @@
 #include <functional>
 #include <optional>
 #include <variant>
+#include <chrono>
 
 namespace MiniOS {
 
@@ -18,10 +19,15 @@ using FrameNumber = uint32_t;
 using FileDescriptor = int32_t;
 using MessageId = uint32_t;
 using InterruptNumber = uint16_t;
+using RegionId = uint32_t;
+using Deadline = std::chrono::steady_clock::time_point;
 
 constexpr TaskId INVALID_TASK_ID = 0xFFFFFFFF;
 constexpr FileDescriptor INVALID_FD = -1;
+constexpr RegionId INVALID_REGION_ID = 0;
+constexpr Deadline NO_DEADLINE = Deadline::max();
 constexpr size_t PAGE_SIZE = 4096;
+constexpr size_t CACHE_LINE_SIZE = 64;
 constexpr size_t MAX_TASKS = 256;
 constexpr size_t MAX_OPEN_FILES = 1024;
 constexpr size_t TIME_QUANTUM_MS = 100;
@@ -75,7 +81,8 @@ enum class SystemCallId {
     Yield = 10,
     Sleep = 11,
     GetPid = 12,
-    CreateTask = 13
+    CreateTask = 13,
+    Futex = 14
 };
 
 struct CPUContext {
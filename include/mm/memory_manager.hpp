@@ -18,10 +18,12 @@ struct PageTableEntry {
     bool dirty;
     bool accessed;
     MemoryProtection protection;
+    RegionId region;
     
     PageTableEntry() 
         : frameNumber(0), present(false), dirty(false), 
-          accessed(false), protection(MemoryProtection::None) {}
+          accessed(false), protection(MemoryProtection::None),
+          region(INVALID_REGION_ID) {}
 };
 
 struct PageTable {
@@ -31,6 +33,25 @@ struct PageTable {
     explicit PageTable(TaskId owner) : ownerId(owner) {}
 };
 
+enum class GrantMode {
+    Share,
+    Transfer
+};
+
+struct SharedRegion {
+    RegionId id;
+    TaskId owner;
+    FrameNumber firstFrame;
+    size_t pageCount;
+    std::map<TaskId, PageNumber> mappings;
+    uint32_t pinCount;
+    bool destroyPending;
+
+    SharedRegion(RegionId regionId, TaskId ownerId, FrameNumber first, size_t pages)
+        : id(regionId), owner(ownerId), firstFrame(first), pageCount(pages),
+          pinCount(0), destroyPending(false) {}
+};
+
 class MemoryManager {
 public:
     MemoryManager();
@@ -46,6 +67,19 @@ public:
     std::optional<FrameNumber> translateAddress(TaskId taskId, PageNumber virtualPage);
     bool handlePageFault(TaskId taskId, PageNumber virtualPage);
 
+    RegionId createSharedRegion(TaskId owner, size_t pageCount);
+    bool destroySharedRegion(RegionId region);
+    bool mapSharedRegion(RegionId region, TaskId taskId, PageNumber baseVirtualPage,
+                         MemoryProtection protection = MemoryProtection::ReadWrite);
+    bool unmapSharedRegion(RegionId region, TaskId taskId);
+    bool transferRegion(RegionId region, TaskId from, TaskId to);
+    bool pinRegion(RegionId region);
+    bool unpinRegion(RegionId region);
+
+    const SharedRegion* getSharedRegion(RegionId region) const;
+    std::optional<void*> getRegionAddress(RegionId region);
+    bool isRegionMapped(RegionId region, TaskId taskId) const;
+
     bool setProtection(TaskId taskId, PageNumber virtualPage, MemoryProtection protection);
     std::optional<MemoryProtection> getProtection(TaskId taskId, PageNumber virtualPage);
 
@@ -58,15 +92,19 @@ public:
 
 private:
     std::optional<FrameNumber> allocateFrame();
+    std::optional<FrameNumber> allocateContiguousFrames(size_t count);
     bool freeFrame(FrameNumber frame);
     bool isFrameFree(FrameNumber frame) const;
+    void releaseRegionIfUnused(RegionId region);
 
     std::vector<uint8_t> physicalMemory_;
     std::bitset<TOTAL_PHYSICAL_FRAMES> frameAllocationMap_;
     std::map<TaskId, std::unique_ptr<PageTable>> pageTables_;
+    std::map<RegionId, std::unique_ptr<SharedRegion>> sharedRegions_;
     
     size_t totalAllocatedPages_;
     size_t pageFaultCount_;
+    RegionId nextRegionId_;
 };
 
 class HeapAllocator {
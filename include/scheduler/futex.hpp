@@ -0,0 +1,194 @@
+#pragma once
+
+#include "kernel/types.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+
+namespace MiniOS {
+
+using FutexWord = std::atomic<uint32_t>;
+
+constexpr uint32_t FUTEX_BITSET_MATCH_ANY = 0xFFFFFFFFu;
+constexpr size_t FUTEX_HASH_BUCKETS = 256;
+// Futex key space of every task: they all run in one address space.
+constexpr TaskId KERNEL_ADDRESS_SPACE = 0;
+
+enum class FutexOp : uint32_t {
+    Wait,
+    Wake,
+    Requeue,
+    CmpRequeue,
+    WaitBitset,
+    WakeBitset
+};
+
+// Negated in the Futex syscall's return value.
+enum class FutexStatus {
+    Woken = 0,
+    ValueMismatch = 1,
+    TimedOut = 2,
+    Invalid = 3
+};
+
+// Argument block for the Futex syscall, passed by address in arg1.
+struct FutexRequest {
+    FutexOp op;
+    FutexWord* word;
+    // Wait: value *word must still hold. Wake and requeue: tasks to wake.
+    uint32_t value;
+    uint32_t bitset = FUTEX_BITSET_MATCH_ANY;
+    // Requeue: waiters beyond `value` move to `target`, at most requeueLimit.
+    FutexWord* target = nullptr;
+    uint32_t requeueLimit = 0;
+    // CmpRequeue: value *word must still hold.
+    uint32_t compare = 0;
+    Deadline deadline = NO_DEADLINE;
+};
+
+// Kernel side of the futex: hashed wait queues keyed by (address space,
+// virtual address). The value check in wait() happens under the bucket lock,
+// so a wake that follows a user-space store can never be missed.
+class FutexTable {
+public:
+    using TaskStateHook = std::function<void(TaskId)>;
+
+    FutexTable();
+
+    FutexTable(const FutexTable&) = delete;
+    FutexTable& operator=(const FutexTable&) = delete;
+
+    void setBlockingHooks(TaskStateHook onBlock, TaskStateHook onWake);
+
+    // The blocking hooks only run for a real task.
+    FutexStatus wait(TaskId task, TaskId space, const FutexWord* word, uint32_t expected,
+                     Deadline deadline = NO_DEADLINE, uint32_t bitset = FUTEX_BITSET_MATCH_ANY);
+    size_t wake(TaskId space, const FutexWord* word, size_t count,
+                uint32_t bitset = FUTEX_BITSET_MATCH_ANY);
+    // Wakes up to wakeCount waiters on `from` and moves up to requeueLimit
+    // of the rest onto `to` without waking them. Returns both counts summed,
+    // or nullopt if a compare value was given and *from no longer holds it.
+    std::optional<size_t> requeue(TaskId space, const FutexWord* from, const FutexWord* to,
+                                  size_t wakeCount, size_t requeueLimit,
+                                  std::optional<uint32_t> compare = std::nullopt);
+
+    // Futex syscall entry point.
+    int64_t handle(TaskId task, TaskId space, const FutexRequest& request);
+
+    size_t getWaiterCount(TaskId space, const FutexWord* word) const;
+    uint64_t getSyscallCount() const { return syscalls_.load(std::memory_order_relaxed); }
+    std::string getFutexReport() const;
+
+private:
+    struct Key {
+        TaskId space;
+        uintptr_t address;
+
+        bool operator==(const Key& other) const {
+            return space == other.space && address == other.address;
+        }
+    };
+
+    struct Bucket;
+
+    // Lives on the waiting thread's stack. `bucket` and `queued` only change
+    // under the bucket lock; `woken` under the waiter's own mutex.
+    struct Waiter {
+        TaskId task;
+        Key key;
+        uint32_t bitset;
+        std::atomic<Bucket*> bucket;
+        std::list<Waiter*>::iterator position;
+        bool queued;
+        bool woken;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Bucket {
+        mutable std::mutex mutex;
+        std::list<Waiter*> waiters;
+    };
+
+    static Key keyFor(TaskId space, const FutexWord* word) {
+        return {space, reinterpret_cast<uintptr_t>(word)};
+    }
+    static size_t bucketIndex(const Key& key);
+    void signalWaiter(Waiter* waiter);
+    bool dequeueWaiter(Waiter& waiter);
+
+    std::array<Bucket, FUTEX_HASH_BUCKETS> buckets_;
+    TaskStateHook onBlock_;
+    TaskStateHook onWake_;
+
+    std::atomic<uint64_t> syscalls_;
+    std::atomic<uint64_t> waits_;
+    std::atomic<uint64_t> wakes_;
+    std::atomic<uint64_t> requeued_;
+    std::atomic<uint64_t> timeouts_;
+    std::atomic<uint64_t> mismatches_;
+};
+
+// User-level mutex over one futex word: 0 free, 1 held, 2 held with
+// waiters. lock() and unlock() stay in user space unless contended, and a
+// contended operation costs one Futex syscall. lock() returns false, without
+// the mutex, if the kernel refuses the syscall (it is not booted).
+class FutexMutex {
+public:
+    FutexMutex() : word_(0) {}
+
+    FutexMutex(const FutexMutex&) = delete;
+    FutexMutex& operator=(const FutexMutex&) = delete;
+
+    bool lock() {
+        uint32_t expected = 0;
+        return word_.compare_exchange_strong(expected, 1, std::memory_order_acquire) ||
+               lockContended();
+    }
+
+    bool try_lock() {
+        uint32_t expected = 0;
+        return word_.compare_exchange_strong(expected, 1, std::memory_order_acquire);
+    }
+
+    void unlock() {
+        if (word_.fetch_sub(1, std::memory_order_release) != 1) {
+            unlockContended();
+        }
+    }
+
+private:
+    friend class FutexCondition;
+
+    bool lockContended();
+    void unlockContended();
+
+    FutexWord word_;
+};
+
+// Sequence-counter condition variable. notifyAll() takes the mutex the
+// caller holds, wakes one waiter and requeues the rest onto the mutex word,
+// so they are released one unlock at a time instead of racing for the lock.
+class FutexCondition {
+public:
+    FutexCondition() : sequence_(0) {}
+
+    FutexCondition(const FutexCondition&) = delete;
+    FutexCondition& operator=(const FutexCondition&) = delete;
+
+    // False on timeout or when the kernel refuses the syscall; in the
+    // latter case the mutex is only held again if relocking succeeded.
+    bool wait(FutexMutex& mutex) { return waitUntil(mutex, NO_DEADLINE); }
+    bool waitUntil(FutexMutex& mutex, Deadline deadline);
+    void notifyOne();
+    void notifyAll(FutexMutex& held);
+
+private:
+    FutexWord sequence_;
+};
+
+}
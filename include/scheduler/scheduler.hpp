@@ -7,6 +7,7 @@
 #include <map>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 namespace MiniOS {
 
@@ -26,6 +27,7 @@ public:
     bool terminateTask(TaskId id);
     bool blockTask(TaskId id);
     bool unblockTask(TaskId id);
+    bool handoff(TaskId from, TaskId to, bool blockFrom);
     
     void schedule();
     void tick();
@@ -39,6 +41,7 @@ public:
     
     size_t getReadyQueueSize() const;
     size_t getTotalTasks() const { return tasks_.size(); }
+    uint64_t getHandoffCount() const { return handoffCount_; }
     
     void printTaskStates() const;
     std::string getTaskReport() const;
@@ -48,7 +51,7 @@ private:
     TaskId selectNextTask();
     TaskId selectRoundRobin();
     TaskId selectPriority();
-    void addToReadyQueue(TaskId id);
+    void addToReadyQueue(TaskId id, bool front = false);
     void removeFromReadyQueue(TaskId id);
 
     SchedulerType type_;
@@ -61,7 +64,9 @@ private:
     std::map<TaskPriority, std::deque<TaskId>> priorityQueues_;
     
     uint64_t tickCount_;
+    uint64_t handoffCount_;
     bool schedulerRunning_;
+    mutable std::recursive_mutex mutex_;
 };
 
 }
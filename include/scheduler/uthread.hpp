@@ -0,0 +1,171 @@
+#pragma once
+
+#include "kernel/types.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ucontext.h>
+
+namespace MiniOS {
+
+class Scheduler;
+
+using UThreadId = uint64_t;
+
+constexpr size_t UTHREAD_STACK_SIZE = 16 * 1024;
+constexpr size_t UTHREAD_STACK_CACHE = 256;
+constexpr size_t UTHREAD_STEAL_BATCH = 32;
+// The blocking pool grows past UThreadConfig::blockingThreads up to this
+// many helpers; beyond it, blocking calls queue for a free one.
+constexpr size_t UTHREAD_MAX_BLOCKING_THREADS = 256;
+
+struct UThreadConfig {
+    size_t carriers = 4;
+    size_t stackSize = UTHREAD_STACK_SIZE;
+    size_t blockingThreads = 4;
+    // When set, every carrier is registered with it as a kernel task.
+    Scheduler* scheduler = nullptr;
+};
+
+enum class UThreadState : uint32_t {
+    Runnable,
+    Running,
+    Parked,
+    Done
+};
+
+class UThreadRuntime;
+struct UThreadStack;
+
+// A lightweight thread. Until it first runs it is only this control block;
+// the context and stack are taken from the carrier's cache on dispatch and
+// returned when the function finishes. A thread that has run and parked
+// keeps its stack, of which only the pages it touched are resident.
+struct UThread {
+    UThreadId id;
+    std::function<void()> function;
+    std::atomic<UThreadState> state;
+    std::atomic<bool> permit;
+    // One for the runtime, one per blocking call in flight.
+    std::atomic<uint32_t> refs;
+    UThreadRuntime* runtime;
+    size_t carrier;
+    UThreadStack* stack;
+};
+
+// M:N runtime: many UThreads multiplexed onto a few carrier threads, each
+// standing for one kernel task. Carriers run their own queue in FIFO order
+// and steal from the back of a sibling's queue when it runs dry.
+//
+// Switches are cooperative: a UThread runs until it yields, parks, makes a
+// blocking call or returns. A blocking call is shipped to a helper thread
+// and the carrier moves on to the next UThread until it completes. A call
+// that finds no idle helper starts another, so blocking calls that wait on
+// each other cannot deadlock the pool below UTHREAD_MAX_BLOCKING_THREADS.
+class UThreadRuntime {
+public:
+    explicit UThreadRuntime(const UThreadConfig& config = UThreadConfig());
+    // Waits for every UThread to finish.
+    ~UThreadRuntime();
+
+    UThreadRuntime(const UThreadRuntime&) = delete;
+    UThreadRuntime& operator=(const UThreadRuntime&) = delete;
+
+    UThreadId spawn(std::function<void()> function);
+    void waitAll();
+
+    // These act on the calling UThread; outside one they fall back to the
+    // host thread (yield) or run inline (blocking).
+    static UThread* current();
+    static void yield();
+    static void park();
+    static void unpark(UThread* thread);
+    template<typename Fn>
+    static auto blocking(Fn&& fn) -> decltype(fn());
+    static int64_t syscall(SystemCallId id, uint64_t arg1 = 0, uint64_t arg2 = 0, uint64_t arg3 = 0);
+
+    size_t getCarrierCount() const { return carriers_.size(); }
+    TaskId getCarrierTask(size_t carrier) const { return carriers_[carrier]->task; }
+    size_t getLiveCount() const { return live_.load(std::memory_order_relaxed); }
+    size_t getBlockingThreadCount() const;
+    uint64_t getSwitchCount() const;
+    uint64_t getStealCount() const;
+    std::string getRuntimeReport() const;
+
+private:
+    enum class SwitchReason {
+        Yield,
+        Park,
+        Exit
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Carrier {
+        size_t index = 0;
+        TaskId task = INVALID_TASK_ID;
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<UThread*> queue;
+        ucontext_t context;
+        UThread* current = nullptr;
+        SwitchReason reason = SwitchReason::Yield;
+        std::vector<UThreadStack*> freeStacks;
+        std::atomic<uint64_t> switches{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    static Carrier* currentCarrier();
+    static void trampoline();
+    static void switchOut(SwitchReason reason);
+    static void runBlocking(std::function<void()> job);
+
+    void carrierLoop(Carrier& carrier);
+    UThread* next(Carrier& carrier);
+    UThread* steal(Carrier& thief);
+    void dispatch(Carrier& carrier, UThread* thread);
+    void enqueue(size_t carrier, UThread* thread);
+    void release(UThread* thread);
+    UThreadStack* acquireStack(Carrier& carrier);
+    void releaseStack(Carrier& carrier, UThreadStack* stack);
+    void blockingLoop();
+
+    size_t stackSize_;
+    std::vector<std::unique_ptr<Carrier>> carriers_;
+    std::atomic<UThreadId> nextId_;
+    std::atomic<size_t> nextCarrier_;
+    std::atomic<size_t> live_;
+    std::atomic<bool> stopping_;
+
+    std::mutex idleMutex_;
+    std::condition_variable idleCondition_;
+    std::atomic<uint32_t> sleepers_;
+
+    std::mutex doneMutex_;
+    std::condition_variable doneCondition_;
+
+    std::vector<std::thread> blockingThreads_;
+    mutable std::mutex blockingMutex_;
+    std::condition_variable blockingCondition_;
+    std::deque<std::function<void()>> blockingJobs_;
+    size_t idleBlocking_;
+};
+
+template<typename Fn>
+auto UThreadRuntime::blocking(Fn&& fn) -> decltype(fn()) {
+    using Result = decltype(fn());
+    if constexpr (std::is_void_v<Result>) {
+        runBlocking([&fn]() { fn(); });
+    } else {
+        std::optional<Result> result;
+        runBlocking([&fn, &result]() { result.emplace(fn()); });
+        return std::move(*result);
+    }
+}
+
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "kernel/types.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MiniOS {
+
+// Epoch-based reclamation for read-mostly structures. Readers pin the global
+// epoch while they hold pointers into a shared structure; a writer unlinks an
+// object and retires it, and the object is destroyed once every pinned reader
+// has moved past the epoch it was retired in.
+class EpochDomain {
+public:
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    class Guard {
+    public:
+        Guard() : domain_(EpochDomain::instance()) { domain_.enter(); }
+        ~Guard() { domain_.exit(); }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        EpochDomain& domain_;
+    };
+
+    void retire(std::function<void()> reclaim) {
+        uint64_t epoch = globalEpoch_.fetch_add(1, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(limboMutex_);
+            limbo_.push_back({epoch, std::move(reclaim)});
+        }
+        // Readers never reclaim; a retire() that finds another writer
+        // collecting leaves its object for that writer's next pass.
+        std::unique_lock<std::mutex> lock(collectMutex_, std::try_to_lock);
+        if (lock.owns_lock()) {
+            collectLocked();
+        }
+    }
+
+    void collect() {
+        std::lock_guard<std::mutex> lock(collectMutex_);
+        collectLocked();
+    }
+
+    // Waits for every reader pinned before the call to leave, for an object
+    // its owner is about to destroy in place rather than retire. The caller
+    // must not hold a Guard.
+    void synchronize() {
+        uint64_t epoch = globalEpoch_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto backoff = SYNCHRONIZE_MIN_BACKOFF;
+        for (int spin = 0; oldestPinned() <= epoch; ++spin) {
+            if (spin < SYNCHRONIZE_SPIN_LIMIT) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(backoff);
+                backoff = std::min(backoff * 2, SYNCHRONIZE_MAX_BACKOFF);
+            }
+        }
+    }
+
+    size_t pendingCount() const {
+        std::lock_guard<std::mutex> lock(limboMutex_);
+        return limbo_.size();
+    }
+
+private:
+    static constexpr uint64_t IDLE = std::numeric_limits<uint64_t>::max();
+    static constexpr int SYNCHRONIZE_SPIN_LIMIT = 16;
+    static constexpr std::chrono::microseconds SYNCHRONIZE_MIN_BACKOFF{10};
+    static constexpr std::chrono::microseconds SYNCHRONIZE_MAX_BACKOFF{1000};
+
+    // Only objects retired before the epoch is read here are eligible: one
+    // retired during the scan below may have readers it never saw.
+    void collectLocked() {
+        uint64_t current = globalEpoch_.load(std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        uint64_t oldest = std::min(current, oldestPinned());
+
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock(limboMutex_);
+            for (auto it = limbo_.begin(); it != limbo_.end();) {
+                if (it->epoch < oldest) {
+                    ready.push_back(std::move(it->reclaim));
+                    it = limbo_.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        for (auto& reclaim : ready) {
+            reclaim();
+        }
+    }
+
+    struct alignas(CACHE_LINE_SIZE) Participant {
+        std::atomic<uint64_t> epoch{IDLE};
+        std::atomic<bool> inUse{true};
+        uint32_t depth = 0;
+    };
+
+    struct Registration {
+        Participant* participant;
+
+        explicit Registration(EpochDomain& domain) : participant(domain.acquireParticipant()) {}
+        ~Registration() {
+            participant->epoch.store(IDLE, std::memory_order_release);
+            participant->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> reclaim;
+    };
+
+    EpochDomain() : globalEpoch_(0) {}
+
+    ~EpochDomain() {
+        for (auto& entry : limbo_) {
+            entry.reclaim();
+        }
+    }
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    uint64_t oldestPinned() {
+        uint64_t oldest = IDLE;
+        std::lock_guard<std::mutex> lock(participantsMutex_);
+        for (const auto& p : participants_) {
+            oldest = std::min(oldest, p->epoch.load(std::memory_order_seq_cst));
+        }
+        return oldest;
+    }
+
+    Participant* participant() {
+        thread_local Registration registration(*this);
+        return registration.participant;
+    }
+
+    Participant* acquireParticipant() {
+        std::lock_guard<std::mutex> lock(participantsMutex_);
+        for (auto& p : participants_) {
+            bool expected = false;
+            if (p->inUse.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                return p.get();
+            }
+        }
+        participants_.push_back(std::make_unique<Participant>());
+        return participants_.back().get();
+    }
+
+    void enter() {
+        Participant* p = participant();
+        if (p->depth++ == 0) {
+            p->epoch.store(globalEpoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    void exit() {
+        Participant* p = participant();
+        if (--p->depth == 0) {
+            p->epoch.store(IDLE, std::memory_order_release);
+        }
+    }
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> globalEpoch_;
+    std::vector<std::unique_ptr<Participant>> participants_;
+    std::vector<Retired> limbo_;
+    mutable std::mutex participantsMutex_;
+    std::mutex collectMutex_;
+    mutable std::mutex limboMutex_;
+};
+
+}
@@ -8,6 +8,7 @@
 #include <mutex>
 #include <vector>
 #include <fstream>
+#include <atomic>
 
 namespace MiniOS {
 
@@ -26,11 +27,12 @@ public:
         return logger;
     }
 
-    void setLevel(LogLevel level) { minLevel_ = level; }
-    LogLevel getLevel() const { return minLevel_; }
+    void setLevel(LogLevel level) { minLevel_.store(level, std::memory_order_relaxed); }
+    LogLevel getLevel() const { return minLevel_.load(std::memory_order_relaxed); }
+    bool isEnabled(LogLevel level) const { return level >= getLevel(); }
 
     void log(LogLevel level, const std::string& component, const std::string& message) {
-        if (level < minLevel_) return;
+        if (!isEnabled(level)) return;
         
         std::lock_guard<std::mutex> lock(mutex_);
         
@@ -85,14 +87,18 @@ private:
         }
     }
 
-    LogLevel minLevel_;
+    std::atomic<LogLevel> minLevel_;
     bool consoleOutput_;
     std::vector<std::string> logHistory_;
     std::mutex mutex_;
 };
 
 #define KERNEL_LOG(level, component, msg) \
-    MiniOS::Logger::instance().log(level, component, msg)
+    do { \
+        if (MiniOS::Logger::instance().isEnabled(level)) { \
+            MiniOS::Logger::instance().log(level, component, msg); \
+        } \
+    } while (0)
 
 #define LOG_DEBUG(component, msg) KERNEL_LOG(MiniOS::LogLevel::Debug, component, msg)
 #define LOG_INFO(component, msg) KERNEL_LOG(MiniOS::LogLevel::Info, component, msg)
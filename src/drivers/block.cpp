@@ -0,0 +1,592 @@
+#include "drivers/block.hpp"
+#include "drivers/elevator.hpp"
+#include <sstream>
+#include <iomanip>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace MiniOS {
+
+namespace {
+
+bool isTransfer(BlockOp op) {
+    return op == BlockOp::Read || op == BlockOp::Write;
+}
+
+// Written so that sectors near UINT64_MAX cannot wrap past the end.
+bool inRange(SectorNumber sector, uint64_t count, SectorNumber total) {
+    return sector < total && count <= total - sector;
+}
+
+// preadv/pwritev until every byte has moved, IOV_MAX segments at a time.
+bool transferAll(int fd, bool write, std::vector<iovec>& iov, off_t offset) {
+    size_t index = 0;
+    while (index < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov.size() - index, IOV_MAX));
+        ssize_t done = write ? ::pwritev(fd, &iov[index], count, offset)
+                             : ::preadv(fd, &iov[index], count, offset);
+        if (done < 0 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            return false;
+        }
+        offset += done;
+        while (done > 0) {
+            size_t step = std::min<size_t>(done, iov[index].iov_len);
+            iov[index].iov_base = static_cast<uint8_t*>(iov[index].iov_base) + step;
+            iov[index].iov_len -= step;
+            done -= step;
+            if (iov[index].iov_len == 0) {
+                index++;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+uint32_t Bio::sectorCount() const {
+    uint64_t bytes = 0;
+    for (const BioSegment& segment : segments) {
+        bytes += segment.length;
+    }
+    return static_cast<uint32_t>(bytes / SECTOR_SIZE);
+}
+
+BlockDevice::BlockDevice(const std::string& name, SectorNumber sectors, size_t hardwareQueues)
+    : Driver(name, DriverType::Block)
+    , sectors_(sectors)
+    , hardwareQueues_(std::max<size_t>(hardwareQueues, 1))
+    , position_(0)
+{
+}
+
+ssize_t BlockDevice::read(void* buffer, size_t count) {
+    if (!initialized_ || !buffer || count % SECTOR_SIZE != 0 || count > UINT32_MAX) {
+        return -1;
+    }
+
+    Bio bio;
+    bio.op = BlockOp::Read;
+    bio.sector = position_;
+    bio.segments.push_back({static_cast<uint8_t*>(buffer), static_cast<uint32_t>(count)});
+    BlockRequest request{BlockOp::Read, position_, static_cast<uint32_t>(count / SECTOR_SIZE), 0, {}};
+    request.bios.push_back(std::move(bio));
+
+    if (execute(0, request) != BlockStatus::Ok) {
+        return -1;
+    }
+    position_ += request.sectors;
+    return static_cast<ssize_t>(count);
+}
+
+ssize_t BlockDevice::write(const void* buffer, size_t count) {
+    if (!initialized_ || !buffer || count % SECTOR_SIZE != 0 || count > UINT32_MAX) {
+        return -1;
+    }
+
+    Bio bio;
+    bio.op = BlockOp::Write;
+    bio.sector = position_;
+    bio.segments.push_back({static_cast<uint8_t*>(const_cast<void*>(buffer)), static_cast<uint32_t>(count)});
+    BlockRequest request{BlockOp::Write, position_, static_cast<uint32_t>(count / SECTOR_SIZE), 0, {}};
+    request.bios.push_back(std::move(bio));
+
+    if (execute(0, request) != BlockStatus::Ok) {
+        return -1;
+    }
+    position_ += request.sectors;
+    return static_cast<ssize_t>(count);
+}
+
+bool BlockDevice::ioctl(uint32_t command, void* arg) {
+    if (!arg) {
+        return false;
+    }
+    switch (command) {
+        case BLOCK_IOCTL_GET_SECTORS:
+            *static_cast<uint64_t*>(arg) = sectors_;
+            return true;
+        case BLOCK_IOCTL_SEEK:
+            {
+                uint64_t offset = *static_cast<uint64_t*>(arg);
+                if (offset % SECTOR_SIZE != 0 || offset / SECTOR_SIZE > sectors_) {
+                    return false;
+                }
+                position_ = offset / SECTOR_SIZE;
+                return true;
+            }
+    }
+    return false;
+}
+
+RamDisk::RamDisk(const std::string& name, SectorNumber sectors, size_t hardwareQueues)
+    : BlockDevice(name, sectors, hardwareQueues)
+{
+}
+
+bool RamDisk::init() {
+    if (initialized_) {
+        return false;
+    }
+
+    memory_ = std::make_unique<uint8_t[]>(sectors_ * SECTOR_SIZE);
+    position_ = 0;
+    initialized_ = true;
+    LOG_INFO("RamDisk", name_ + ": " + std::to_string(sectors_ * SECTOR_SIZE / 1024) + " KB");
+    return true;
+}
+
+bool RamDisk::shutdown() {
+    if (!initialized_) {
+        return false;
+    }
+
+    memory_.reset();
+    initialized_ = false;
+    LOG_INFO("RamDisk", name_ + " shut down");
+    return true;
+}
+
+BlockStatus RamDisk::execute(size_t, BlockRequest& request) {
+    if (!initialized_) {
+        return BlockStatus::IoError;
+    }
+    if (!isTransfer(request.op)) {
+        return BlockStatus::Ok;
+    }
+    if (!inRange(request.sector, request.sectors, sectors_)) {
+        return BlockStatus::OutOfRange;
+    }
+
+    uint8_t* cursor = memory_.get() + request.sector * SECTOR_SIZE;
+    for (const Bio& bio : request.bios) {
+        for (const BioSegment& segment : bio.segments) {
+            if (request.op == BlockOp::Read) {
+                std::memcpy(segment.data, cursor, segment.length);
+            } else {
+                std::memcpy(cursor, segment.data, segment.length);
+            }
+            cursor += segment.length;
+        }
+    }
+    return BlockStatus::Ok;
+}
+
+FileBlockDevice::FileBlockDevice(const std::string& name, const std::string& path,
+                                 SectorNumber sectors, size_t hardwareQueues)
+    : BlockDevice(name, sectors, hardwareQueues)
+    , path_(path)
+    , fd_(-1)
+{
+}
+
+FileBlockDevice::~FileBlockDevice() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool FileBlockDevice::init() {
+    if (initialized_) {
+        return false;
+    }
+
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("FileBlockDevice", "Cannot open " + path_ + ": " + std::strerror(errno));
+        return false;
+    }
+
+    // Grow the file to the device size but keep whatever it already holds.
+    struct stat info;
+    off_t size = static_cast<off_t>(sectors_ * SECTOR_SIZE);
+    if (::fstat(fd_, &info) != 0 || (info.st_size < size && ::ftruncate(fd_, size) != 0)) {
+        LOG_ERROR("FileBlockDevice", "Cannot size " + path_ + ": " + std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    position_ = 0;
+    initialized_ = true;
+    LOG_INFO("FileBlockDevice", name_ + " backed by " + path_);
+    return true;
+}
+
+bool FileBlockDevice::shutdown() {
+    if (!initialized_) {
+        return false;
+    }
+
+    ::fdatasync(fd_);
+    ::close(fd_);
+    fd_ = -1;
+    initialized_ = false;
+    LOG_INFO("FileBlockDevice", name_ + " shut down");
+    return true;
+}
+
+BlockStatus FileBlockDevice::execute(size_t, BlockRequest& request) {
+    if (!initialized_) {
+        return BlockStatus::IoError;
+    }
+    if (request.op == BlockOp::Flush) {
+        return ::fdatasync(fd_) == 0 ? BlockStatus::Ok : BlockStatus::IoError;
+    }
+    if (!inRange(request.sector, request.sectors, sectors_)) {
+        return BlockStatus::OutOfRange;
+    }
+
+    std::vector<iovec> iov;
+    for (const Bio& bio : request.bios) {
+        for (const BioSegment& segment : bio.segments) {
+            iov.push_back({segment.data, segment.length});
+        }
+    }
+    bool ok = transferAll(fd_, request.op == BlockOp::Write, iov,
+                          static_cast<off_t>(request.sector * SECTOR_SIZE));
+    return ok ? BlockStatus::Ok : BlockStatus::IoError;
+}
+
+BlockQueue::BlockQueue(BlockDevice& device, size_t cpuCount, size_t plugDepth)
+    : device_(device)
+    , plugDepth_(std::max<size_t>(plugDepth, 1))
+    , queueDepth_(DEFAULT_QUEUE_DEPTH)
+    , maxRequestSectors_(MAX_REQUEST_SECTORS)
+    , elevator_(std::make_unique<NoopElevator>())
+    , bios_(0)
+    , merges_(0)
+    , sectors_(0)
+    , errors_(0)
+{
+    for (size_t i = 0; i < std::max<size_t>(cpuCount, 1); ++i) {
+        softwareQueues_.push_back(std::make_unique<SoftwareQueue>());
+    }
+    for (size_t i = 0; i < device.getHardwareQueueCount(); ++i) {
+        hardwareQueues_.push_back(std::make_unique<HardwareQueue>());
+    }
+}
+
+BlockQueue::~BlockQueue() = default;
+
+bool BlockQueue::submit(Bio bio) {
+    if (isTransfer(bio.op)) {
+        uint64_t bytes = 0;
+        for (const BioSegment& segment : bio.segments) {
+            if (!segment.data) {
+                return false;
+            }
+            bytes += segment.length;
+        }
+        if (bytes == 0 || bytes % SECTOR_SIZE != 0 || bytes / SECTOR_SIZE > maxRequestSectors_ ||
+            !inRange(bio.sector, bytes / SECTOR_SIZE, device_.getSectorCount())) {
+            return false;
+        }
+    }
+    bio.submittedAt = std::chrono::steady_clock::now();
+
+    size_t index = InterruptController::currentCpu() % softwareQueues_.size();
+    SoftwareQueue& queue = *softwareQueues_[index];
+    std::vector<Bio> batch;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.staged.push_back(std::move(bio));
+        if (queue.staged.size() >= plugDepth_) {
+            batch.swap(queue.staged);
+        }
+    }
+    bios_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!batch.empty()) {
+        flushPlug(batch);
+        dispatchRound(queueDepth_);
+    }
+    return true;
+}
+
+size_t BlockQueue::unplug() {
+    size_t index = InterruptController::currentCpu() % softwareQueues_.size();
+    std::vector<Bio> batch;
+    {
+        std::lock_guard<std::mutex> lock(softwareQueues_[index]->mutex);
+        batch.swap(softwareQueues_[index]->staged);
+    }
+    size_t dispatched = flushPlug(batch);
+    return dispatched + dispatchRound(queueDepth_);
+}
+
+size_t BlockQueue::run() {
+    size_t dispatched = 0;
+    for (size_t index = 0; index < softwareQueues_.size(); ++index) {
+        std::vector<Bio> batch;
+        {
+            std::lock_guard<std::mutex> lock(softwareQueues_[index]->mutex);
+            batch.swap(softwareQueues_[index]->staged);
+        }
+        dispatched += flushPlug(batch);
+    }
+    while (size_t round = dispatchRound(queueDepth_)) {
+        dispatched += round;
+    }
+    return dispatched;
+}
+
+BlockStatus BlockQueue::submitAndWait(Bio bio) {
+    auto done = std::make_shared<std::atomic<bool>>(false);
+    auto status = std::make_shared<BlockStatus>(BlockStatus::Invalid);
+    BioCompletion inner = std::move(bio.onComplete);
+    bio.onComplete = [done, status, inner](BlockStatus result) {
+        if (inner) {
+            inner(result);
+        }
+        *status = result;
+        done->store(true, std::memory_order_release);
+    };
+
+    if (!submit(std::move(bio))) {
+        return BlockStatus::Invalid;
+    }
+    unplug();
+    // Keep the device busy until the bio comes out of the elevator; another
+    // thread's run() may also have picked it up first.
+    while (!done->load(std::memory_order_acquire)) {
+        if (dispatchRound(queueDepth_) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    return *status;
+}
+
+bool BlockQueue::setElevator(std::unique_ptr<Elevator> elevator) {
+    if (!elevator) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(elevatorMutex_);
+    auto now = std::chrono::steady_clock::now();
+    while (auto request = elevator_->dispatch(now)) {
+        elevator->insert(std::move(*request), now);
+    }
+    LOG_INFO("BlockQueue", device_.getName() + ": elevator " + elevator_->getName() +
+             " -> " + elevator->getName());
+    elevator_ = std::move(elevator);
+    return true;
+}
+
+bool BlockQueue::setElevator(const std::string& name) {
+    auto elevator = makeElevator(name);
+    if (!elevator) {
+        LOG_ERROR("BlockQueue", "Unknown elevator: " + name);
+        return false;
+    }
+    return setElevator(std::move(elevator));
+}
+
+std::string BlockQueue::getElevatorName() const {
+    std::lock_guard<std::mutex> lock(elevatorMutex_);
+    return elevator_->getName();
+}
+
+size_t BlockQueue::getPendingRequests() const {
+    std::lock_guard<std::mutex> lock(elevatorMutex_);
+    return elevator_->size();
+}
+
+// Merges each run between flushes and queues it on the elevator. A flush
+// must follow everything before it, so the elevator is drained ahead of it
+// and it goes straight to the device. Returns requests dispatched here.
+size_t BlockQueue::flushPlug(std::vector<Bio>& bios) {
+    size_t dispatched = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i <= bios.size(); ++i) {
+        if (i < bios.size() && bios[i].op != BlockOp::Flush) {
+            continue;
+        }
+
+        std::vector<BlockRequest> requests;
+        mergeRun(bios, begin, i, requests);
+        if (!requests.empty()) {
+            auto now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(elevatorMutex_);
+            for (BlockRequest& request : requests) {
+                elevator_->insert(std::move(request), now);
+            }
+        }
+
+        if (i < bios.size()) {
+            while (size_t round = dispatchRound(queueDepth_)) {
+                dispatched += round;
+            }
+            std::vector<BlockRequest> flush;
+            mergeRun(bios, i, i + 1, flush);
+            execute(flush);
+            dispatched++;
+        }
+        begin = i + 1;
+    }
+    return dispatched;
+}
+
+void BlockQueue::mergeRun(std::vector<Bio>& bios, size_t begin, size_t end,
+                          std::vector<BlockRequest>& requests) {
+    if (begin >= end) {
+        return;
+    }
+
+    std::stable_sort(bios.begin() + begin, bios.begin() + end, [](const Bio& a, const Bio& b) {
+        return a.sector < b.sector;
+    });
+
+    for (size_t i = begin; i < end; ++i) {
+        Bio& bio = bios[i];
+        uint32_t sectors = bio.sectorCount();
+        if (!requests.empty()) {
+            BlockRequest& last = requests.back();
+            if (isTransfer(bio.op) && last.op == bio.op && last.task == bio.task &&
+                last.sector + last.sectors == bio.sector && last.sectors + sectors <= maxRequestSectors_) {
+                last.sectors += sectors;
+                last.bios.push_back(std::move(bio));
+                merges_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+        }
+        requests.push_back(BlockRequest{bio.op, bio.sector, sectors, bio.task, {}});
+        requests.back().bios.push_back(std::move(bio));
+    }
+}
+
+size_t BlockQueue::dispatchRound(size_t maxRequests) {
+    std::vector<BlockRequest> requests;
+    {
+        std::lock_guard<std::mutex> lock(elevatorMutex_);
+        auto now = std::chrono::steady_clock::now();
+        while (requests.size() < maxRequests) {
+            auto request = elevator_->dispatch(now);
+            if (!request) {
+                break;
+            }
+            requests.push_back(std::move(*request));
+        }
+    }
+    execute(requests);
+    return requests.size();
+}
+
+void BlockQueue::execute(std::vector<BlockRequest>& requests) {
+    if (requests.empty()) {
+        return;
+    }
+
+    size_t hardwareQueue = InterruptController::currentCpu() % softwareQueues_.size() % hardwareQueues_.size();
+    std::vector<BlockStatus> statuses(requests.size());
+    HardwareQueue& queue = *hardwareQueues_[hardwareQueue];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (size_t i = 0; i < requests.size(); ++i) {
+            statuses[i] = device_.execute(hardwareQueue, requests[i]);
+        }
+    }
+    queue.requests.fetch_add(requests.size(), std::memory_order_relaxed);
+
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        sectors_.fetch_add(requests[i].sectors, std::memory_order_relaxed);
+        if (statuses[i] != BlockStatus::Ok) {
+            errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (Bio& bio : requests[i].bios) {
+            if (bio.onComplete) {
+                bio.onComplete(statuses[i]);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(taskStatsMutex_);
+    for (const BlockRequest& request : requests) {
+        TaskIoStats& stats = taskStats_[request.task];
+        for (const Bio& bio : request.bios) {
+            auto latency = static_cast<uint64_t>(std::max<int64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - bio.submittedAt).count(), 1));
+            stats.ios++;
+            stats.sectors += bio.sectorCount();
+            stats.totalLatencyNs += latency;
+            stats.maxLatencyNs = std::max(stats.maxLatencyNs, latency);
+            size_t bucket = std::min<size_t>(63 - __builtin_clzll(latency), IO_LATENCY_BUCKETS - 1);
+            stats.latency[bucket]++;
+        }
+    }
+}
+
+uint64_t TaskIoStats::latencyPercentile(double quantile) const {
+    if (ios == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * ios + 0.5));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < IO_LATENCY_BUCKETS; ++b) {
+        seen += latency[b];
+        if (seen >= target) {
+            return uint64_t(1) << (b + 1);
+        }
+    }
+    return uint64_t(1) << IO_LATENCY_BUCKETS;
+}
+
+BlockQueueStats BlockQueue::getStats() const {
+    BlockQueueStats stats{};
+    stats.bios = bios_.load(std::memory_order_relaxed);
+    for (const auto& queue : hardwareQueues_) {
+        stats.requests += queue->requests.load(std::memory_order_relaxed);
+    }
+    stats.merges = merges_.load(std::memory_order_relaxed);
+    stats.sectors = sectors_.load(std::memory_order_relaxed);
+    stats.errors = errors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::optional<TaskIoStats> BlockQueue::getTaskStats(TaskId task) const {
+    std::lock_guard<std::mutex> lock(taskStatsMutex_);
+    auto it = taskStats_.find(task);
+    if (it == taskStats_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::string BlockQueue::getQueueReport() const {
+    BlockQueueStats stats = getStats();
+    std::stringstream ss;
+    ss << "=== Block Queue Report (" << device_.getName() << ") ===\n";
+    ss << "Elevator: " << getElevatorName() << " (" << getPendingRequests() << " pending)\n";
+    ss << "Software Queues: " << softwareQueues_.size()
+       << ", Hardware Queues: " << hardwareQueues_.size() << "\n";
+    ss << "Bios Submitted: " << stats.bios << "\n";
+    ss << "Requests Dispatched: " << stats.requests << " (" << stats.merges << " merges)\n";
+    ss << "Sectors Transferred: " << stats.sectors << "\n";
+    ss << "Errors: " << stats.errors << "\n";
+    for (size_t i = 0; i < hardwareQueues_.size(); ++i) {
+        ss << "  hctx " << i << ": " << hardwareQueues_[i]->requests.load(std::memory_order_relaxed)
+           << " requests\n";
+    }
+
+    std::lock_guard<std::mutex> lock(taskStatsMutex_);
+    for (const auto& [task, io] : taskStats_) {
+        ss << "  task " << task << ": " << io.ios << " ios, " << io.sectors << " sectors, mean "
+           << std::fixed << std::setprecision(1) << io.meanLatencyMicros() << " us, p99 <= "
+           << io.latencyPercentile(0.99) / 1000.0 << " us, max "
+           << io.maxLatencyNs / 1000.0 << " us\n";
+    }
+    return ss.str();
+}
+
+}
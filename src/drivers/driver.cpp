@@ -1,119 +1,589 @@
 #include "drivers/driver.hpp"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <thread>
 
 namespace MiniOS {
 
-InterruptController::InterruptController()
-    : interruptsEnabled_(false)
-    , totalInterrupts_(0)
+static thread_local CpuId t_currentCpu = 0;
+
+InterruptController::InterruptController(size_t cpuCount)
+    : onlineMask_(0)
+    , registeredCount_(0)
 {
-    LOG_INFO("InterruptController", "Initialized interrupt controller");
+    cpuCount = std::clamp<size_t>(cpuCount, 1, MAX_CPUS);
+    for (size_t i = 0; i < cpuCount; ++i) {
+        cpus_.push_back(std::make_unique<CpuState>());
+        onlineMask_ |= CpuMask(1) << i;
+    }
+    openSoftirq(SoftirqId::Tasklet, [this]() { runTasklets(); }, "Tasklet");
+    setIpiHandler(IpiType::CallFunction, [this](CpuId cpu) { runCalls(*cpus_[cpu]); });
+    LOG_INFO("InterruptController", "Initialized interrupt controller with " +
+             std::to_string(cpuCount) + " CPU(s)");
+}
+
+InterruptController::~InterruptController() {
+    for (auto& slot : coalescers_) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+void InterruptController::setCurrentCpu(CpuId cpu) {
+    t_currentCpu = cpu;
+}
+
+CpuId InterruptController::currentCpu() {
+    return t_currentCpu;
+}
+
+CpuId InterruptController::localCpuId() const {
+    return t_currentCpu < cpus_.size() ? t_currentCpu : 0;
+}
+
+InterruptController::CpuState& InterruptController::localCpu() const {
+    return *cpus_[localCpuId()];
+}
+
+void InterruptController::invokeHandler(InterruptNumber interrupt, void* context, void* data) {
+    (*static_cast<InterruptHandler*>(context))(interrupt, data);
 }
 
 bool InterruptController::registerHandler(InterruptNumber interrupt, 
                                            InterruptHandler handler, 
                                            const std::string& name) {
-    if (handlers_.find(interrupt) != handlers_.end()) {
+    if (!handler) {
+        return false;
+    }
+    return installHandler(interrupt, &InterruptController::invokeHandler, nullptr, std::move(handler), name);
+}
+
+bool InterruptController::registerHandler(InterruptNumber interrupt, InterruptEntry entry,
+                                           void* context, const std::string& name) {
+    return installHandler(interrupt, entry, context, nullptr, name);
+}
+
+// Everything dispatch() reads is written before the release store to
+// enabled, so a CPU that sees the vector enabled also sees its context.
+bool InterruptController::installHandler(InterruptNumber interrupt, InterruptEntry entry, void* context,
+                                          InterruptHandler handler, const std::string& name) {
+    if (interrupt >= INTERRUPT_VECTORS || !entry) {
+        LOG_WARN("InterruptController", "Invalid interrupt vector " + std::to_string(interrupt));
+        return false;
+    }
+    
+    InterruptDescriptor& desc = vectors_[interrupt];
+    if (desc.entry) {
         LOG_WARN("InterruptController", "Handler already registered for interrupt " + 
                  std::to_string(interrupt));
         return false;
     }
     
-    handlers_.emplace(interrupt, InterruptDescriptor(interrupt, std::move(handler), name));
+    desc.handler = std::move(handler);
+    desc.entry = entry;
+    desc.context = desc.handler ? &desc.handler : context;
+    desc.name = name;
+    desc.affinity.store(ALL_CPUS, std::memory_order_relaxed);
+    for (auto& cpu : cpus_) {
+        cpu->counts[interrupt].store(0, std::memory_order_relaxed);
+    }
+    desc.enabled.store(true, std::memory_order_release);
+    registeredCount_++;
     LOG_INFO("InterruptController", "Registered handler '" + name + "' for interrupt " + 
              std::to_string(interrupt));
     return true;
 }
 
+bool InterruptController::registerCoalescedHandler(InterruptNumber interrupt, CoalescedHandler handler,
+                                                   const CoalescingPolicy& policy,
+                                                   const std::string& name) {
+    if (!handler) {
+        return false;
+    }
+    if (policy.adaptive && policy.maxDelay.count() <= 0) {
+        LOG_WARN("InterruptController", "Adaptive coalescing needs a maximum delay");
+        return false;
+    }
+    
+    auto coalescer = std::make_unique<Coalescer>(interrupt, cpus_.size());
+    coalescer->handler = std::move(handler);
+    coalescer->reset(policy);
+    if (!registerHandler(interrupt, &InterruptController::coalesceEvent, coalescer.get(), name)) {
+        return false;
+    }
+    coalescers_[interrupt].store(coalescer.release(), std::memory_order_release);
+    coalescedVectors_[interrupt / 64].fetch_or(uint64_t(1) << (interrupt % 64), std::memory_order_release);
+    return true;
+}
+
 bool InterruptController::unregisterHandler(InterruptNumber interrupt) {
-    auto it = handlers_.find(interrupt);
-    if (it == handlers_.end()) {
+    if (interrupt >= INTERRUPT_VECTORS || !vectors_[interrupt].entry) {
         return false;
     }
     
+    // Both stores come before the inFlight read, and pinVector() increments
+    // before reading either, so every call either sees the vector gone or
+    // is waited for here.
+    InterruptDescriptor& desc = vectors_[interrupt];
+    desc.enabled.store(false, std::memory_order_seq_cst);
+    coalescedVectors_[interrupt / 64].fetch_and(~(uint64_t(1) << (interrupt % 64)), std::memory_order_relaxed);
+    Coalescer* coalescer = coalescers_[interrupt].exchange(nullptr, std::memory_order_seq_cst);
+    while (desc.inFlight.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    delete coalescer;
     LOG_INFO("InterruptController", "Unregistered handler for interrupt " + 
              std::to_string(interrupt));
-    handlers_.erase(it);
+    desc.entry = nullptr;
+    desc.context = nullptr;
+    desc.handler = nullptr;
+    desc.name.clear();
+    registeredCount_--;
     return true;
 }
 
-void InterruptController::triggerInterrupt(InterruptNumber interrupt, void* data) {
-    if (!interruptsEnabled_) {
-        LOG_DEBUG("InterruptController", "Interrupts disabled, ignoring interrupt " + 
-                  std::to_string(interrupt));
+void InterruptController::dispatch(CpuState& cpu, InterruptNumber interrupt, void* data) {
+    InterruptDescriptor& desc = vectors_[interrupt];
+    pinVector(interrupt);
+    if (!desc.enabled.load(std::memory_order_seq_cst)) {
+        unpinVector(interrupt);
+        if (!desc.entry) {
+            LOG_WARN("InterruptController", "No handler for interrupt " + std::to_string(interrupt));
+        }
+        bump(cpu.ignored);
         return;
     }
     
-    auto it = handlers_.find(interrupt);
-    if (it == handlers_.end()) {
-        LOG_WARN("InterruptController", "No handler for interrupt " + std::to_string(interrupt));
+    bump(cpu.handled);
+    bump(cpu.counts[interrupt]);
+    desc.entry(interrupt, desc.context, data);
+    unpinVector(interrupt);
+}
+
+void InterruptController::triggerInterrupt(InterruptNumber interrupt, void* data) {
+    CpuState& cpu = localCpu();
+    if (!cpu.interruptsEnabled.load(std::memory_order_relaxed) || interrupt >= INTERRUPT_VECTORS) {
+        bump(cpu.ignored);
         return;
     }
-    
-    if (!it->second.enabled) {
-        return;
+    dispatch(cpu, interrupt, data);
+}
+
+std::optional<CpuId> InterruptController::raiseInterrupt(InterruptNumber interrupt) {
+    if (interrupt >= INTERRUPT_VECTORS) {
+        return std::nullopt;
+    }
+    CpuMask mask = vectors_[interrupt].affinity.load(std::memory_order_relaxed) & onlineMask_;
+    if (mask == 0) {
+        return std::nullopt;
     }
     
-    totalInterrupts_++;
-    it->second.triggerCount++;
+    CpuId self = localCpuId();
+    CpuId target = (mask & (CpuMask(1) << self))
+                   ? self : static_cast<CpuId>(__builtin_ctzll(mask));
+    cpus_[target]->pendingIrqs[interrupt / 64].fetch_or(uint64_t(1) << (interrupt % 64),
+                                                        std::memory_order_release);
+    return target;
+}
+
+size_t InterruptController::handlePendingInterrupts() {
+    CpuId self = localCpuId();
+    CpuState& cpu = *cpus_[self];
+    if (!cpu.interruptsEnabled.load(std::memory_order_relaxed)) {
+        return 0;
+    }
     
-    LOG_DEBUG("InterruptController", "Triggering interrupt " + std::to_string(interrupt) + 
-              " (" + it->second.name + ")");
+    size_t handled = 0;
+    uint32_t ipis = cpu.pendingIpis.exchange(0, std::memory_order_acquire);
+    while (ipis) {
+        uint32_t type = __builtin_ctz(ipis);
+        ipis &= ipis - 1;
+        bump(cpu.ipis);
+        if (ipiHandlers_[type]) {
+            ipiHandlers_[type](self);
+        }
+        handled++;
+    }
     
-    it->second.handler(interrupt, data);
+    for (size_t word = 0; word < cpu.pendingIrqs.size(); ++word) {
+        if (cpu.pendingIrqs[word].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        uint64_t pending = cpu.pendingIrqs[word].exchange(0, std::memory_order_acquire);
+        while (pending) {
+            InterruptNumber interrupt = static_cast<InterruptNumber>(word * 64 + __builtin_ctzll(pending));
+            pending &= pending - 1;
+            dispatch(cpu, interrupt, nullptr);
+            handled++;
+        }
+    }
+    return handled;
 }
 
 void InterruptController::enableInterrupt(InterruptNumber interrupt) {
-    auto it = handlers_.find(interrupt);
-    if (it != handlers_.end()) {
-        it->second.enabled = true;
+    if (interrupt < INTERRUPT_VECTORS && vectors_[interrupt].entry) {
+        vectors_[interrupt].enabled.store(true, std::memory_order_release);
     }
 }
 
 void InterruptController::disableInterrupt(InterruptNumber interrupt) {
-    auto it = handlers_.find(interrupt);
-    if (it != handlers_.end()) {
-        it->second.enabled = false;
+    if (interrupt < INTERRUPT_VECTORS) {
+        vectors_[interrupt].enabled.store(false, std::memory_order_release);
     }
 }
 
 bool InterruptController::isEnabled(InterruptNumber interrupt) const {
-    auto it = handlers_.find(interrupt);
-    if (it == handlers_.end()) {
+    return interrupt < INTERRUPT_VECTORS && vectors_[interrupt].enabled.load(std::memory_order_acquire);
+}
+
+bool InterruptController::setAffinity(InterruptNumber interrupt, CpuMask mask) {
+    if (interrupt >= INTERRUPT_VECTORS || (mask & onlineMask_) == 0) {
         return false;
     }
-    return it->second.enabled;
+    vectors_[interrupt].affinity.store(mask, std::memory_order_relaxed);
+    return true;
+}
+
+CpuMask InterruptController::getAffinity(InterruptNumber interrupt) const {
+    if (interrupt >= INTERRUPT_VECTORS) {
+        return 0;
+    }
+    return vectors_[interrupt].affinity.load(std::memory_order_relaxed) & onlineMask_;
 }
 
 void InterruptController::enableInterrupts() {
-    interruptsEnabled_ = true;
-    LOG_INFO("InterruptController", "Interrupts enabled");
+    localCpu().interruptsEnabled.store(true, std::memory_order_relaxed);
+    LOG_INFO("InterruptController", "Interrupts enabled on CPU " + std::to_string(localCpuId()));
 }
 
 void InterruptController::disableInterrupts() {
-    interruptsEnabled_ = false;
-    LOG_INFO("InterruptController", "Interrupts disabled");
+    localCpu().interruptsEnabled.store(false, std::memory_order_relaxed);
+    LOG_INFO("InterruptController", "Interrupts disabled on CPU " + std::to_string(localCpuId()));
+}
+
+bool InterruptController::areInterruptsEnabled() const {
+    return localCpu().interruptsEnabled.load(std::memory_order_relaxed);
+}
+
+void InterruptController::setIpiHandler(IpiType type, IpiHandler handler) {
+    ipiHandlers_[static_cast<uint32_t>(type)] = std::move(handler);
+}
+
+bool InterruptController::sendIpi(CpuId cpu, IpiType type) {
+    if (cpu >= cpus_.size()) {
+        return false;
+    }
+    cpus_[cpu]->pendingIpis.fetch_or(1u << static_cast<uint32_t>(type), std::memory_order_release);
+    return true;
+}
+
+bool InterruptController::callOnCpu(CpuId cpu, std::function<void()> function) {
+    if (cpu >= cpus_.size() || !function) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cpus_[cpu]->callMutex);
+        cpus_[cpu]->calls.push_back(std::move(function));
+    }
+    return sendIpi(cpu, IpiType::CallFunction);
+}
+
+void InterruptController::runCalls(CpuState& cpu) {
+    std::vector<std::function<void()>> calls;
+    {
+        std::lock_guard<std::mutex> lock(cpu.callMutex);
+        calls.swap(cpu.calls);
+    }
+    for (auto& call : calls) {
+        call();
+    }
+}
+
+void InterruptController::Coalescer::reset(const CoalescingPolicy& newPolicy) {
+    policy = newPolicy;
+    auto now = std::chrono::steady_clock::now();
+    for (CoalescingState& state : cpus) {
+        state.threshold.store(policy.adaptive ? 1 : std::max<uint32_t>(policy.maxEvents, 1),
+                              std::memory_order_relaxed);
+        state.eventRate = 0;
+        state.lastDeliveryAt = now;
+    }
+}
+
+// Top half of a coalesced vector. Only the first event of a batch reads the
+// clock, and only when there is a delay to measure from.
+void InterruptController::coalesceEvent(InterruptNumber, void* context, void*) {
+    Coalescer& coalescer = *static_cast<Coalescer*>(context);
+    CoalescingState& state = coalescer.cpus[t_currentCpu < coalescer.cpus.size() ? t_currentCpu : 0];
+    bump(state.events);
+    
+    if (++state.pending >= state.threshold.load(std::memory_order_relaxed)) {
+        deliverBatch(coalescer, state, coalescer.policy.adaptive ? std::chrono::steady_clock::now()
+                                                                 : std::chrono::steady_clock::time_point());
+    } else if (state.pending == 1 && coalescer.policy.maxDelay.count() > 0) {
+        state.firstEventAt = std::chrono::steady_clock::now();
+    }
+}
+
+void InterruptController::deliverBatch(Coalescer& coalescer, CoalescingState& state,
+                                       std::chrono::steady_clock::time_point now) {
+    uint32_t events = state.pending;
+    state.pending = 0;
+    bump(state.deliveries);
+    
+    if (coalescer.policy.adaptive) {
+        // Rise slowly so one burst does not hold back the events after it,
+        // fall quickly so a quiet device is back to one event per call soon.
+        double seconds = std::chrono::duration<double>(now - state.lastDeliveryAt).count();
+        double sample = events / std::max(seconds, 1e-7);
+        double weight = sample < state.eventRate ? 0.5 : 0.125;
+        state.eventRate += (sample - state.eventRate) * weight;
+        state.lastDeliveryAt = now;
+        
+        double threshold = state.eventRate / std::max<uint32_t>(coalescer.policy.targetRate, 1);
+        state.threshold.store(static_cast<uint32_t>(
+            std::clamp(threshold, 1.0, double(std::max<uint32_t>(coalescer.policy.maxEvents, 1)))),
+            std::memory_order_relaxed);
+    }
+    
+    coalescer.handler(coalescer.interrupt, events);
+}
+
+// The caller pins the vector first.
+InterruptController::Coalescer* InterruptController::findCoalescer(InterruptNumber interrupt) const {
+    return coalescers_[interrupt].load(std::memory_order_seq_cst);
+}
+
+bool InterruptController::setCoalescingPolicy(InterruptNumber interrupt, const CoalescingPolicy& policy) {
+    if (interrupt >= INTERRUPT_VECTORS || (policy.adaptive && policy.maxDelay.count() <= 0)) {
+        return false;
+    }
+    pinVector(interrupt);
+    Coalescer* coalescer = findCoalescer(interrupt);
+    if (coalescer) {
+        coalescer->reset(policy);
+    }
+    unpinVector(interrupt);
+    return coalescer != nullptr;
+}
+
+std::optional<CoalescingStats> InterruptController::getCoalescingStats(InterruptNumber interrupt) const {
+    if (interrupt >= INTERRUPT_VECTORS) {
+        return std::nullopt;
+    }
+    pinVector(interrupt);
+    Coalescer* coalescer = findCoalescer(interrupt);
+    std::optional<CoalescingStats> stats;
+    if (coalescer) {
+        stats = CoalescingStats{0, 0, 0};
+        for (const CoalescingState& state : coalescer->cpus) {
+            stats->events += state.events.load(std::memory_order_relaxed);
+            stats->deliveries += state.deliveries.load(std::memory_order_relaxed);
+            stats->threshold = std::max(stats->threshold, state.threshold.load(std::memory_order_relaxed));
+        }
+    }
+    unpinVector(interrupt);
+    return stats;
+}
+
+size_t InterruptController::pollCoalescing(std::chrono::steady_clock::time_point now) {
+    CpuId self = localCpuId();
+    size_t delivered = 0;
+    for (size_t word = 0; word < coalescedVectors_.size(); ++word) {
+        uint64_t vectors = coalescedVectors_[word].load(std::memory_order_acquire);
+        while (vectors) {
+            InterruptNumber interrupt = static_cast<InterruptNumber>(word * 64 + __builtin_ctzll(vectors));
+            vectors &= vectors - 1;
+            pinVector(interrupt);
+            if (Coalescer* coalescer = findCoalescer(interrupt)) {
+                CoalescingState& state = coalescer->cpus[self];
+                if (state.pending > 0 && coalescer->policy.maxDelay.count() > 0 &&
+                    now - state.firstEventAt >= coalescer->policy.maxDelay) {
+                    deliverBatch(*coalescer, state, now);
+                    delivered++;
+                }
+            }
+            unpinVector(interrupt);
+        }
+    }
+    return delivered;
+}
+
+bool InterruptController::openSoftirq(SoftirqId id, SoftirqHandler handler, const std::string& name) {
+    Softirq& softirq = softirqs_[static_cast<uint32_t>(id)];
+    if (!handler || softirq.handler) {
+        LOG_WARN("InterruptController", "Softirq " + std::to_string(static_cast<uint32_t>(id)) +
+                 " already open");
+        return false;
+    }
+    softirq.handler = std::move(handler);
+    softirq.name = name;
+    return true;
+}
+
+bool InterruptController::closeSoftirq(SoftirqId id) {
+    Softirq& softirq = softirqs_[static_cast<uint32_t>(id)];
+    if (!softirq.handler) {
+        return false;
+    }
+    softirq.handler = nullptr;
+    softirq.name.clear();
+    return true;
+}
+
+// Pushed onto the calling CPU's lock-free list; runTasklets() takes the
+// whole list at once.
+void InterruptController::scheduleTasklet(Tasklet& tasklet) {
+    if (tasklet.scheduled.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    CpuState& cpu = localCpu();
+    Tasklet* head = cpu.tasklets.load(std::memory_order_relaxed);
+    do {
+        tasklet.next = head;
+    } while (!cpu.tasklets.compare_exchange_weak(head, &tasklet, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+    cpu.pendingSoftirqs.fetch_or(1u << static_cast<uint32_t>(SoftirqId::Tasklet),
+                                 std::memory_order_release);
+}
+
+void InterruptController::runTasklets() {
+    Tasklet* list = localCpu().tasklets.exchange(nullptr, std::memory_order_acquire);
+    
+    Tasklet* ordered = nullptr;
+    while (list) {
+        Tasklet* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    
+    while (ordered) {
+        Tasklet* tasklet = ordered;
+        ordered = ordered->next;
+        // Cleared first so the function itself, or an interrupt during it,
+        // can schedule the tasklet again.
+        tasklet->scheduled.store(false, std::memory_order_release);
+        tasklet->runCount++;
+        tasklet->function();
+    }
+}
+
+size_t InterruptController::runSoftirqs() {
+    CpuState& cpu = localCpu();
+    size_t ran = 0;
+    for (size_t pass = 0; pass < SOFTIRQ_MAX_RESTART; ++pass) {
+        uint32_t pending = cpu.pendingSoftirqs.exchange(0, std::memory_order_acquire);
+        if (pending == 0) {
+            return ran;
+        }
+        if (pass == 0) {
+            bump(cpu.softirqBatches);
+        }
+        
+        while (pending) {
+            uint32_t id = __builtin_ctz(pending);
+            pending &= pending - 1;
+            if (softirqs_[id].handler) {
+                bump(cpu.softirqRuns[id]);
+                softirqs_[id].handler();
+                ran++;
+            }
+        }
+    }
+    
+    if (cpu.pendingSoftirqs.load(std::memory_order_acquire) != 0) {
+        bump(cpu.softirqDeferrals);
+    }
+    return ran;
+}
+
+uint64_t InterruptController::getInterruptCount(InterruptNumber interrupt) const {
+    uint64_t total = 0;
+    for (CpuId cpu = 0; cpu < cpus_.size(); ++cpu) {
+        total += getInterruptCount(interrupt, cpu);
+    }
+    return total;
+}
+
+uint64_t InterruptController::getInterruptCount(InterruptNumber interrupt, CpuId cpu) const {
+    if (interrupt >= INTERRUPT_VECTORS || cpu >= cpus_.size()) {
+        return 0;
+    }
+    return cpus_[cpu]->counts[interrupt].load(std::memory_order_relaxed);
 }
 
 std::string InterruptController::getInterruptReport() const {
+    auto sum = [this](auto field) {
+        uint64_t total = 0;
+        for (const auto& cpu : cpus_) {
+            total += field(*cpu).load(std::memory_order_relaxed);
+        }
+        return total;
+    };
+    
+    size_t enabledCpus = 0;
+    for (const auto& cpu : cpus_) {
+        enabledCpus += cpu->interruptsEnabled.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+    
     std::stringstream ss;
     ss << "=== Interrupt Controller Report ===\n";
-    ss << "Interrupts Enabled: " << (interruptsEnabled_ ? "Yes" : "No") << "\n";
-    ss << "Total Interrupts Handled: " << totalInterrupts_ << "\n";
-    ss << "Registered Handlers: " << handlers_.size() << "\n\n";
+    ss << "CPUs: " << cpus_.size() << " (interrupts enabled on " << enabledCpus << ")\n";
+    ss << "Total Interrupts Handled: " << sum([](const CpuState& c) -> auto& { return c.handled; }) << "\n";
+    ss << "Ignored Interrupts: " << sum([](const CpuState& c) -> auto& { return c.ignored; }) << "\n";
+    ss << "IPIs: " << sum([](const CpuState& c) -> auto& { return c.ipis; }) << "\n";
+    ss << "Registered Handlers: " << registeredCount_ << "\n\n";
     
     ss << std::setw(8) << "IRQ" << " | "
        << std::setw(20) << "Name" << " | "
        << std::setw(8) << "Enabled" << " | "
+       << std::setw(18) << "Affinity" << " | "
        << "Count" << "\n";
-    ss << std::string(55, '-') << "\n";
+    ss << std::string(76, '-') << "\n";
     
-    for (const auto& [num, desc] : handlers_) {
+    for (size_t num = 0; num < INTERRUPT_VECTORS; ++num) {
+        const InterruptDescriptor& desc = vectors_[num];
+        if (!desc.entry) {
+            continue;
+        }
+        std::stringstream affinity;
+        affinity << "0x" << std::hex << getAffinity(static_cast<InterruptNumber>(num));
         ss << std::setw(8) << num << " | "
            << std::setw(20) << desc.name << " | "
-           << std::setw(8) << (desc.enabled ? "Yes" : "No") << " | "
-           << desc.triggerCount << "\n";
+           << std::setw(8) << (desc.enabled.load(std::memory_order_relaxed) ? "Yes" : "No") << " | "
+           << std::setw(18) << affinity.str() << " | "
+           << getInterruptCount(static_cast<InterruptNumber>(num)) << "\n";
+    }
+    
+    for (size_t num = 0; num < INTERRUPT_VECTORS; ++num) {
+        if (auto stats = getCoalescingStats(static_cast<InterruptNumber>(num))) {
+            ss << "IRQ " << num << " coalescing: " << stats->events << " events in "
+               << stats->deliveries << " calls, threshold " << stats->threshold << "\n";
+        }
+    }
+    
+    if (cpus_.size() > 1) {
+        ss << "\n";
+        for (size_t i = 0; i < cpus_.size(); ++i) {
+            const CpuState& cpu = *cpus_[i];
+            ss << "CPU " << i << ": " << cpu.handled.load(std::memory_order_relaxed) << " handled, "
+               << cpu.ignored.load(std::memory_order_relaxed) << " ignored, "
+               << cpu.ipis.load(std::memory_order_relaxed) << " IPIs\n";
+        }
+    }
+    
+    ss << "\nSoftirq Batches: " << sum([](const CpuState& c) -> auto& { return c.softirqBatches; })
+       << " (" << sum([](const CpuState& c) -> auto& { return c.softirqDeferrals; }) << " deferred)\n";
+    for (size_t id = 0; id < SOFTIRQ_VECTORS; ++id) {
+        if (softirqs_[id].handler) {
+            uint64_t runs = 0;
+            for (const auto& cpu : cpus_) {
+                runs += cpu->softirqRuns[id].load(std::memory_order_relaxed);
+            }
+            ss << "  " << std::setw(12) << std::left << softirqs_[id].name << std::right
+               << " " << runs << "\n";
+        }
     }
     
     return ss.str();
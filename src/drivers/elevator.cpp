@@ -0,0 +1,177 @@
+#include "drivers/elevator.hpp"
+
+namespace MiniOS {
+
+namespace {
+
+constexpr size_t READ = 0;
+constexpr size_t WRITE = 1;
+
+size_t directionOf(BlockOp op) {
+    return op == BlockOp::Write ? WRITE : READ;
+}
+
+}
+
+void NoopElevator::insert(BlockRequest request, Clock::time_point) {
+    fifo_.push_back(std::move(request));
+}
+
+std::optional<BlockRequest> NoopElevator::dispatch(Clock::time_point) {
+    if (fifo_.empty()) {
+        return std::nullopt;
+    }
+    BlockRequest request = std::move(fifo_.front());
+    fifo_.pop_front();
+    return request;
+}
+
+DeadlineElevator::DeadlineElevator(std::chrono::nanoseconds readExpire,
+                                   std::chrono::nanoseconds writeExpire,
+                                   size_t fifoBatch, size_t writesStarved)
+    : expire_{readExpire, writeExpire}
+    , fifoBatch_(std::max<size_t>(fifoBatch, 1))
+    , writesStarved_(writesStarved)
+    , batchCount_(0)
+    , starved_(0)
+    , nextSector_(0)
+{
+}
+
+void DeadlineElevator::insert(BlockRequest request, Clock::time_point now) {
+    size_t index = directionOf(request.op);
+    Direction& direction = directions_[index];
+    SectorNumber sector = request.sector;
+    auto entry = direction.fifo.insert(direction.fifo.end(),
+                                       Entry{std::move(request), now + expire_[index], {}});
+    entry->position = direction.sorted.emplace(sector, entry);
+}
+
+std::optional<BlockRequest> DeadlineElevator::dispatch(Clock::time_point now) {
+    // Keep sweeping the current direction while the batch lasts.
+    if (batchDirection_ && batchCount_ < fifoBatch_) {
+        SortedTree& sorted = directions_[*batchDirection_].sorted;
+        auto next = sorted.lower_bound(nextSector_);
+        if (next != sorted.end()) {
+            return take(*batchDirection_, next);
+        }
+    }
+
+    bool reads = !directions_[READ].fifo.empty();
+    bool writes = !directions_[WRITE].fifo.empty();
+    if (!reads && !writes) {
+        batchDirection_.reset();
+        return std::nullopt;
+    }
+
+    size_t direction;
+    if (reads && (!writes || starved_ < writesStarved_)) {
+        direction = READ;
+        if (writes) {
+            starved_++;
+        }
+    } else {
+        direction = WRITE;
+        starved_ = 0;
+    }
+    batchDirection_ = direction;
+    batchCount_ = 0;
+
+    Direction& chosen = directions_[direction];
+    if (chosen.fifo.front().deadline <= now) {
+        return take(direction, chosen.fifo.front().position);
+    }
+    auto next = chosen.sorted.lower_bound(nextSector_);
+    return take(direction, next != chosen.sorted.end() ? next : chosen.sorted.begin());
+}
+
+size_t DeadlineElevator::size() const {
+    return directions_[READ].fifo.size() + directions_[WRITE].fifo.size();
+}
+
+BlockRequest DeadlineElevator::take(size_t direction, SortedTree::iterator position) {
+    Direction& chosen = directions_[direction];
+    Fifo::iterator entry = position->second;
+    BlockRequest request = std::move(entry->request);
+    chosen.sorted.erase(position);
+    chosen.fifo.erase(entry);
+
+    nextSector_ = request.sector + request.sectors;
+    batchCount_++;
+    return request;
+}
+
+BudgetFairElevator::BudgetFairElevator(uint32_t budgetSectors)
+    : budget_(std::max<uint32_t>(budgetSectors, 1))
+    , active_(nullptr)
+    , remaining_(0)
+    , nextSector_(0)
+    , virtualTime_(0)
+    , size_(0)
+{
+}
+
+void BudgetFairElevator::insert(BlockRequest request, Clock::time_point) {
+    TaskQueue& queue = tasks_[request.task];
+    // A task coming back from idle starts at the current virtual time
+    // rather than cashing in service it did not ask for.
+    if (queue.requests.empty() && &queue != active_) {
+        queue.finish = std::max(queue.finish, virtualTime_);
+    }
+    SectorNumber sector = request.sector;
+    queue.requests.emplace(sector, std::move(request));
+    size_++;
+}
+
+std::optional<BlockRequest> BudgetFairElevator::dispatch(Clock::time_point) {
+    if (size_ == 0) {
+        return std::nullopt;
+    }
+    if (!active_ || active_->requests.empty() || remaining_ == 0) {
+        selectTask();
+    }
+
+    auto next = active_->requests.lower_bound(nextSector_);
+    if (next == active_->requests.end()) {
+        next = active_->requests.begin();
+    }
+    BlockRequest request = std::move(next->second);
+    active_->requests.erase(next);
+    size_--;
+
+    active_->finish += static_cast<double>(request.sectors) / active_->weight;
+    remaining_ = request.sectors >= remaining_ ? 0 : remaining_ - request.sectors;
+    nextSector_ = request.sector + request.sectors;
+    return request;
+}
+
+void BudgetFairElevator::setWeight(TaskId task, uint32_t weight) {
+    tasks_[task].weight = std::max<uint32_t>(weight, 1);
+}
+
+void BudgetFairElevator::selectTask() {
+    TaskQueue* best = nullptr;
+    for (auto& [task, queue] : tasks_) {
+        if (!queue.requests.empty() && (!best || queue.finish < best->finish)) {
+            best = &queue;
+        }
+    }
+    active_ = best;
+    remaining_ = budget_;
+    virtualTime_ = std::max(virtualTime_, best->finish);
+}
+
+std::unique_ptr<Elevator> makeElevator(const std::string& name) {
+    if (name == "noop") {
+        return std::make_unique<NoopElevator>();
+    }
+    if (name == "deadline") {
+        return std::make_unique<DeadlineElevator>();
+    }
+    if (name == "bfq") {
+        return std::make_unique<BudgetFairElevator>();
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,434 @@
+#include "drivers/network.hpp"
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+
+namespace MiniOS {
+
+FramePool::FramePool(size_t frames)
+    : memory_(new uint8_t[frames * FRAME_SIZE])
+    , frames_(frames)
+{
+    free_.reserve(frames);
+    for (size_t i = frames; i > 0; --i) {
+        free_.push_back(static_cast<FrameIndex>(i - 1));
+    }
+}
+
+size_t FramePool::allocate(FrameIndex* out, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = std::min(count, free_.size());
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = free_.back();
+        free_.pop_back();
+    }
+    return n;
+}
+
+void FramePool::release(const PacketDescriptor* descriptors, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < count; ++i) {
+        free_.push_back(descriptors[i].frame);
+    }
+}
+
+size_t FramePool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+}
+
+DescriptorRing::DescriptorRing(size_t capacity)
+    : tail_(0)
+    , cachedHead_(0)
+    , head_(0)
+    , cachedTail_(0)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_ = std::make_unique<PacketDescriptor[]>(size);
+}
+
+size_t DescriptorRing::push(const PacketDescriptor* descriptors, size_t count) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (capacity() - (tail - cachedHead_) < count) {
+        cachedHead_ = head_.load(std::memory_order_acquire);
+    }
+    size_t n = std::min(count, capacity() - (tail - cachedHead_));
+    for (size_t i = 0; i < n; ++i) {
+        slots_[(tail + i) & mask_] = descriptors[i];
+    }
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+size_t DescriptorRing::pop(PacketDescriptor* out, size_t maxCount) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (cachedTail_ - head < maxCount) {
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+    }
+    size_t n = std::min(maxCount, cachedTail_ - head);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = slots_[(head + i) & mask_];
+    }
+    head_.store(head + n, std::memory_order_release);
+    return n;
+}
+
+VirtualNic::VirtualNic(const std::string& name, std::shared_ptr<FramePool> pool, size_t ringSize)
+    : Driver(name, DriverType::Network)
+    , pool_(std::move(pool))
+    , peer_(this)
+    , stack_(nullptr)
+    , irq_(0)
+    , txRing_(ringSize)
+    , rxRing_(ringSize)
+    , irqArmed_(true)
+    , txPackets_(0)
+    , txBytes_(0)
+    , txBusy_(0)
+    , rxPackets_(0)
+    , rxBytes_(0)
+    , rxDropped_(0)
+    , interrupts_(0)
+    , polls_(0)
+{
+}
+
+bool VirtualNic::init() {
+    if (initialized_ || !pool_) {
+        return false;
+    }
+
+    initialized_ = true;
+    LOG_INFO("VirtualNic", name_ + " up (" + (peer_ == this ? std::string("loopback") : "peer " + peer_->name_) +
+             ", " + std::to_string(rxRing_.capacity()) + " descriptors)");
+    return true;
+}
+
+bool VirtualNic::shutdown() {
+    if (!initialized_) {
+        return false;
+    }
+
+    // Hand back the frames of anything still queued.
+    PacketDescriptor descriptors[NAPI_WEIGHT];
+    {
+        std::lock_guard<std::mutex> lock(txMutex_);
+        while (size_t n = txRing_.pop(descriptors, NAPI_WEIGHT)) {
+            pool_->release(descriptors, n);
+        }
+    }
+    while (size_t n = rxRing_.pop(descriptors, NAPI_WEIGHT)) {
+        pool_->release(descriptors, n);
+    }
+
+    initialized_ = false;
+    LOG_INFO("VirtualNic", name_ + " down");
+    return true;
+}
+
+ssize_t VirtualNic::read(void* buffer, size_t count) {
+    if (!initialized_ || !buffer) {
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> lock(backlogMutex_);
+    if (backlog_.empty()) {
+        return 0;
+    }
+    std::vector<uint8_t>& packet = backlog_.front();
+    size_t length = std::min(count, packet.size());
+    std::memcpy(buffer, packet.data(), length);
+    backlog_.pop_front();
+    return static_cast<ssize_t>(length);
+}
+
+ssize_t VirtualNic::write(const void* buffer, size_t count) {
+    if (!initialized_ || !buffer || count == 0 || count > FRAME_SIZE) {
+        return -1;
+    }
+
+    PacketView packet{static_cast<const uint8_t*>(buffer), static_cast<uint32_t>(count)};
+    return transmit(&packet, 1) == 1 ? static_cast<ssize_t>(count) : -1;
+}
+
+bool VirtualNic::ioctl(uint32_t command, void* arg) {
+    switch (command) {
+        case NET_IOCTL_GET_FRAME_SIZE:
+            if (arg) {
+                *static_cast<uint32_t*>(arg) = static_cast<uint32_t>(FRAME_SIZE);
+                return true;
+            }
+            break;
+    }
+    return false;
+}
+
+bool VirtualNic::connect(VirtualNic& a, VirtualNic& b) {
+    if (&a == &b || a.pool_ != b.pool_ || a.peer_ != &a || b.peer_ != &b) {
+        LOG_WARN("VirtualNic", "Cannot connect " + a.name_ + " to " + b.name_);
+        return false;
+    }
+
+    a.peer_ = &b;
+    b.peer_ = &a;
+    LOG_INFO("VirtualNic", a.name_ + " <-> " + b.name_);
+    return true;
+}
+
+size_t VirtualNic::transmit(const PacketView* packets, size_t count) {
+    if (!initialized_) {
+        return 0;
+    }
+
+    FrameIndex frames[NAPI_WEIGHT];
+    PacketDescriptor descriptors[NAPI_WEIGHT];
+    size_t sent = 0;
+    uint64_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(txMutex_);
+        while (sent < count) {
+            size_t want = std::min({count - sent, NAPI_WEIGHT, txRing_.capacity() - txRing_.size()});
+            for (size_t i = 0; i < want; ++i) {
+                uint32_t length = packets[sent + i].length;
+                if (length == 0 || length > FRAME_SIZE) {
+                    want = i;
+                    break;
+                }
+            }
+
+            size_t got = pool_->allocate(frames, want);
+            for (size_t i = 0; i < got; ++i) {
+                const PacketView& packet = packets[sent + i];
+                std::memcpy(pool_->data(frames[i]), packet.data, packet.length);
+                descriptors[i] = PacketDescriptor{frames[i], packet.length};
+                bytes += packet.length;
+            }
+            txRing_.push(descriptors, got);
+            sent += got;
+            kickTx();
+            if (got == 0) {
+                break;
+            }
+        }
+    }
+
+    txPackets_.fetch_add(sent, std::memory_order_relaxed);
+    txBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    if (sent < count) {
+        txBusy_.fetch_add(count - sent, std::memory_order_relaxed);
+    }
+    return sent;
+}
+
+// The wire: moves whatever fits from our TX ring to the peer's RX ring.
+// Call with txMutex_ held, which also makes it the RX ring's only producer.
+void VirtualNic::kickTx() {
+    PacketDescriptor descriptors[NAPI_WEIGHT];
+    size_t moved = 0;
+    while (true) {
+        size_t room = peer_->rxRing_.capacity() - peer_->rxRing_.size();
+        size_t n = txRing_.pop(descriptors, std::min(room, NAPI_WEIGHT));
+        if (n == 0) {
+            break;
+        }
+        peer_->rxRing_.push(descriptors, n);
+        moved += n;
+    }
+    if (moved > 0) {
+        peer_->signalRx();
+    }
+}
+
+// Fires the RX interrupt unless it is masked; firing masks it until NAPI
+// polling finishes.
+void VirtualNic::signalRx() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!stack_ || !irqArmed_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    if (!stack_->controller_.raiseInterrupt(irq_)) {
+        irqArmed_.store(true, std::memory_order_release);
+    }
+}
+
+bool VirtualNic::completePoll() {
+    irqArmed_.store(true, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (rxRing_.empty()) {
+        return true;
+    }
+    // Packets arrived after the last poll. If the device has not fired for
+    // them yet, take the interrupt back and keep polling.
+    return !irqArmed_.exchange(false, std::memory_order_acq_rel);
+}
+
+size_t VirtualNic::poll(size_t budget) {
+    PacketDescriptor descriptors[NAPI_WEIGHT];
+    PacketView views[NAPI_WEIGHT];
+    size_t done = 0;
+    uint64_t bytes = 0;
+    while (done < budget) {
+        size_t n = rxRing_.pop(descriptors, std::min(budget - done, NAPI_WEIGHT));
+        if (n == 0) {
+            break;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            views[i] = PacketView{pool_->data(descriptors[i].frame), descriptors[i].length};
+            bytes += descriptors[i].length;
+        }
+        if (receiveHandler_) {
+            receiveHandler_(views, n);
+        } else {
+            deliverToBacklog(views, n);
+        }
+        pool_->release(descriptors, n);
+        done += n;
+    }
+
+    polls_.fetch_add(1, std::memory_order_relaxed);
+    rxPackets_.fetch_add(done, std::memory_order_relaxed);
+    rxBytes_.fetch_add(bytes, std::memory_order_relaxed);
+
+    // The sender may have stalled on a full RX ring; there is room now.
+    if (done > 0 && !peer_->txRing_.empty()) {
+        std::lock_guard<std::mutex> lock(peer_->txMutex_);
+        peer_->kickTx();
+    }
+    return done;
+}
+
+void VirtualNic::deliverToBacklog(const PacketView* packets, size_t count) {
+    std::lock_guard<std::mutex> lock(backlogMutex_);
+    for (size_t i = 0; i < count; ++i) {
+        if (backlog_.size() >= rxRing_.capacity()) {
+            rxDropped_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        backlog_.emplace_back(packets[i].data, packets[i].data + packets[i].length);
+    }
+}
+
+NicStats VirtualNic::getStats() const {
+    NicStats stats;
+    stats.txPackets = txPackets_.load(std::memory_order_relaxed);
+    stats.txBytes = txBytes_.load(std::memory_order_relaxed);
+    stats.txBusy = txBusy_.load(std::memory_order_relaxed);
+    stats.rxPackets = rxPackets_.load(std::memory_order_relaxed);
+    stats.rxBytes = rxBytes_.load(std::memory_order_relaxed);
+    stats.rxDropped = rxDropped_.load(std::memory_order_relaxed);
+    stats.interrupts = interrupts_.load(std::memory_order_relaxed);
+    stats.polls = polls_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+NetworkStack::NetworkStack(InterruptController& controller)
+    : controller_(controller)
+    , softirqOpen_(false)
+{
+    for (size_t i = 0; i < controller.getCpuCount(); ++i) {
+        pollLists_.push_back(std::make_unique<PollList>());
+    }
+    softirqOpen_ = controller_.openSoftirq(SoftirqId::NetRx, [this]() { netRxAction(); }, "NetRx");
+}
+
+NetworkStack::~NetworkStack() {
+    for (VirtualNic* nic : devices_) {
+        controller_.unregisterHandler(nic->irq_);
+        nic->stack_ = nullptr;
+    }
+    if (softirqOpen_) {
+        controller_.closeSoftirq(SoftirqId::NetRx);
+    }
+}
+
+bool NetworkStack::attach(VirtualNic& nic, InterruptNumber irq) {
+    if (!softirqOpen_ || nic.stack_) {
+        return false;
+    }
+    if (!controller_.registerHandler(irq, &NetworkStack::interruptEntry, &nic, nic.getName())) {
+        return false;
+    }
+
+    nic.irq_ = irq;
+    nic.stack_ = this;
+    devices_.push_back(&nic);
+    LOG_INFO("NetworkStack", "Attached " + nic.getName() + " on interrupt " + std::to_string(irq));
+    return true;
+}
+
+void NetworkStack::interruptEntry(InterruptNumber, void* context, void*) {
+    auto* nic = static_cast<VirtualNic*>(context);
+    nic->interrupts_.fetch_add(1, std::memory_order_relaxed);
+    nic->stack_->schedule(*nic);
+}
+
+void NetworkStack::schedule(VirtualNic& nic) {
+    PollList& list = localPollList();
+    {
+        std::lock_guard<std::mutex> lock(list.mutex);
+        list.devices.push_back(&nic);
+    }
+    controller_.raiseSoftirq(SoftirqId::NetRx);
+}
+
+// NICs that use their whole weight go to the back of the line with the
+// interrupt still masked; whatever is left when the budget runs out is put
+// back on the list for the next run.
+void NetworkStack::netRxAction() {
+    PollList& list = localPollList();
+    std::deque<VirtualNic*> work;
+    {
+        std::lock_guard<std::mutex> lock(list.mutex);
+        work.swap(list.devices);
+    }
+
+    size_t budget = NET_RX_BUDGET;
+    while (!work.empty() && budget > 0) {
+        VirtualNic* nic = work.front();
+        work.pop_front();
+        size_t weight = std::min(NAPI_WEIGHT, budget);
+        size_t done = nic->poll(weight);
+        budget -= done;
+        if (done < weight && nic->completePoll()) {
+            continue;
+        }
+        work.push_back(nic);
+    }
+
+    if (!work.empty()) {
+        std::lock_guard<std::mutex> lock(list.mutex);
+        list.devices.insert(list.devices.begin(), work.begin(), work.end());
+        controller_.raiseSoftirq(SoftirqId::NetRx);
+    }
+}
+
+NetworkStack::PollList& NetworkStack::localPollList() {
+    return *pollLists_[InterruptController::currentCpu() % pollLists_.size()];
+}
+
+std::string NetworkStack::getNetworkReport() const {
+    std::stringstream ss;
+    ss << "=== Network Report ===\n";
+    for (const VirtualNic* nic : devices_) {
+        NicStats stats = nic->getStats();
+        ss << nic->getName() << " (irq " << nic->getIrq() << ", "
+           << (nic->peer_ == nic ? std::string("loopback") : "peer " + nic->peer_->getName()) << ")\n";
+        ss << "  TX: " << stats.txPackets << " packets, " << stats.txBytes << " bytes, "
+           << stats.txBusy << " busy\n";
+        ss << "  RX: " << stats.rxPackets << " packets, " << stats.rxBytes << " bytes, "
+           << stats.rxDropped << " dropped\n";
+        ss << "  Interrupts: " << stats.interrupts << ", Polls: " << stats.polls;
+        if (stats.interrupts > 0) {
+            ss << " (" << std::fixed << std::setprecision(1)
+               << double(stats.rxPackets) / stats.interrupts << " packets/interrupt)";
+        }
+        ss << "\n";
+    }
+    return ss.str();
+}
+
+}
@@ -0,0 +1,283 @@
+#include "ipc/channel_stats.hpp"
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+namespace MiniOS {
+
+// Instances not yet destroyed. A thread folding its shards on exit holds the
+// mutex, so the instance it folds into cannot go away underneath it.
+static std::mutex g_liveStatsMutex;
+static std::unordered_map<uint64_t, ChannelStats*> g_liveStats;
+
+// Shards this thread owns, by stats instance. Instance ids are never reused;
+// entries of destroyed instances are dropped the next time a shard is added.
+struct LocalShards {
+    uint64_t lastInstance = 0;
+    ChannelStats::Shard* last = nullptr;
+    std::unordered_map<uint64_t, ChannelStats::Shard*> byInstance;
+
+    ~LocalShards() {
+        std::lock_guard<std::mutex> lock(g_liveStatsMutex);
+        for (auto& [instance, shard] : byInstance) {
+            auto it = g_liveStats.find(instance);
+            if (it != g_liveStats.end()) {
+                it->second->retireShard(shard);
+            }
+        }
+    }
+
+    void pruneDestroyed() {
+        std::lock_guard<std::mutex> lock(g_liveStatsMutex);
+        for (auto it = byInstance.begin(); it != byInstance.end();) {
+            it = g_liveStats.count(it->first) ? std::next(it) : byInstance.erase(it);
+        }
+    }
+};
+
+static thread_local LocalShards t_localShards;
+static std::atomic<uint64_t> g_nextStatsInstance{1};
+
+uint64_t ChannelSnapshot::latencyPercentile(double quantile) const {
+    uint64_t total = 0;
+    for (uint64_t count : latency) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * total + 0.5));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+        seen += latency[b];
+        if (seen >= target) {
+            return uint64_t(1) << (b + 1);
+        }
+    }
+    return uint64_t(1) << LATENCY_BUCKETS;
+}
+
+ChannelStats::ChannelStats()
+    : instanceId_(g_nextStatsInstance.fetch_add(1, std::memory_order_relaxed))
+    , enabled_(true)
+{
+    std::lock_guard<std::mutex> lock(g_liveStatsMutex);
+    g_liveStats[instanceId_] = this;
+}
+
+ChannelStats::~ChannelStats() {
+    std::lock_guard<std::mutex> lock(g_liveStatsMutex);
+    g_liveStats.erase(instanceId_);
+}
+
+ChannelStats::Shard& ChannelStats::localShard() {
+    LocalShards& local = t_localShards;
+    if (local.lastInstance == instanceId_) {
+        return *local.last;
+    }
+
+    auto it = local.byInstance.find(instanceId_);
+    Shard* shard;
+    if (it != local.byInstance.end()) {
+        shard = it->second;
+    } else {
+        local.pruneDestroyed();
+        auto owned = std::make_unique<Shard>();
+        shard = owned.get();
+        {
+            std::lock_guard<std::mutex> lock(shardsMutex_);
+            shards_.push_back(std::move(owned));
+        }
+        local.byInstance[instanceId_] = shard;
+    }
+    local.lastInstance = instanceId_;
+    local.last = shard;
+    return *shard;
+}
+
+// Called from the owning thread's exit, so nothing writes the shard anymore.
+void ChannelStats::retireShard(Shard* shard) {
+    std::lock_guard<std::mutex> lock(shardsMutex_);
+    for (const auto& [key, c] : shard->channels) {
+        auto& total = retired_[key];
+        if (!total) {
+            total = std::make_unique<Counters>();
+        }
+        bump(total->sent, c->sent.load(std::memory_order_relaxed));
+        bump(total->received, c->received.load(std::memory_order_relaxed));
+        bump(total->bytes, c->bytes.load(std::memory_order_relaxed));
+        bump(total->drops, c->drops.load(std::memory_order_relaxed));
+        bump(total->timeouts, c->timeouts.load(std::memory_order_relaxed));
+        total->depthHighWater.store(std::max(total->depthHighWater.load(std::memory_order_relaxed),
+                                             c->depthHighWater.load(std::memory_order_relaxed)),
+                                    std::memory_order_relaxed);
+        for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+            bump(total->latency[b], c->latency[b].load(std::memory_order_relaxed));
+        }
+    }
+    shards_.erase(std::find_if(shards_.begin(), shards_.end(),
+                               [shard](const std::unique_ptr<Shard>& owned) { return owned.get() == shard; }));
+}
+
+ChannelStats::Counters& ChannelStats::counters(TaskId sender, TaskId receiver) {
+    Shard& shard = localShard();
+    uint64_t key = channelKey(sender, receiver);
+    if (shard.last && shard.lastKey == key) {
+        return *shard.last;
+    }
+
+    auto it = shard.channels.find(key);
+    if (it == shard.channels.end()) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        it = shard.channels.emplace(key, std::make_unique<Counters>()).first;
+    }
+    shard.lastKey = key;
+    shard.last = it->second.get();
+    return *shard.last;
+}
+
+void ChannelStats::recordSend(TaskId sender, TaskId receiver, uint64_t count, uint64_t bytes,
+                              size_t depth) {
+    if (!isEnabled()) {
+        return;
+    }
+    Counters& c = counters(sender, receiver);
+    bump(c.sent, count);
+    bump(c.bytes, bytes);
+    if (depth > c.depthHighWater.load(std::memory_order_relaxed)) {
+        c.depthHighWater.store(depth, std::memory_order_relaxed);
+    }
+}
+
+void ChannelStats::recordDrop(TaskId sender, TaskId receiver, uint64_t count) {
+    if (!isEnabled()) {
+        return;
+    }
+    bump(counters(sender, receiver).drops, count);
+}
+
+void ChannelStats::recordLatency(Counters& c, std::chrono::steady_clock::duration latency) {
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    size_t bucket = 0;
+    if (nanos > 1) {
+        bucket = std::min<size_t>(63 - __builtin_clzll(static_cast<uint64_t>(nanos)), LATENCY_BUCKETS - 1);
+    }
+    bump(c.latency[bucket], 1);
+}
+
+void ChannelStats::recordReceive(TaskId sender, TaskId receiver,
+                                 std::chrono::steady_clock::time_point sentAt) {
+    if (!isEnabled()) {
+        return;
+    }
+    Counters& c = counters(sender, receiver);
+    uint64_t received = c.received.load(std::memory_order_relaxed);
+    c.received.store(received + 1, std::memory_order_relaxed);
+    if (received % LATENCY_SAMPLE_INTERVAL == 0) {
+        recordLatency(c, std::chrono::steady_clock::now() - sentAt);
+    }
+}
+
+void ChannelStats::recordReceive(TaskId sender, TaskId receiver,
+                                 std::chrono::steady_clock::time_point sentAt,
+                                 std::chrono::steady_clock::time_point now) {
+    if (!isEnabled()) {
+        return;
+    }
+    Counters& c = counters(sender, receiver);
+    bump(c.received, 1);
+    recordLatency(c, now - sentAt);
+}
+
+void ChannelStats::recordTimeout(TaskId sender, TaskId receiver) {
+    if (!isEnabled()) {
+        return;
+    }
+    bump(counters(sender, receiver).timeouts, 1);
+}
+
+std::vector<ChannelSnapshot> ChannelStats::snapshot() const {
+    std::map<uint64_t, ChannelSnapshot> merged;
+    auto merge = [&merged](uint64_t key, const Counters& c) {
+        auto [it, inserted] = merged.try_emplace(key);
+        ChannelSnapshot& s = it->second;
+        if (inserted) {
+            s = ChannelSnapshot{static_cast<TaskId>(key >> 32), static_cast<TaskId>(key),
+                                0, 0, 0, 0, 0, 0, {}};
+        }
+        s.sent += c.sent.load(std::memory_order_relaxed);
+        s.received += c.received.load(std::memory_order_relaxed);
+        s.bytes += c.bytes.load(std::memory_order_relaxed);
+        s.drops += c.drops.load(std::memory_order_relaxed);
+        s.timeouts += c.timeouts.load(std::memory_order_relaxed);
+        s.depthHighWater = std::max(s.depthHighWater, c.depthHighWater.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+            s.latency[b] += c.latency[b].load(std::memory_order_relaxed);
+        }
+    };
+
+    std::lock_guard<std::mutex> shardsLock(shardsMutex_);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& [key, c] : shard->channels) {
+            merge(key, *c);
+        }
+    }
+    for (const auto& [key, c] : retired_) {
+        merge(key, *c);
+    }
+
+    std::vector<ChannelSnapshot> result;
+    result.reserve(merged.size());
+    for (auto& [key, s] : merged) {
+        result.push_back(s);
+    }
+    return result;
+}
+
+static std::string endpoint(TaskId task) {
+    return task == ANY_SENDER ? "*" : std::to_string(task);
+}
+
+static void describeChannel(std::stringstream& ss, const ChannelSnapshot& s) {
+    ss << "  " << endpoint(s.sender) << " -> " << s.receiver << ": "
+       << s.sent << " sent, " << s.received << " received, " << s.bytes << " bytes, "
+       << "p50 <= " << s.latencyPercentile(0.5) << " ns, "
+       << "p99 <= " << s.latencyPercentile(0.99) << " ns, "
+       << "depth high-water " << s.depthHighWater;
+    if (s.drops > 0) {
+        ss << ", " << s.drops << " dropped";
+    }
+    if (s.timeouts > 0) {
+        ss << ", " << s.timeouts << " timeouts";
+    }
+    ss << "\n";
+}
+
+std::string ChannelStats::getChannelReport(size_t limit) const {
+    auto channels = snapshot();
+
+    std::stringstream ss;
+    ss << "=== Channel Report ===\n";
+    ss << "Channels: " << channels.size() << (isEnabled() ? "" : " (tracing disabled)") << "\n";
+
+    std::sort(channels.begin(), channels.end(), [](const ChannelSnapshot& a, const ChannelSnapshot& b) {
+        return a.sent + a.received > b.sent + b.received;
+    });
+    ss << "Busiest:\n";
+    for (size_t i = 0; i < channels.size() && i < limit; ++i) {
+        describeChannel(ss, channels[i]);
+    }
+
+    std::sort(channels.begin(), channels.end(), [](const ChannelSnapshot& a, const ChannelSnapshot& b) {
+        return a.latencyPercentile(0.99) > b.latencyPercentile(0.99);
+    });
+    ss << "Slowest Consumers:\n";
+    for (size_t i = 0; i < channels.size() && i < limit && channels[i].received > 0; ++i) {
+        describeChannel(ss, channels[i]);
+    }
+    return ss.str();
+}
+
+}
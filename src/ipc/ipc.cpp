@@ -1,190 +1,2322 @@
 #include "ipc/ipc.hpp"
+#include "ipc/port.hpp"
 #include <sstream>
+#include <algorithm>
 #include <thread>
 
 namespace MiniOS {
 
-MessageQueue::MessageQueue(TaskId owner)
+namespace {
+
+constexpr int RENDEZVOUS_SPIN_LIMIT = 32;
+constexpr std::array<size_t, MESSAGE_PRIORITY_COUNT> LEVEL_WEIGHTS = {1, 2, 4, 8};
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+}
+
+bool Rendezvous::arm() {
+    uint32_t expected = Empty;
+    return state_.compare_exchange_strong(expected, Armed, std::memory_order_acq_rel);
+}
+
+bool Rendezvous::disarm() {
+    uint32_t expected = Armed;
+    return state_.compare_exchange_strong(expected, Empty, std::memory_order_acq_rel);
+}
+
+bool Rendezvous::deliver(Message& msg) {
+    uint32_t expected = Armed;
+    if (!state_.compare_exchange_strong(expected, Writing, std::memory_order_acquire)) {
+        return false;
+    }
+    
+    slot_.emplace(std::move(msg));
+    state_.store(Full, std::memory_order_release);
+    
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+    }
+    return true;
+}
+
+std::optional<Message> Rendezvous::tryTake() {
+    if (state_.load(std::memory_order_acquire) != Full) {
+        return std::nullopt;
+    }
+    
+    std::optional<Message> msg = std::move(slot_);
+    slot_.reset();
+    state_.store(Empty, std::memory_order_release);
+    return msg;
+}
+
+std::optional<Message> Rendezvous::take(Deadline deadline) {
+    if (!waitForState(Full, deadline)) {
+        if (disarm()) {
+            return std::nullopt;
+        }
+        while (state_.load(std::memory_order_acquire) != Full) {
+            std::this_thread::yield();
+        }
+    }
+    return tryTake();
+}
+
+void Rendezvous::close() {
+    closed_.store(true, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex_);
+    condition_.notify_all();
+}
+
+void Notification::signal(uint64_t bits) {
+    if (bits == 0 || bits_.fetch_or(bits, std::memory_order_seq_cst) != 0) {
+        return;
+    }
+    
+    if (waiters_.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+    }
+    bool observed = false;
+    for (const auto& slot : observers_) {
+        observed = observed || slot.load(std::memory_order_relaxed);
+    }
+    if (observed) {
+        EpochDomain::Guard guard;
+        for (auto& slot : observers_) {
+            if (ReadinessObserver* observer = slot.load(std::memory_order_acquire)) {
+                observer->onReady();
+            }
+        }
+    }
+}
+
+uint64_t Notification::wait(Deadline deadline) {
+    uint64_t bits = take();
+    if (bits != 0 || deadline <= std::chrono::steady_clock::now()) {
+        return bits;
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    auto ready = [this]() { return bits_.load(std::memory_order_acquire) != 0; };
+    if (deadline == NO_DEADLINE) {
+        condition_.wait(lock, ready);
+    } else {
+        condition_.wait_until(lock, deadline, ready);
+    }
+    
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    return take();
+}
+
+bool Notification::attach(ReadinessObserver* observer) {
+    for (auto& slot : observers_) {
+        ReadinessObserver* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, observer, std::memory_order_acq_rel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Notification::detach(ReadinessObserver* observer) {
+    for (auto& slot : observers_) {
+        ReadinessObserver* expected = observer;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+}
+
+bool Rendezvous::waitForState(State target, Deadline deadline) {
+    if (state_.load(std::memory_order_acquire) == target) {
+        return true;
+    }
+    if (deadline <= std::chrono::steady_clock::now()) {
+        return false;
+    }
+    
+    for (int spin = 0; spin < RENDEZVOUS_SPIN_LIMIT; ++spin) {
+        std::this_thread::yield();
+        if (state_.load(std::memory_order_acquire) == target) {
+            return true;
+        }
+    }
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    auto ready = [&]() {
+        return closed_.load(std::memory_order_acquire) || 
+               state_.load(std::memory_order_acquire) == target;
+    };
+    if (deadline == NO_DEADLINE) {
+        condition_.wait(lock, ready);
+    } else {
+        condition_.wait_until(lock, deadline, ready);
+    }
+    
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    return state_.load(std::memory_order_acquire) == target;
+}
+
+MessageRing::MessageRing(size_t capacity)
+    : capacity_(roundUpToPowerOfTwo(capacity))
+    , mask_(capacity_ - 1)
+    , slots_(std::make_unique<Slot[]>(capacity_))
+    , tail_(0)
+    , head_(0)
+{
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+MessageRing::~MessageRing() {
+    while (dequeue()) {
+    }
+}
+
+bool MessageRing::enqueue(Message& msg) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    
+    new (slot->storage) Message(std::move(msg));
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+size_t MessageRing::enqueueBatch(Message* messages, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    size_t claimed;
+    
+    for (;;) {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t used = pos - std::min(head, pos);
+        if (used >= capacity_) {
+            return 0;
+        }
+        claimed = std::min(count, capacity_ - used);
+        
+        size_t last = pos + claimed - 1;
+        size_t seq = slots_[last & mask_].sequence.load(std::memory_order_acquire);
+        if (seq != last) {
+            pos = tail_.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (tail_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    
+    for (size_t i = 0; i < claimed; ++i) {
+        Slot& slot = slots_[(pos + i) & mask_];
+        new (slot.storage) Message(std::move(messages[i]));
+        slot.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    return claimed;
+}
+
+const Message* MessageRing::peek() const {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    const Slot& slot = slots_[pos & mask_];
+    
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return nullptr;
+    }
+    return slot.message();
+}
+
+std::optional<Message> MessageRing::dequeue() {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos & mask_];
+    
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return std::nullopt;
+    }
+    
+    Message* stored = slot.message();
+    std::optional<Message> msg(std::move(*stored));
+    stored->~Message();
+    
+    slot.sequence.store(pos + capacity_, std::memory_order_release);
+    head_.store(pos + 1, std::memory_order_release);
+    return msg;
+}
+
+size_t MessageRing::dequeueBatch(std::vector<Message>& out, size_t maxCount) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    size_t taken = 0;
+    
+    while (taken < maxCount) {
+        Slot& slot = slots_[pos & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;
+        }
+        
+        Message* stored = slot.message();
+        out.push_back(std::move(*stored));
+        stored->~Message();
+        slot.sequence.store(pos + capacity_, std::memory_order_release);
+        pos++;
+        taken++;
+    }
+    head_.store(pos, std::memory_order_release);
+    return taken;
+}
+
+size_t MessageRing::size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+}
+
+MessageQueue::MessageQueue(TaskId owner, size_t capacity)
+    : MessageQueue(owner, QueueLimits{capacity, DEFAULT_QUEUE_BYTES, OverflowPolicy::FailFast})
+{
+}
+
+MessageQueue::MessageQueue(TaskId owner, const QueueLimits& limits)
     : owner_(owner)
+    , limits_(limits)
+    , capacity_(roundUpToPowerOfTwo(limits.maxMessages))
+    , readyLevels_(0)
+    , levelBudget_(LEVEL_WEIGHTS)
+    , stashed_(0)
+    , queuedMessages_(0)
+    , queuedBytes_(0)
+    , evicted_(0)
+    , spaceWaiters_(0)
+    , waiters_(0)
+    , closed_(false)
+    , observer_(nullptr)
+    , bound_(nullptr)
+    , references_(1)
 {
+    for (auto& ring : rings_) {
+        ring.store(nullptr, std::memory_order_relaxed);
+    }
+    ringFor(MessagePriority::Normal);
+}
+
+MessageQueue::~MessageQueue() {
+    for (auto& ring : rings_) {
+        delete ring.load(std::memory_order_relaxed);
+    }
+}
+
+// Rings other than Normal are created by the first producer that needs them.
+MessageRing* MessageQueue::ringFor(MessagePriority priority) {
+    auto& slot = rings_[static_cast<size_t>(priority)];
+    MessageRing* ring = slot.load(std::memory_order_acquire);
+    if (ring) {
+        return ring;
+    }
+    
+    auto* created = new MessageRing(capacity_);
+    if (slot.compare_exchange_strong(ring, created, std::memory_order_acq_rel)) {
+        return created;
+    }
+    delete created;
+    return ring;
+}
+
+bool MessageQueue::enqueue(Message&& msg) {
+    if (limits_.policy == OverflowPolicy::DropOldest) {
+        return enqueueEvicting(msg);
+    }
+    
+    size_t bytes = msg.payload.size();
+    if (!admit(bytes)) {
+        return false;
+    }
+    
+    int level = static_cast<int>(msg.priority);
+    if (!ringFor(msg.priority)->enqueue(msg)) {
+        retire(1, bytes);
+        return false;
+    }
+    markReady(level);
+    wakeWaiters();
+    return true;
+}
+
+size_t MessageQueue::enqueueBatch(Message* messages, size_t count) {
+    if (limits_.policy == OverflowPolicy::DropOldest) {
+        size_t sent = 0;
+        while (sent < count && enqueueEvicting(messages[sent])) {
+            sent++;
+        }
+        return sent;
+    }
+    
+    size_t admitted = 0;
+    while (admitted < count && admit(messages[admitted].payload.size())) {
+        admitted++;
+    }
+    count = admitted;
+    
+    size_t sent = 0;
+    while (sent < count) {
+        MessagePriority priority = messages[sent].priority;
+        size_t run = 1;
+        while (sent + run < count && messages[sent + run].priority == priority) {
+            run++;
+        }
+        
+        size_t claimed = ringFor(priority)->enqueueBatch(messages + sent, run);
+        if (claimed > 0) {
+            markReady(static_cast<int>(priority));
+        }
+        sent += claimed;
+        if (claimed < run) {
+            break;
+        }
+    }
+    
+    if (sent < count) {
+        size_t bytes = 0;
+        for (size_t i = sent; i < count; ++i) {
+            bytes += messages[i].payload.size();
+        }
+        retire(count - sent, bytes);
+    }
+    
+    if (sent > 0) {
+        wakeWaiters();
+    }
+    return sent;
+}
+
+std::optional<Message> MessageQueue::dequeue() {
+    std::unique_lock<std::mutex> evictLock(evictMutex_, std::defer_lock);
+    if (limits_.policy == OverflowPolicy::DropOldest) {
+        evictLock.lock();
+    }
+    evictOverflow();
+    
+    std::optional<Message> msg;
+    int level = nextLevel();
+    if (level >= 0) {
+        msg = takeLevel(level);
+    }
+    
+    if (msg) {
+        retire(1, msg->payload.size());
+    }
+    return msg;
+}
+
+size_t MessageQueue::dequeueBatch(std::vector<Message>& out, size_t maxCount) {
+    std::unique_lock<std::mutex> evictLock(evictMutex_, std::defer_lock);
+    if (limits_.policy == OverflowPolicy::DropOldest) {
+        evictLock.lock();
+    }
+    evictOverflow();
+    
+    size_t first = out.size();
+    size_t taken = 0;
+    
+    while (taken < maxCount) {
+        int level = nextLevel();
+        if (level < 0) {
+            break;
+        }
+        
+        if (levelBudget_[level] == 0) {
+            levelBudget_ = LEVEL_WEIGHTS;
+        }
+        size_t share = std::min(maxCount - taken, levelBudget_[level]);
+        size_t count = 0;
+        while (count < share && byPriority_[level].head) {
+            out.push_back(unstash(byPriority_[level].head));
+            count++;
+        }
+        if (count < share) {
+            MessageRing* ring = rings_[level].load(std::memory_order_acquire);
+            count += ring->dequeueBatch(out, share - count);
+        }
+        chargeLevel(level, count);
+        taken += count;
+    }
+    
+    if (taken > 0) {
+        size_t bytes = 0;
+        for (size_t i = first; i < out.size(); ++i) {
+            bytes += out[i].payload.size();
+        }
+        retire(taken, bytes);
+    }
+    return taken;
+}
+
+std::optional<Message> MessageQueue::dequeueMatching(const MessageFilter& filter) {
+    std::unique_lock<std::mutex> evictLock(evictMutex_, std::defer_lock);
+    if (limits_.policy == OverflowPolicy::DropOldest) {
+        evictLock.lock();
+    }
+    evictOverflow();
+    
+    std::optional<Message> msg;
+    int level = (stashed_.load(std::memory_order_relaxed) == 0) ? readyLevel() : -1;
+    if (level >= 0 && filter.matches(*rings_[level].load(std::memory_order_acquire)->peek())) {
+        msg = dequeueLevel(level);
+    } else if (level >= 0 || stashed_.load(std::memory_order_relaxed) > 0) {
+        drainRingToStash();
+        if (StashNode* node = findStashed(filter)) {
+            msg = unstash(node);
+        }
+    }
+    
+    if (msg) {
+        retire(1, msg->payload.size());
+    }
+    return msg;
+}
+
+const Message* MessageQueue::peek() const {
+    if (stashed_.load(std::memory_order_relaxed) > 0) {
+        int level = nextLevel();
+        if (StashNode* node = byPriority_[level].head) {
+            return &*node->message;
+        }
+        return rings_[level].load(std::memory_order_acquire)->peek();
+    }
+    return peekRing();
+}
+
+const Message* MessageQueue::peekRing() const {
+    int level = readyLevel();
+    if (level < 0) {
+        return nullptr;
+    }
+    return rings_[level].load(std::memory_order_acquire)->peek();
+}
+
+std::optional<Message> MessageQueue::dequeueRing() {
+    int level = readyLevel();
+    if (level < 0) {
+        return std::nullopt;
+    }
+    return dequeueLevel(level);
+}
+
+// Picks the highest level that still has budget in the current round. When
+// every non-empty level has spent its share the highest one wins, and
+// charging it starts the next round.
+int MessageQueue::readyLevel() const {
+    uint32_t ready = readyLevels_.load(std::memory_order_acquire);
+    int exhausted = -1;
+    
+    for (int level = MESSAGE_PRIORITY_COUNT - 1; level >= 0; --level) {
+        if (!(ready & (1u << level))) {
+            continue;
+        }
+        MessageRing* ring = rings_[level].load(std::memory_order_acquire);
+        if (!ring->peek()) {
+            continue;
+        }
+        if (levelBudget_[level] > 0) {
+            return level;
+        }
+        if (exhausted < 0) {
+            exhausted = level;
+        }
+    }
+    return exhausted;
+}
+
+// readyLevel() over the stash as well as the rings, so skipped-over messages
+// take their turn in the same round as their priority level.
+int MessageQueue::nextLevel() const {
+    if (stashed_.load(std::memory_order_relaxed) == 0) {
+        return readyLevel();
+    }
+    
+    uint32_t ready = readyLevels_.load(std::memory_order_acquire);
+    int exhausted = -1;
+    
+    for (int level = MESSAGE_PRIORITY_COUNT - 1; level >= 0; --level) {
+        bool pending = byPriority_[level].head != nullptr;
+        if (!pending && (ready & (1u << level))) {
+            pending = rings_[level].load(std::memory_order_acquire)->peek() != nullptr;
+        }
+        if (!pending) {
+            continue;
+        }
+        if (levelBudget_[level] > 0) {
+            return level;
+        }
+        if (exhausted < 0) {
+            exhausted = level;
+        }
+    }
+    return exhausted;
+}
+
+// Stashed messages of a level arrived before anything still in its ring.
+std::optional<Message> MessageQueue::takeLevel(int level) {
+    StashNode* node = byPriority_[level].head;
+    if (!node) {
+        return dequeueLevel(level);
+    }
+    if (levelBudget_[level] == 0) {
+        levelBudget_ = LEVEL_WEIGHTS;
+    }
+    Message msg = unstash(node);
+    chargeLevel(level, 1);
+    return msg;
+}
+
+std::optional<Message> MessageQueue::dequeueLevel(int level) {
+    if (levelBudget_[level] == 0) {
+        levelBudget_ = LEVEL_WEIGHTS;
+    }
+    auto msg = rings_[level].load(std::memory_order_acquire)->dequeue();
+    if (msg) {
+        chargeLevel(level, 1);
+    }
+    return msg;
+}
+
+void MessageQueue::markReady(int level) {
+    if (!(readyLevels_.load(std::memory_order_relaxed) & (1u << level))) {
+        readyLevels_.fetch_or(1u << level, std::memory_order_acq_rel);
+    }
+}
+
+void MessageQueue::chargeLevel(int level, size_t count) {
+    levelBudget_[level] -= std::min(count, levelBudget_[level]);
+    clearReadyIfEmpty(level);
+}
+
+// A producer publishes its slot before setting the bit, so re-checking the
+// ring after clearing catches any message that raced with the clear.
+void MessageQueue::clearReadyIfEmpty(int level) {
+    MessageRing* ring = rings_[level].load(std::memory_order_acquire);
+    if (ring->peek()) {
+        return;
+    }
+    readyLevels_.fetch_and(~(1u << level), std::memory_order_acq_rel);
+    if (ring->peek()) {
+        markReady(level);
+    }
+}
+
+bool MessageQueue::admit(size_t bytes) {
+    size_t messages = queuedMessages_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    size_t total = queuedBytes_.fetch_add(bytes, std::memory_order_acq_rel) + bytes;
+    
+    if (limits_.policy == OverflowPolicy::DropOldest || 
+        (messages <= limits_.maxMessages && total <= limits_.maxBytes)) {
+        return true;
+    }
+    
+    queuedMessages_.fetch_sub(1, std::memory_order_acq_rel);
+    queuedBytes_.fetch_sub(bytes, std::memory_order_acq_rel);
+    return false;
+}
+
+void MessageQueue::retire(size_t count, size_t bytes) {
+    queuedMessages_.fetch_sub(count, std::memory_order_acq_rel);
+    queuedBytes_.fetch_sub(bytes, std::memory_order_acq_rel);
+    
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (spaceWaiters_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(spaceMutex_);
+        spaceCondition_.notify_all();
+    }
+}
+
+bool MessageQueue::hasSpace(size_t bytes) const {
+    return queuedMessages_.load(std::memory_order_acquire) < limits_.maxMessages &&
+           queuedBytes_.load(std::memory_order_acquire) + bytes <= limits_.maxBytes;
+}
+
+SendWindow MessageQueue::window() const {
+    size_t messages = queuedMessages_.load(std::memory_order_acquire);
+    size_t bytes = queuedBytes_.load(std::memory_order_acquire);
+    return {limits_.maxMessages - std::min(messages, limits_.maxMessages),
+            limits_.maxBytes - std::min(bytes, limits_.maxBytes)};
+}
+
+bool MessageQueue::waitForSpace(size_t bytes, Deadline deadline) {
+    std::unique_lock<std::mutex> lock(spaceMutex_);
+    spaceWaiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    auto ready = [&]() { return isClosed() || hasSpace(bytes); };
+    bool satisfied;
+    if (deadline == NO_DEADLINE) {
+        spaceCondition_.wait(lock, ready);
+        satisfied = true;
+    } else {
+        satisfied = spaceCondition_.wait_until(lock, deadline, ready);
+    }
+    
+    spaceWaiters_.fetch_sub(1, std::memory_order_relaxed);
+    return satisfied && !isClosed();
+}
+
+// The reservation is taken before evicting, so the loop also makes room for
+// the new message; one larger than maxBytes still gets in on its own.
+bool MessageQueue::enqueueEvicting(Message& msg) {
+    size_t bytes = msg.payload.size();
+    int level = static_cast<int>(msg.priority);
+    MessageRing* ring = ringFor(msg.priority);
+    {
+        std::lock_guard<std::mutex> lock(evictMutex_);
+        queuedMessages_.fetch_add(1, std::memory_order_acq_rel);
+        queuedBytes_.fetch_add(bytes, std::memory_order_acq_rel);
+        while ((queuedMessages_.load(std::memory_order_acquire) > limits_.maxMessages ||
+                queuedBytes_.load(std::memory_order_acquire) > limits_.maxBytes) &&
+               evictFromRings()) {
+        }
+        if (!ring->enqueue(msg)) {
+            retire(1, bytes);
+            return false;
+        }
+        markReady(level);
+    }
+    wakeWaiters();
+    return true;
+}
+
+// Drops the oldest message of the lowest non-empty priority level. Callers
+// hold evictMutex_.
+bool MessageQueue::evictFromRings() {
+    for (int level = 0; level < static_cast<int>(MESSAGE_PRIORITY_COUNT); ++level) {
+        MessageRing* ring = rings_[level].load(std::memory_order_acquire);
+        if (!ring || !ring->peek()) {
+            continue;
+        }
+        std::optional<Message> victim = ring->dequeue();
+        clearReadyIfEmpty(level);
+        retire(1, victim->payload.size());
+        evicted_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+// Consumer side of DropOldest: trims stashed messages, oldest first, that
+// kept the queue over its limits where producers could not reach them.
+void MessageQueue::evictOverflow() {
+    if (limits_.policy != OverflowPolicy::DropOldest) {
+        return;
+    }
+    
+    while (queuedMessages_.load(std::memory_order_acquire) > limits_.maxMessages ||
+           queuedBytes_.load(std::memory_order_acquire) > limits_.maxBytes) {
+        if (stashed_.load(std::memory_order_relaxed) > 0) {
+            Message victim = unstash(arrival_.head);
+            retire(1, victim.payload.size());
+            evicted_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!evictFromRings()) {
+            break;
+        }
+    }
+}
+
+// Stashing is not delivery, so the round's budgets are left as they were.
+void MessageQueue::drainRingToStash() {
+    auto budget = levelBudget_;
+    while (auto msg = dequeueRing()) {
+        stash(std::move(*msg));
+    }
+    levelBudget_ = budget;
+}
+
+void MessageQueue::stash(Message msg) {
+    StashNode* node;
+    if (!freeStashNodes_.empty()) {
+        node = freeStashNodes_.back();
+        freeStashNodes_.pop_back();
+    } else {
+        stashNodes_.push_back(std::make_unique<StashNode>());
+        node = stashNodes_.back().get();
+    }
+    
+    node->message.emplace(std::move(msg));
+    const Message& stored = *node->message;
+    
+    linkNode(arrival_, node, ByArrival);
+    linkNode(bySender_[stored.senderId], node, BySender);
+    linkNode(byType_[static_cast<size_t>(stored.type)], node, ByType);
+    linkNode(byPriority_[static_cast<size_t>(stored.priority)], node, ByPriority);
+    if (stored.correlationId != 0) {
+        linkNode(byCorrelation_[stored.correlationId], node, ByCorrelation);
+    }
+    
+    stashed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+Message MessageQueue::unstash(StashNode* node) {
+    Message msg(std::move(*node->message));
+    node->message.reset();
+    
+    unlinkNode(arrival_, node, ByArrival);
+    unlinkNode(bySender_[msg.senderId], node, BySender);
+    unlinkNode(byType_[static_cast<size_t>(msg.type)], node, ByType);
+    unlinkNode(byPriority_[static_cast<size_t>(msg.priority)], node, ByPriority);
+    if (msg.correlationId != 0) {
+        auto it = byCorrelation_.find(msg.correlationId);
+        unlinkNode(it->second, node, ByCorrelation);
+        if (!it->second.head) {
+            byCorrelation_.erase(it);
+        }
+    }
+    
+    freeStashNodes_.push_back(node);
+    stashed_.fetch_sub(1, std::memory_order_relaxed);
+    return msg;
+}
+
+MessageQueue::StashNode* MessageQueue::findStashed(const MessageFilter& filter) {
+    StashNode* node = nullptr;
+    StashIndex index = ByArrival;
+    
+    if (filter.correlationId) {
+        auto it = byCorrelation_.find(*filter.correlationId);
+        node = (it != byCorrelation_.end()) ? it->second.head : nullptr;
+        index = ByCorrelation;
+    } else if (filter.sender) {
+        auto it = bySender_.find(*filter.sender);
+        node = (it != bySender_.end()) ? it->second.head : nullptr;
+        index = BySender;
+    } else if (filter.type) {
+        node = byType_[static_cast<size_t>(*filter.type)].head;
+        index = ByType;
+    } else {
+        node = arrival_.head;
+    }
+    
+    for (; node; node = node->links[index].next) {
+        if (filter.matches(*node->message)) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+void MessageQueue::linkNode(StashList& list, StashNode* node, StashIndex index) {
+    StashLinks& links = node->links[index];
+    links.prev = list.tail;
+    links.next = nullptr;
+    
+    if (list.tail) {
+        list.tail->links[index].next = node;
+    } else {
+        list.head = node;
+    }
+    list.tail = node;
+}
+
+void MessageQueue::unlinkNode(StashList& list, StashNode* node, StashIndex index) {
+    StashLinks& links = node->links[index];
+    
+    if (links.prev) {
+        links.prev->links[index].next = links.next;
+    } else {
+        list.head = links.next;
+    }
+    if (links.next) {
+        links.next->links[index].prev = links.prev;
+    } else {
+        list.tail = links.prev;
+    }
+    links.prev = links.next = nullptr;
+}
+
+void MessageQueue::close() {
+    closed_.store(true, std::memory_order_release);
+    callSlot_.close();
+    replySlot_.close();
+    {
+        std::lock_guard<std::mutex> lock(spaceMutex_);
+        spaceCondition_.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        waitCondition_.notify_all();
+    }
+    if (Notification* notification = bound_.load(std::memory_order_acquire)) {
+        notification->detach(this);
+    }
+    notifyObserver();
+}
+
+void MessageQueue::wakeWaiters() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(waitMutex_);
+        waitCondition_.notify_all();
+    }
+    notifyObserver();
+}
+
+void MessageQueue::setReadinessObserver(ReadinessObserver* observer) {
+    observer_.store(observer, std::memory_order_release);
+}
+
+bool MessageQueue::exchangeReadinessObserver(ReadinessObserver* expected, ReadinessObserver* observer) {
+    return observer_.compare_exchange_strong(expected, observer, std::memory_order_acq_rel);
+}
+
+// A queue accepts one notification for its lifetime, so receivers can read
+// bound_ without holding a reference.
+bool MessageQueue::bindNotification(std::shared_ptr<Notification> notification) {
+    std::lock_guard<std::mutex> lock(waitMutex_);
+    if (bound_.load(std::memory_order_relaxed) || isClosed() || !notification->attach(this)) {
+        return false;
+    }
+    boundOwner_ = std::move(notification);
+    bound_.store(boundOwner_.get(), std::memory_order_release);
+    return true;
+}
+
+std::optional<Message> MessageQueue::takeSignal() {
+    Notification* notification = bound_.load(std::memory_order_acquire);
+    if (!notification || notification->peek() == 0) {
+        return std::nullopt;
+    }
+    
+    uint64_t bits = notification->take();
+    if (bits == 0) {
+        return std::nullopt;
+    }
+    Message msg(0, owner_, owner_, MessageType::Signal);
+    msg.setData(bits);
+    return msg;
+}
+
+bool MessageQueue::hasSignal() const {
+    Notification* notification = bound_.load(std::memory_order_acquire);
+    return notification && notification->peek() != 0;
+}
+
+void MessageQueue::notifyObserver() {
+    if (!observer_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    EpochDomain::Guard guard;
+    if (ReadinessObserver* observer = observer_.load(std::memory_order_acquire)) {
+        observer->onReady();
+    }
+}
+
+size_t MessageQueue::size() const {
+    size_t total = stashed_.load(std::memory_order_relaxed);
+    for (const auto& ring : rings_) {
+        if (MessageRing* r = ring.load(std::memory_order_acquire)) {
+            total += r->size();
+        }
+    }
+    return total;
+}
+
+IPCManager::IPCManager()
+    : registeredCount_(0)
+    , memoryManager_(nullptr)
+    , nextMessageId_(1)
+    , totalMessagesSent_(0)
+    , totalMessagesReceived_(0)
+    , totalMessagesDropped_(0)
+    , directCalls_(0)
+    , queuedCalls_(0)
+    , nextTopicId_(1)
+    , nextSubscriptionId_(1)
+    , nextPortId_(1)
+    , remoteRouter_(nullptr)
+{
+    for (auto& chunk : registry_) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    LOG_INFO("IPC", "Initialized IPC Manager");
+}
+
+IPCManager::~IPCManager() {
+    for (auto& entry : registry_) {
+        RegistryChunk* chunk = entry.load(std::memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+        // Mailbox handles may still hold a reference past the registry's.
+        for (auto& slot : chunk->queues) {
+            MessageQueue* queue = slot.load(std::memory_order_acquire);
+            if (queue && queue->release()) {
+                delete queue;
+            }
+        }
+        delete chunk;
+    }
+}
+
+bool IPCManager::registerTask(TaskId taskId, const QueueLimits& limits) {
+    if (taskId >= MAX_IPC_TASKS) {
+        LOG_ERROR("IPC", "Task ID " + std::to_string(taskId) + " exceeds the IPC registry");
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    
+    auto& chunkSlot = registry_[taskId >> REGISTRY_CHUNK_BITS];
+    RegistryChunk* chunk = chunkSlot.load(std::memory_order_acquire);
+    if (!chunk) {
+        chunk = new RegistryChunk();
+        for (auto& slot : chunk->queues) {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+        chunkSlot.store(chunk, std::memory_order_release);
+    }
+    
+    auto& slot = chunk->queues[taskId & (REGISTRY_CHUNK_SIZE - 1)];
+    if (slot.load(std::memory_order_acquire)) {
+        LOG_WARN("IPC", "Task " + std::to_string(taskId) + " already registered");
+        return false;
+    }
+    
+    slot.store(new MessageQueue(taskId, limits), std::memory_order_release);
+    registeredCount_.fetch_add(1, std::memory_order_relaxed);
+    LOG_DEBUG("IPC", "Registered task " + std::to_string(taskId) + " for IPC");
+    return true;
+}
+
+bool IPCManager::unregisterTask(TaskId taskId) {
+    if (taskId >= MAX_IPC_TASKS) {
+        return false;
+    }
+    
+    std::shared_ptr<HandleTable> handles;
+    {
+        std::unique_lock<std::shared_mutex> lock(handleMutex_);
+        auto it = handleTables_.find(taskId);
+        if (it != handleTables_.end()) {
+            handles = std::move(it->second);
+            handleTables_.erase(it);
+        }
+    }
+    if (handles) {
+        for (auto& capability : handles->clear()) {
+            if (capability.waitSet) {
+                capability.waitSet->close();
+            } else if (capability.port && (capability.rights & RIGHT_RECEIVE)) {
+                capability.port->close();
+            }
+        }
+    }
+    
+    MessageQueue* queue;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        RegistryChunk* chunk = registry_[taskId >> REGISTRY_CHUNK_BITS].load(std::memory_order_acquire);
+        if (!chunk) {
+            return false;
+        }
+        queue = chunk->queues[taskId & (REGISTRY_CHUNK_SIZE - 1)].exchange(nullptr, std::memory_order_acq_rel);
+        if (!queue) {
+            return false;
+        }
+        registeredCount_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    queue->close();
+    EpochDomain::instance().retire([queue]() {
+        if (queue->release()) {
+            delete queue;
+        }
+    });
+    
+    failPendingCalls(taskId);
+    LOG_DEBUG("IPC", "Unregistered task " + std::to_string(taskId) + " from IPC");
+    return true;
+}
+
+MessageId IPCManager::sendMessage(TaskId sender, TaskId receiver,
+                                   const void* data, size_t size,
+                                   MessageType type, bool blocking,
+                                   MessageId correlationId,
+                                   std::optional<MessagePriority> priority) {
+    auto msg = prepareMessage(sender, receiver, data, size, type, correlationId, priority);
+    return msg ? sendPrepared(std::move(*msg), blocking) : 0;
+}
+
+MessageId IPCManager::sendMessage(TaskId sender, TaskId receiver,
+                                   const void* data, size_t size, Deadline deadline,
+                                   MessageType type, MessageId correlationId,
+                                   std::optional<MessagePriority> priority) {
+    auto msg = prepareMessage(sender, receiver, data, size, type, correlationId, priority);
+    return msg ? sendPrepared(std::move(*msg), true, deadline) : 0;
+}
+
+std::optional<Message> IPCManager::prepareMessage(TaskId sender, TaskId receiver,
+                                                  const void* data, size_t size,
+                                                  MessageType type, MessageId correlationId,
+                                                  std::optional<MessagePriority> priority) {
+    if (size > MAX_MESSAGE_SIZE) {
+        LOG_ERROR("IPC", "Payload of " + std::to_string(size) + " bytes exceeds " + 
+                  std::to_string(MAX_MESSAGE_SIZE) + "; use a shared region grant");
+        return std::nullopt;
+    }
+    
+    Message msg(0, sender, receiver, type);
+    msg.correlationId = correlationId;
+    if (priority) {
+        msg.priority = *priority;
+    }
+    
+    if (data && size > 0) {
+        msg.setPayload(data, size);
+    }
+    return msg;
+}
+
+MessageId IPCManager::sendPrepared(Message&& msg, bool blocking, Deadline deadline) {
+    TaskId sender = msg.senderId;
+    TaskId receiver = msg.receiverId;
+    QueueRef queue = referenceQueue(receiver);
+    if (!queue) {
+        return forwardRemote(std::move(msg), blocking);
+    }
+    
+    MessageId id = nextMessageId_.fetch_add(1, std::memory_order_relaxed);
+    msg.id = id;
+    msg.isBlocking = blocking;
+    size_t bytes = msg.payload.size();
+    
+    if (!queue->enqueue(std::move(msg)) && !waitToEnqueue(*queue, msg, blocking, deadline)) {
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordDrop(sender, receiver);
+        LOG_WARN("IPC", "Message queue full for task " + std::to_string(receiver));
+        return 0;
+    }
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+    channelStats_.recordSend(sender, receiver, 1, bytes, queue->depth());
+    
+    LOG_DEBUG("IPC", "Message " + std::to_string(id) + " sent from " + 
+              std::to_string(sender) + " to " + std::to_string(receiver));
+    
+    return id;
+}
+
+// Second chance for a message a full queue refused. Only a blocking send or
+// a Block queue waits, and never for a message that could not fit even in
+// an empty queue.
+bool IPCManager::waitToEnqueue(MessageQueue& queue, Message& msg, bool blocking, Deadline deadline) {
+    if (!blocking && queue.limits().policy != OverflowPolicy::Block) {
+        return false;
+    }
+    if (msg.payload.size() > queue.limits().maxBytes) {
+        LOG_WARN("IPC", "Message of " + std::to_string(msg.payload.size()) + " bytes can never fit " +
+                 "the queue of task " + std::to_string(queue.getOwner()));
+        return false;
+    }
+    
+    TaskId sender = msg.senderId;
+    bool sent = false;
+    blockWaiter(sender);
+    while (!sent && queue.waitForSpace(msg.payload.size(), deadline)) {
+        sent = queue.enqueue(std::move(msg));
+    }
+    wakeWaiter(sender);
+    return sent;
+}
+
+MessageId IPCManager::forwardRemote(Message&& msg, bool blocking) {
+    EpochDomain::Guard guard;
+    
+    TaskId sender = msg.senderId;
+    TaskId receiver = msg.receiverId;
+    RemoteRouter* router = remoteRouter_.load(std::memory_order_acquire);
+    if (!router || receiver < MAX_IPC_TASKS) {
+        LOG_ERROR("IPC", "Cannot send to unregistered task " + std::to_string(receiver));
+        return 0;
+    }
+    
+    MessageId id = nextMessageId_.fetch_add(1, std::memory_order_relaxed);
+    msg.id = id;
+    msg.isBlocking = blocking;
+    size_t bytes = msg.payload.size();
+    
+    if (!router->forward(msg)) {
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordDrop(sender, receiver);
+        return 0;
+    }
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+    channelStats_.recordSend(sender, receiver, 1, bytes, 0);
+    return id;
+}
+
+size_t IPCManager::deliverRemote(Message* messages, size_t count) {
+    EpochDomain::Guard guard;
+    
+    size_t delivered = 0;
+    while (delivered < count) {
+        TaskId sender = messages[delivered].senderId;
+        TaskId receiver = messages[delivered].receiverId;
+        uint64_t bytes = messages[delivered].payload.size();
+        size_t run = 1;
+        while (delivered + run < count && messages[delivered + run].receiverId == receiver &&
+               messages[delivered + run].senderId == sender) {
+            bytes += messages[delivered + run].payload.size();
+            run++;
+        }
+        
+        MessageQueue* queue = findQueue(receiver);
+        if (!queue) {
+            totalMessagesDropped_.fetch_add(run, std::memory_order_relaxed);
+            channelStats_.recordDrop(sender, receiver, run);
+            LOG_WARN("IPC", "Dropping remote messages for unregistered task " + std::to_string(receiver));
+            delivered += run;
+            continue;
+        }
+        
+        size_t accepted = queue->enqueueBatch(messages + delivered, run);
+        totalMessagesSent_.fetch_add(accepted, std::memory_order_relaxed);
+        for (size_t i = accepted; i < run; ++i) {
+            bytes -= messages[delivered + i].payload.size();
+        }
+        channelStats_.recordSend(sender, receiver, accepted, bytes, queue->depth());
+        delivered += accepted;
+        if (accepted < run) {
+            break;
+        }
+    }
+    return delivered;
+}
+
+size_t IPCManager::sendBatch(TaskId sender, TaskId receiver, const MessageSpec* specs, size_t count,
+                             MessageId* firstId) {
+    if (count == 0) {
+        return 0;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (specs[i].size > MAX_MESSAGE_SIZE) {
+            LOG_ERROR("IPC", "Batch entry " + std::to_string(i) + " exceeds " + 
+                      std::to_string(MAX_MESSAGE_SIZE) + " bytes");
+            return 0;
+        }
+    }
+    
+    EpochDomain::Guard guard;
+    
+    MessageQueue* queue = findQueue(receiver);
+    if (!queue) {
+        LOG_ERROR("IPC", "Cannot send to unregistered task " + std::to_string(receiver));
+        return 0;
+    }
+    
+    MessageId baseId = nextMessageId_.fetch_add(static_cast<MessageId>(count), std::memory_order_relaxed);
+    
+    static thread_local std::vector<Message> batch;
+    batch.clear();
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        batch.emplace_back(baseId + static_cast<MessageId>(i), sender, receiver, specs[i].type);
+        batch.back().correlationId = specs[i].correlationId;
+        if (specs[i].priority) {
+            batch.back().priority = *specs[i].priority;
+        }
+        if (specs[i].data && specs[i].size > 0) {
+            batch.back().setPayload(specs[i].data, specs[i].size);
+        }
+    }
+    
+    size_t sent = queue->enqueueBatch(batch.data(), batch.size());
+    batch.clear();
+    totalMessagesSent_.fetch_add(sent, std::memory_order_relaxed);
+    
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < sent; ++i) {
+        bytes += specs[i].data ? specs[i].size : 0;
+    }
+    channelStats_.recordSend(sender, receiver, sent, bytes, queue->depth());
+    if (sent < count) {
+        totalMessagesDropped_.fetch_add(count - sent, std::memory_order_relaxed);
+        channelStats_.recordDrop(sender, receiver, count - sent);
+        LOG_WARN("IPC", "Message queue full for task " + std::to_string(receiver) + ", sent " + 
+                 std::to_string(sent) + " of " + std::to_string(count));
+    }
+    
+    if (firstId) {
+        *firstId = sent > 0 ? baseId : 0;
+    }
+    
+    LOG_DEBUG("IPC", "Batch of " + std::to_string(sent) + " messages sent from " + 
+              std::to_string(sender) + " to " + std::to_string(receiver));
+    return sent;
+}
+
+size_t IPCManager::sendBatch(TaskId sender, TaskId receiver, const std::vector<MessageSpec>& specs,
+                             MessageId* firstId) {
+    return sendBatch(sender, receiver, specs.data(), specs.size(), firstId);
+}
+
+MessageId IPCManager::sendAsync(TaskId sender, TaskId receiver,
+                                 const void* data, size_t size, MessageType type) {
+    return sendMessage(sender, receiver, data, size, type, false);
+}
+
+std::optional<Message> IPCManager::receiveMessage(TaskId receiver, bool blocking) {
+    return receiveMessage(receiver, blocking ? NO_DEADLINE : Deadline::min());
+}
+
+std::optional<Message> IPCManager::receiveMessage(TaskId receiver, Deadline deadline) {
+    QueueRef queue = referenceQueue(receiver);
+    if (!queue) {
+        return std::nullopt;
+    }
+    
+    auto msg = queue->dequeue();
+    if (!msg) {
+        msg = queue->takeSignal();
+    }
+    if (!msg && deadline > std::chrono::steady_clock::now()) {
+        blockWaiter(receiver);
+        auto ready = [&]() { return queue->hasArrival() || queue->hasSignal(); };
+        while (!msg && queue->waitUntil(deadline, ready)) {
+            msg = queue->dequeue();
+            if (!msg) {
+                msg = queue->takeSignal();
+            }
+        }
+        wakeWaiter(receiver);
+        if (!msg) {
+            channelStats_.recordTimeout(ANY_SENDER, receiver);
+        }
+    }
+    
+    if (msg) {
+        totalMessagesReceived_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordReceive(msg->senderId, receiver, msg->timestamp);
+        LOG_DEBUG("IPC", "Message " + std::to_string(msg->id) + " received by " + 
+                  std::to_string(receiver));
+    }
+    
+    return msg;
+}
+
+std::optional<Message> IPCManager::receiveMessageFrom(TaskId receiver, TaskId sender, bool blocking) {
+    return receiveMessageFrom(receiver, sender, blocking ? NO_DEADLINE : Deadline::min());
+}
+
+std::optional<Message> IPCManager::receiveMessageFrom(TaskId receiver, TaskId sender, Deadline deadline) {
+    return receiveMatching(receiver, MessageFilter::fromSender(sender), deadline);
+}
+
+std::optional<Message> IPCManager::receiveMatching(TaskId receiver, const MessageFilter& filter,
+                                                   Deadline deadline) {
+    QueueRef queue = referenceQueue(receiver);
+    if (!queue) {
+        return std::nullopt;
+    }
+    
+    auto msg = queue->dequeueMatching(filter);
+    if (!msg && deadline > std::chrono::steady_clock::now()) {
+        blockWaiter(receiver);
+        while (!msg && queue->waitUntil(deadline, [&]() { return queue->hasArrival(); })) {
+            msg = queue->dequeueMatching(filter);
+        }
+        wakeWaiter(receiver);
+        if (!msg) {
+            channelStats_.recordTimeout(filter.sender.value_or(ANY_SENDER), receiver);
+        }
+    }
+    
+    if (msg) {
+        totalMessagesReceived_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordReceive(msg->senderId, receiver, msg->timestamp);
+    }
+    return msg;
+}
+
+size_t IPCManager::receiveBatch(TaskId receiver, size_t maxCount, std::vector<Message>& out,
+                                Deadline deadline) {
+    QueueRef queue = referenceQueue(receiver);
+    if (!queue || maxCount == 0) {
+        return 0;
+    }
+    
+    size_t received = queue->dequeueBatch(out, maxCount);
+    if (received == 0 && deadline > std::chrono::steady_clock::now()) {
+        blockWaiter(receiver);
+        while (received == 0 && queue->waitUntil(deadline, [&]() { return queue->hasArrival(); })) {
+            received = queue->dequeueBatch(out, maxCount);
+        }
+        wakeWaiter(receiver);
+        if (received == 0) {
+            channelStats_.recordTimeout(ANY_SENDER, receiver);
+        }
+    }
+    
+    totalMessagesReceived_.fetch_add(received, std::memory_order_relaxed);
+    if (received > 0) {
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = out.size() - received; i < out.size(); ++i) {
+            channelStats_.recordReceive(out[i].senderId, receiver, out[i].timestamp, now);
+        }
+    }
+    return received;
+}
+
+bool IPCManager::hasMessages(TaskId taskId) const {
+    EpochDomain::Guard guard;
+    MessageQueue* queue = findQueue(taskId);
+    return queue && !queue->isEmpty();
+}
+
+size_t IPCManager::getMessageCount(TaskId taskId) const {
+    EpochDomain::Guard guard;
+    MessageQueue* queue = findQueue(taskId);
+    return queue ? queue->size() : 0;
+}
+
+MessageId IPCManager::sendPageGrant(TaskId sender, TaskId receiver, RegionId region, GrantMode mode) {
+    if (!memoryManager_) {
+        LOG_ERROR("IPC", "Page grants require an attached memory manager");
+        return 0;
+    }
+    
+    const SharedRegion* shared = memoryManager_->getSharedRegion(region);
+    if (!shared) {
+        LOG_ERROR("IPC", "Cannot grant unknown region " + std::to_string(region));
+        return 0;
+    }
+    
+    bool isOwner = shared->owner == sender;
+    if (mode == GrantMode::Transfer ? !isOwner : !(isOwner || shared->mappings.count(sender))) {
+        LOG_ERROR("IPC", "Task " + std::to_string(sender) + " may not grant region " + 
+                  std::to_string(region));
+        return 0;
+    }
+    
+    if (!memoryManager_->pinRegion(region)) {
+        return 0;
+    }
+    
+    PageGrant grant{region, mode, static_cast<uint32_t>(shared->pageCount)};
+    MessageId id = sendMessage(sender, receiver, &grant, sizeof(grant), MessageType::Grant);
+    if (id == 0) {
+        memoryManager_->unpinRegion(region);
+        return 0;
+    }
+    
+    if (mode == GrantMode::Transfer) {
+        memoryManager_->unmapSharedRegion(region, sender);
+    }
+    
+    return id;
+}
+
+bool IPCManager::acceptPageGrant(TaskId receiver, const Message& grant, PageNumber baseVirtualPage,
+                                 MemoryProtection protection) {
+    if (!memoryManager_ || grant.type != MessageType::Grant || grant.receiverId != receiver) {
+        return false;
+    }
+    
+    auto descriptor = grant.getData<PageGrant>();
+    if (!descriptor) {
+        return false;
+    }
+    
+    if (!memoryManager_->mapSharedRegion(descriptor->region, receiver, baseVirtualPage, protection)) {
+        return false;
+    }
+    
+    if (descriptor->mode == GrantMode::Transfer) {
+        memoryManager_->transferRegion(descriptor->region, grant.senderId, receiver);
+    }
+    
+    memoryManager_->unpinRegion(descriptor->region);
+    return true;
+}
+
+bool IPCManager::releasePageGrant(const Message& grant) {
+    if (!memoryManager_ || grant.type != MessageType::Grant) {
+        return false;
+    }
+    
+    auto descriptor = grant.getData<PageGrant>();
+    return descriptor && memoryManager_->unpinRegion(descriptor->region);
+}
+
+std::optional<Message> IPCManager::sendAndWaitReply(TaskId sender, TaskId receiver,
+                                                     const void* data, size_t size,
+                                                     std::chrono::milliseconds timeout) {
+    Deadline deadline = std::chrono::steady_clock::now() + timeout;
+    MessageId msgId = sendMessage(sender, receiver, data, size, deadline, MessageType::Request);
+    if (msgId == 0) {
+        return std::nullopt;
+    }
+    
+    MessageFilter filter{receiver, MessageType::Response, std::nullopt};
+    if (auto reply = receiveMatching(sender, filter, deadline)) {
+        return reply;
+    }
+    
+    LOG_WARN("IPC", "Timeout waiting for reply from " + std::to_string(receiver));
+    return std::nullopt;
+}
+
+std::optional<Message> IPCManager::call(TaskId client, TaskId server, const void* data, size_t size,
+                                        Deadline deadline) {
+    QueueRef clientQueue = referenceQueue(client);
+    QueueRef serverQueue = referenceQueue(server);
+    if (!clientQueue || !serverQueue) {
+        LOG_ERROR("IPC", "Cannot call from task " + std::to_string(client) + " to task " + 
+                  std::to_string(server) + ": not registered");
+        return std::nullopt;
+    }
+    
+    Message request(nextMessageId_.fetch_add(1, std::memory_order_relaxed), client, server, 
+                    MessageType::Request);
+    request.correlationId = request.id;
+    request.isBlocking = true;
+    if (!request.setPayload(data, size)) {
+        LOG_ERROR("IPC", "Call payload of " + std::to_string(size) + " bytes exceeds " + 
+                  std::to_string(MAX_MESSAGE_SIZE));
+        return std::nullopt;
+    }
+    MessageId callId = request.id;
+    
+    Rendezvous& replySlot = clientQueue->replySlot();
+    if (!replySlot.arm()) {
+        replySlot.tryTake();
+        replySlot.arm();
+    }
+    
+    if (serverQueue->callSlot().deliver(request)) {
+        directCalls_.fetch_add(1, std::memory_order_relaxed);
+        if (onHandoff_) {
+            onHandoff_(client, server, true);
+        }
+    } else if (serverQueue->enqueue(std::move(request))) {
+        queuedCalls_.fetch_add(1, std::memory_order_relaxed);
+        blockWaiter(client);
+    } else {
+        replySlot.disarm();
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordDrop(client, server);
+        LOG_WARN("IPC", "Call to task " + std::to_string(server) + " dropped: queue full");
+        return std::nullopt;
+    }
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+    channelStats_.recordSend(client, server, 1, size, serverQueue->depth());
+    
+    // A reply that found the slot busy was left in the mailbox, and reply()
+    // then woke the slot, so every re-arm is followed by a mailbox check.
+    MessageFilter isReply{server, MessageType::Response, callId};
+    std::optional<Message> response;
+    while (!response) {
+        response = replySlot.take(deadline);
+        if (!response) {
+            break;
+        }
+        if (response->correlationId != callId) {
+            response.reset();
+            if (replySlot.arm()) {
+                response = clientQueue->dequeueMatching(isReply);
+                if (response) {
+                    replySlot.disarm();
+                }
+            }
+        }
+    }
+    
+    wakeWaiter(client);
+    if (response) {
+        totalMessagesReceived_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordReceive(server, client, response->timestamp);
+        return response;
+    }
+    channelStats_.recordTimeout(server, client);
+    LOG_WARN("IPC", "Timeout waiting for reply from " + std::to_string(server));
+    return std::nullopt;
 }
 
-void MessageQueue::enqueue(Message msg) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    messages_.push(std::move(msg));
+std::optional<Message> IPCManager::receiveCall(TaskId server, Deadline deadline) {
+    QueueRef queue = referenceQueue(server);
+    if (!queue) {
+        return std::nullopt;
+    }
+    
+    Rendezvous& callSlot = queue->callSlot();
+    MessageFilter isRequest = MessageFilter::ofType(MessageType::Request);
+    
+    auto request = callSlot.tryTake();
+    if (!request) {
+        request = queue->dequeueMatching(isRequest);
+    }
+    if (!request && callSlot.arm()) {
+        request = queue->dequeueMatching(isRequest);
+        if (request) {
+            callSlot.disarm();
+        } else {
+            blockWaiter(server);
+            request = callSlot.take(deadline);
+            if (!request) {
+                wakeWaiter(server);
+                channelStats_.recordTimeout(ANY_SENDER, server);
+            }
+        }
+    }
+    
+    if (request) {
+        totalMessagesReceived_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordReceive(request->senderId, server, request->timestamp);
+    }
+    return request;
 }
 
-std::optional<Message> MessageQueue::dequeue() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (messages_.empty()) {
-        return std::nullopt;
+bool IPCManager::reply(TaskId server, const Message& request, const void* data, size_t size) {
+    TaskId client = request.senderId;
+    EpochDomain::Guard guard;
+    auto clientQueue = findQueue(client);
+    if (!clientQueue) {
+        LOG_ERROR("IPC", "Cannot reply to unregistered task " + std::to_string(client));
+        return false;
     }
     
-    Message msg = std::move(messages_.front());
-    messages_.pop();
-    return msg;
+    Message response(nextMessageId_.fetch_add(1, std::memory_order_relaxed), server, client, 
+                     MessageType::Response);
+    response.correlationId = request.id;
+    if (!response.setPayload(data, size)) {
+        return false;
+    }
+    
+    if (completeCall(request.id, server, response)) {
+        totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    if (clientQueue->replySlot().deliver(response)) {
+        totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordSend(server, client, 1, size, 0);
+        if (onHandoff_) {
+            onHandoff_(server, client, false);
+        }
+        return true;
+    }
+    
+    if (!clientQueue->enqueue(std::move(response))) {
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordDrop(server, client);
+        return false;
+    }
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+    channelStats_.recordSend(server, client, 1, size, clientQueue->depth());
+    
+    // The client may have re-armed after the failed delivery and already
+    // checked its mailbox; an empty response wakes it to look again.
+    Message wakeup(0, server, client, MessageType::Response);
+    clientQueue->replySlot().deliver(wakeup);
+    return true;
 }
 
-std::optional<Message> MessageQueue::peek() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (messages_.empty()) {
+std::optional<Message> IPCManager::replyWait(TaskId server, const Message& request,
+                                             const void* data, size_t size, Deadline deadline) {
+    if (!reply(server, request, data, size)) {
+        LOG_WARN("IPC", "Reply from task " + std::to_string(server) + " to task " + 
+                 std::to_string(request.senderId) + " failed");
         return std::nullopt;
     }
-    return messages_.front();
+    return receiveCall(server, deadline);
 }
 
-IPCManager::IPCManager()
-    : nextMessageId_(1)
-    , totalMessagesSent_(0)
-    , totalMessagesReceived_(0)
-{
-    LOG_INFO("IPC", "Initialized IPC Manager");
+SendWindow IPCManager::getSendWindow(TaskId receiver) const {
+    EpochDomain::Guard guard;
+    MessageQueue* queue = findQueue(receiver);
+    return queue ? queue->window() : SendWindow{0, 0};
 }
 
-bool IPCManager::registerTask(TaskId taskId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool IPCManager::waitForSpace(TaskId receiver, size_t bytes, Deadline deadline) {
+    QueueRef queue = referenceQueue(receiver);
+    return queue && queue->waitForSpace(bytes, deadline);
+}
+
+ReplyFuture IPCManager::callAsync(TaskId client, TaskId server, const void* data, size_t size,
+                                  MessageId* requestId) {
+    Message request(nextMessageId_.fetch_add(1, std::memory_order_relaxed), client, server, 
+                    MessageType::Request);
+    request.correlationId = request.id;
+    MessageId callId = request.id;
+    if (requestId) {
+        *requestId = callId;
+    }
     
-    if (messageQueues_.find(taskId) != messageQueues_.end()) {
-        LOG_WARN("IPC", "Task " + std::to_string(taskId) + " already registered");
-        return false;
+    std::promise<std::optional<Message>> failed;
+    EpochDomain::Guard guard;
+    auto queue = findQueue(server);
+    if (!queue || !findQueue(client) || !request.setPayload(data, size)) {
+        LOG_ERROR("IPC", "Cannot issue async call from task " + std::to_string(client) + 
+                  " to task " + std::to_string(server));
+        failed.set_value(std::nullopt);
+        return failed.get_future();
     }
     
-    messageQueues_[taskId] = std::make_unique<MessageQueue>(taskId);
-    LOG_DEBUG("IPC", "Registered task " + std::to_string(taskId) + " for IPC");
-    return true;
+    ReplyFuture future;
+    {
+        PendingShard& shard = pendingShard(callId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& pending = shard.calls[callId];
+        pending.client = client;
+        pending.server = server;
+        future = pending.promise.get_future();
+    }
+    
+    if (!queue->callSlot().deliver(request) && !queue->enqueue(std::move(request))) {
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordDrop(client, server);
+        completeCall(callId, server, std::nullopt);
+        LOG_WARN("IPC", "Async call to task " + std::to_string(server) + " dropped: queue full");
+        return future;
+    }
+    
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+    channelStats_.recordSend(client, server, 1, size, queue->depth());
+    return future;
 }
 
-bool IPCManager::unregisterTask(TaskId taskId) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool IPCManager::replyTo(TaskId server, MessageId requestId, const void* data, size_t size) {
+    Message response(nextMessageId_.fetch_add(1, std::memory_order_relaxed), server, 
+                     INVALID_TASK_ID, MessageType::Response);
+    response.correlationId = requestId;
+    if (!response.setPayload(data, size)) {
+        return false;
+    }
     
-    auto it = messageQueues_.find(taskId);
-    if (it == messageQueues_.end()) {
+    if (!completeCall(requestId, server, std::move(response))) {
+        LOG_WARN("IPC", "No pending call " + std::to_string(requestId) + " for task " + 
+                 std::to_string(server));
         return false;
     }
     
-    messageQueues_.erase(it);
-    LOG_DEBUG("IPC", "Unregistered task " + std::to_string(taskId) + " from IPC");
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
     return true;
 }
 
-MessageId IPCManager::sendMessage(TaskId sender, TaskId receiver,
-                                   const void* data, size_t size,
-                                   MessageType type, bool blocking) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool IPCManager::cancelCall(MessageId requestId) {
+    return completeCall(requestId, INVALID_TASK_ID, std::nullopt);
+}
+
+size_t IPCManager::getPendingCallCount() const {
+    size_t total = 0;
+    for (const auto& shard : pendingCalls_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.calls.size();
+    }
+    return total;
+}
+
+// Fulfils and forgets a pending call. A reply must come from the server the
+// call was addressed to; INVALID_TASK_ID skips that check for cancellation.
+bool IPCManager::completeCall(MessageId requestId, TaskId server, std::optional<Message> result) {
+    std::promise<std::optional<Message>> promise;
+    {
+        PendingShard& shard = pendingShard(requestId);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        auto it = shard.calls.find(requestId);
+        if (it == shard.calls.end()) {
+            return false;
+        }
+        if (server != INVALID_TASK_ID && it->second.server != server) {
+            return false;
+        }
+        
+        if (result) {
+            result->receiverId = it->second.client;
+        }
+        promise = std::move(it->second.promise);
+        shard.calls.erase(it);
+    }
     
-    auto it = messageQueues_.find(receiver);
-    if (it == messageQueues_.end()) {
-        LOG_ERROR("IPC", "Cannot send to unregistered task " + std::to_string(receiver));
-        return 0;
+    // The reply goes straight to the caller's future, so it is sent and
+    // received in one step.
+    if (result) {
+        totalMessagesReceived_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordSend(result->senderId, result->receiverId, 1, result->payload.size(), 0);
+        channelStats_.recordReceive(result->senderId, result->receiverId, result->timestamp);
     }
+    promise.set_value(std::move(result));
+    return true;
+}
+
+void IPCManager::failPendingCalls(TaskId taskId) {
+    std::vector<std::promise<std::optional<Message>>> abandoned;
     
-    MessageId id = nextMessageId_++;
-    Message msg(id, sender, receiver, type);
-    msg.isBlocking = blocking;
+    for (auto& shard : pendingCalls_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.calls.begin(); it != shard.calls.end();) {
+            if (it->second.client == taskId || it->second.server == taskId) {
+                abandoned.push_back(std::move(it->second.promise));
+                it = shard.calls.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
     
-    if (data && size > 0) {
-        msg.setPayload(data, size);
+    for (auto& promise : abandoned) {
+        promise.set_value(std::nullopt);
+    }
+}
+
+// Runs fn against a capability while the handle tables are read-locked, so
+// hot paths such as signal() avoid copying the table and its references.
+template<typename Fn>
+bool IPCManager::withCapability(TaskId task, Handle handle, uint32_t rights, Fn&& fn) const {
+    std::shared_lock<std::shared_mutex> lock(handleMutex_);
+    auto it = handleTables_.find(task);
+    return it != handleTables_.end() && it->second->visit(handle, rights, std::forward<Fn>(fn));
+}
+
+Handle IPCManager::createPort(TaskId owner, const QueueLimits& limits) {
+    PortId id = nextPortId_.fetch_add(1, std::memory_order_relaxed);
+    auto port = std::make_shared<Port>(id, owner, limits);
+    Handle handle = handleTable(owner, true)->insert(
+        {CapabilityKind::Port, RIGHT_SEND | RIGHT_RECEIVE | RIGHT_GRANT, port, nullptr, nullptr});
+    
+    LOG_DEBUG("IPC", "Created port " + std::to_string(id) + " for task " + std::to_string(owner));
+    return handle;
+}
+
+Handle IPCManager::grantHandle(TaskId from, Handle handle, TaskId to, uint32_t rights) {
+    auto source = handleTable(from);
+    auto capability = source ? source->lookup(handle, RIGHT_GRANT) : std::nullopt;
+    if (!capability || capability->kind == CapabilityKind::WaitSet) {
+        LOG_WARN("IPC", "Task " + std::to_string(from) + " cannot grant handle " + std::to_string(handle));
+        return INVALID_HANDLE;
     }
     
-    it->second->enqueue(std::move(msg));
-    totalMessagesSent_++;
+    uint32_t granted = rights & capability->rights & ~RIGHT_RECEIVE;
+    if (granted == 0) {
+        LOG_WARN("IPC", "Grant of handle " + std::to_string(handle) + " carries no transferable rights");
+        return INVALID_HANDLE;
+    }
     
-    LOG_DEBUG("IPC", "Message " + std::to_string(id) + " sent from " + 
-              std::to_string(sender) + " to " + std::to_string(receiver));
+    capability->rights = granted;
+    return handleTable(to, true)->insert(*capability);
+}
+
+bool IPCManager::closeHandle(TaskId task, Handle handle) {
+    auto table = handleTable(task);
+    auto capability = table ? table->remove(handle) : std::nullopt;
+    if (!capability) {
+        return false;
+    }
     
-    return id;
+    if (capability->waitSet) {
+        capability->waitSet->close();
+    } else if (capability->port && (capability->rights & RIGHT_RECEIVE)) {
+        capability->port->close();
+    }
+    return true;
 }
 
-MessageId IPCManager::sendAsync(TaskId sender, TaskId receiver,
-                                 const void* data, size_t size, MessageType type) {
-    return sendMessage(sender, receiver, data, size, type, false);
+MessageId IPCManager::sendToPort(TaskId sender, Handle port, const void* data, size_t size,
+                                 MessageType type) {
+    if (size > MAX_MESSAGE_SIZE) {
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    
+    // The handle table stays locked inside the visitor, so a send that has
+    // to wait for room takes the port out and waits after it returns.
+    MessageId id = 0;
+    std::shared_ptr<Port> full;
+    std::optional<Message> refused;
+    bool permitted = withCapability(sender, port, RIGHT_SEND, [&](const Capability& capability) {
+        if (capability.kind != CapabilityKind::Port) {
+            return false;
+        }
+        
+        MessageQueue& queue = capability.port->queue();
+        Message msg(nextMessageId_.fetch_add(1, std::memory_order_relaxed), sender, 
+                    capability.port->getOwner(), type);
+        if (data && size > 0) {
+            msg.setPayload(data, size);
+        }
+        MessageId candidate = msg.id;
+        if (!queue.isClosed() && queue.enqueue(std::move(msg))) {
+            id = candidate;
+            channelStats_.recordSend(sender, capability.port->getOwner(), 1, size, queue.depth());
+        } else if (!queue.isClosed() && queue.limits().policy == OverflowPolicy::Block) {
+            full = capability.port;
+            refused = std::move(msg);
+        } else {
+            channelStats_.recordDrop(sender, capability.port->getOwner());
+        }
+        return true;
+    });
+    
+    if (!permitted) {
+        LOG_WARN("IPC", "Task " + std::to_string(sender) + " holds no send right for handle " + 
+                 std::to_string(port));
+        return 0;
+    }
+    if (full) {
+        MessageId candidate = refused->id;
+        MessageQueue& queue = full->queue();
+        if (waitToEnqueue(queue, *refused, false, NO_DEADLINE)) {
+            id = candidate;
+            channelStats_.recordSend(sender, full->getOwner(), 1, size, queue.depth());
+        } else {
+            channelStats_.recordDrop(sender, full->getOwner());
+        }
+    }
+    if (id == 0) {
+        totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+    totalMessagesSent_.fetch_add(1, std::memory_order_relaxed);
+    return id;
 }
 
-std::optional<Message> IPCManager::receiveMessage(TaskId receiver, bool blocking) {
-    auto it = messageQueues_.find(receiver);
-    if (it == messageQueues_.end()) {
+std::optional<Message> IPCManager::receiveFromPort(TaskId owner, Handle port, Deadline deadline) {
+    auto table = handleTable(owner);
+    auto capability = table ? table->lookup(port, RIGHT_RECEIVE) : std::nullopt;
+    if (!capability || capability->kind != CapabilityKind::Port) {
         return std::nullopt;
     }
     
-    auto msg = it->second->dequeue();
-    if (msg) {
-        totalMessagesReceived_++;
-        LOG_DEBUG("IPC", "Message " + std::to_string(msg->id) + " received by " + 
-                  std::to_string(receiver));
+    MessageQueue& queue = capability->port->queue();
+    auto msg = queue.dequeue();
+    if (!msg && deadline > std::chrono::steady_clock::now()) {
+        blockWaiter(owner);
+        while (!msg && queue.waitUntil(deadline, [&]() { return queue.hasArrival(); })) {
+            msg = queue.dequeue();
+        }
+        wakeWaiter(owner);
+        if (!msg) {
+            channelStats_.recordTimeout(ANY_SENDER, owner);
+        }
     }
     
+    if (msg) {
+        totalMessagesReceived_.fetch_add(1, std::memory_order_relaxed);
+        channelStats_.recordReceive(msg->senderId, owner, msg->timestamp);
+    }
     return msg;
 }
 
-std::optional<Message> IPCManager::receiveMessageFrom(TaskId receiver, TaskId sender, bool blocking) {
-    auto it = messageQueues_.find(receiver);
-    if (it == messageQueues_.end()) {
-        return std::nullopt;
+Handle IPCManager::createNotification(TaskId owner) {
+    return handleTable(owner, true)->insert({CapabilityKind::Notification, 
+                                             RIGHT_SEND | RIGHT_RECEIVE | RIGHT_GRANT,
+                                             nullptr, nullptr, std::make_shared<Notification>()});
+}
+
+bool IPCManager::signal(TaskId sender, Handle notification, uint64_t bits) {
+    bool delivered = withCapability(sender, notification, RIGHT_SEND, [bits](const Capability& capability) {
+        if (capability.kind != CapabilityKind::Notification) {
+            return false;
+        }
+        capability.notification->signal(bits);
+        return true;
+    });
+    if (!delivered) {
+        LOG_WARN("IPC", "Task " + std::to_string(sender) + " holds no send right for notification " + 
+                 std::to_string(notification));
+    }
+    return delivered;
+}
+
+uint64_t IPCManager::waitNotification(TaskId owner, Handle notification, Deadline deadline) {
+    uint64_t bits = 0;
+    bool valid = withCapability(owner, notification, RIGHT_RECEIVE, [&bits](const Capability& capability) {
+        if (capability.kind != CapabilityKind::Notification) {
+            return false;
+        }
+        bits = capability.notification->take();
+        return true;
+    });
+    if (!valid || bits != 0 || deadline <= std::chrono::steady_clock::now()) {
+        return bits;
     }
     
-    auto msg = it->second->peek();
-    if (msg && msg->senderId == sender) {
-        return it->second->dequeue();
+    // The task may have unregistered, dropping its table, since the check above.
+    auto table = handleTable(owner);
+    auto capability = table ? table->lookup(notification, RIGHT_RECEIVE) : std::nullopt;
+    if (!capability || capability->kind != CapabilityKind::Notification) {
+        return 0;
+    }
+    blockWaiter(owner);
+    bits = capability->notification->wait(deadline);
+    wakeWaiter(owner);
+    return bits;
+}
+
+bool IPCManager::bindNotification(TaskId task, Handle notification) {
+    auto table = handleTable(task);
+    auto capability = table ? table->lookup(notification, RIGHT_RECEIVE) : std::nullopt;
+    if (!capability || capability->kind != CapabilityKind::Notification) {
+        return false;
     }
     
-    return std::nullopt;
+    EpochDomain::Guard guard;
+    MessageQueue* queue = findQueue(task);
+    if (!queue || !queue->bindNotification(capability->notification)) {
+        LOG_WARN("IPC", "Cannot bind notification " + std::to_string(notification) + " to task " +
+                 std::to_string(task) + ": already bound or watched too often");
+        return false;
+    }
+    return true;
 }
 
-bool IPCManager::hasMessages(TaskId taskId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = messageQueues_.find(taskId);
-    if (it == messageQueues_.end()) {
+Handle IPCManager::openMailbox(TaskId task) {
+    std::shared_ptr<Mailbox> mailbox;
+    {
+        EpochDomain::Guard guard;
+        MessageQueue* queue = findQueue(task);
+        if (!queue) {
+            LOG_WARN("IPC", "Cannot open mailbox of unregistered task " + std::to_string(task));
+            return INVALID_HANDLE;
+        }
+        mailbox = std::make_shared<Mailbox>(queue);
+    }
+    return handleTable(task, true)->insert(
+        {CapabilityKind::Mailbox, RIGHT_RECEIVE, nullptr, nullptr, nullptr, mailbox});
+}
+
+Handle IPCManager::createWaitSet(TaskId owner) {
+    // Members hold a raw back-pointer that producers may still be following,
+    // so the set itself is reclaimed through the epoch domain as well.
+    std::shared_ptr<WaitSet> waitSet(new WaitSet(), [](WaitSet* set) {
+        set->close();
+        EpochDomain::instance().retire([set]() { delete set; });
+    });
+    return handleTable(owner, true)->insert(
+        {CapabilityKind::WaitSet, RIGHT_RECEIVE, nullptr, waitSet, nullptr});
+}
+
+bool IPCManager::waitSetAdd(TaskId owner, Handle waitSet, Handle source, uint64_t cookie) {
+    auto table = handleTable(owner);
+    if (!table) {
+        return false;
+    }
+    
+    auto set = table->lookup(waitSet, RIGHT_RECEIVE);
+    auto watched = table->lookup(source, RIGHT_RECEIVE);
+    if (!set || set->kind != CapabilityKind::WaitSet || !watched || !watched->source()) {
+        LOG_WARN("IPC", "Task " + std::to_string(owner) + " cannot watch handle " + std::to_string(source));
+        return false;
+    }
+    if (!set->waitSet->add(source, watched->source(), cookie)) {
+        LOG_WARN("IPC", "Task " + std::to_string(owner) + " cannot add handle " + std::to_string(source) +
+                 " to wait set " + std::to_string(waitSet) + ": already a member or watched too often");
         return false;
     }
-    return !it->second->isEmpty();
+    return true;
 }
 
-size_t IPCManager::getMessageCount(TaskId taskId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = messageQueues_.find(taskId);
-    if (it == messageQueues_.end()) {
+bool IPCManager::waitSetRemove(TaskId owner, Handle waitSet, Handle source) {
+    auto table = handleTable(owner);
+    auto set = table ? table->lookup(waitSet, RIGHT_RECEIVE) : std::nullopt;
+    if (!set || set->kind != CapabilityKind::WaitSet) {
+        return false;
+    }
+    return set->waitSet->remove(source);
+}
+
+size_t IPCManager::waitForEvents(TaskId owner, Handle waitSet, std::vector<WaitEvent>& events,
+                                 size_t maxEvents, Deadline deadline) {
+    auto table = handleTable(owner);
+    auto set = table ? table->lookup(waitSet, RIGHT_RECEIVE) : std::nullopt;
+    if (!set || set->kind != CapabilityKind::WaitSet || maxEvents == 0) {
         return 0;
     }
-    return it->second->size();
+    
+    size_t count = set->waitSet->wait(events, maxEvents, Deadline::min());
+    if (count == 0 && deadline > std::chrono::steady_clock::now()) {
+        blockWaiter(owner);
+        count = set->waitSet->wait(events, maxEvents, deadline);
+        wakeWaiter(owner);
+    }
+    return count;
 }
 
-std::optional<Message> IPCManager::sendAndWaitReply(TaskId sender, TaskId receiver,
-                                                     const void* data, size_t size,
-                                                     std::chrono::milliseconds timeout) {
-    MessageId msgId = sendMessage(sender, receiver, data, size, MessageType::Request, true);
-    if (msgId == 0) {
-        return std::nullopt;
+std::shared_ptr<HandleTable> IPCManager::handleTable(TaskId task, bool create) {
+    {
+        std::shared_lock<std::shared_mutex> lock(handleMutex_);
+        auto it = handleTables_.find(task);
+        if (it != handleTables_.end() || !create) {
+            return it != handleTables_.end() ? it->second : nullptr;
+        }
     }
     
-    auto startTime = std::chrono::steady_clock::now();
+    std::unique_lock<std::shared_mutex> lock(handleMutex_);
+    auto& table = handleTables_[task];
+    if (!table) {
+        table = std::make_shared<HandleTable>();
+    }
+    return table;
+}
+
+TopicId IPCManager::createTopic(const std::string& name) {
+    std::unique_lock<std::shared_mutex> lock(topicMutex_);
     
-    while (std::chrono::steady_clock::now() - startTime < timeout) {
-        auto reply = receiveMessageFrom(sender, receiver, false);
-        if (reply && reply->type == MessageType::Response) {
-            return reply;
+    for (const auto& [id, topic] : topics_) {
+        if (topic->name == name) {
+            LOG_WARN("IPC", "Topic '" + name + "' already exists");
+            return INVALID_TOPIC_ID;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
     
-    LOG_WARN("IPC", "Timeout waiting for reply from " + std::to_string(receiver));
-    return std::nullopt;
+    TopicId id = nextTopicId_++;
+    topics_[id] = std::make_unique<Topic>(id, name);
+    LOG_DEBUG("IPC", "Created topic '" + name + "' with ID " + std::to_string(id));
+    return id;
+}
+
+bool IPCManager::destroyTopic(TopicId topic) {
+    std::unique_lock<std::shared_mutex> lock(topicMutex_);
+    return topics_.erase(topic) > 0;
+}
+
+TopicId IPCManager::findTopic(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(topicMutex_);
+    for (const auto& [id, topic] : topics_) {
+        if (topic->name == name) {
+            return id;
+        }
+    }
+    return INVALID_TOPIC_ID;
+}
+
+SubscriptionId IPCManager::subscribe(TopicId topic, TaskId subscriber, TopicFilter filter) {
+    std::unique_lock<std::shared_mutex> lock(topicMutex_);
+    
+    auto it = topics_.find(topic);
+    if (it == topics_.end()) {
+        LOG_ERROR("IPC", "Cannot subscribe to unknown topic " + std::to_string(topic));
+        return 0;
+    }
+    
+    SubscriptionId id = nextSubscriptionId_++;
+    it->second->subscriptions.push_back({id, subscriber, std::move(filter)});
+    return id;
+}
+
+bool IPCManager::unsubscribe(TopicId topic, SubscriptionId subscription) {
+    std::unique_lock<std::shared_mutex> lock(topicMutex_);
+    
+    auto it = topics_.find(topic);
+    if (it == topics_.end()) {
+        return false;
+    }
+    
+    auto& subs = it->second->subscriptions;
+    auto subIt = std::find_if(subs.begin(), subs.end(), 
+                              [subscription](const Subscription& s) { return s.id == subscription; });
+    if (subIt == subs.end()) {
+        return false;
+    }
+    
+    subs.erase(subIt);
+    return true;
+}
+
+size_t IPCManager::getSubscriberCount(TopicId topic) const {
+    std::shared_lock<std::shared_mutex> lock(topicMutex_);
+    auto it = topics_.find(topic);
+    return (it != topics_.end()) ? it->second->subscriptions.size() : 0;
+}
+
+size_t IPCManager::publish(TopicId topic, TaskId publisher, const void* data, size_t size,
+                           MessageType type) {
+    if (size > MAX_MESSAGE_SIZE) {
+        LOG_ERROR("IPC", "Publish payload of " + std::to_string(size) + " bytes exceeds " + 
+                  std::to_string(MAX_MESSAGE_SIZE));
+        return 0;
+    }
+    
+    std::shared_lock<std::shared_mutex> topicLock(topicMutex_);
+    
+    auto topicIt = topics_.find(topic);
+    if (topicIt == topics_.end()) {
+        LOG_ERROR("IPC", "Cannot publish to unknown topic " + std::to_string(topic));
+        return 0;
+    }
+    
+    const auto& subs = topicIt->second->subscriptions;
+    if (subs.empty()) {
+        return 0;
+    }
+    
+    Message prototype(0, publisher, INVALID_TASK_ID, type);
+    SharedPayload* shared = nullptr;
+    uint32_t sharedRefs = static_cast<uint32_t>(subs.size());
+    if (size > INLINE_PAYLOAD_SIZE) {
+        shared = SharedPayload::create(data, size);
+        shared->retain(sharedRefs);
+        prototype.payload.adoptShared(shared);
+    } else if (data && size > 0) {
+        prototype.setPayload(data, size);
+    }
+    
+    MessageId baseId = nextMessageId_.fetch_add(static_cast<MessageId>(subs.size()), 
+                                                std::memory_order_relaxed);
+    size_t delivered = 0;
+    
+    EpochDomain::Guard guard;
+    
+    for (size_t i = 0; i < subs.size(); ++i) {
+        const Subscription& sub = subs[i];
+        if (sub.filter && !sub.filter(prototype)) {
+            continue;
+        }
+        
+        MessageQueue* queue = findQueue(sub.subscriber);
+        if (!queue) {
+            continue;
+        }
+        
+        Message msg(baseId + static_cast<MessageId>(i), publisher, sub.subscriber, type);
+        if (shared) {
+            msg.payload.adoptShared(shared);
+            sharedRefs--;
+        } else {
+            msg.payload = prototype.payload;
+        }
+        
+        if (queue->enqueue(std::move(msg))) {
+            delivered++;
+            channelStats_.recordSend(publisher, sub.subscriber, 1, size, queue->depth());
+        } else {
+            totalMessagesDropped_.fetch_add(1, std::memory_order_relaxed);
+            channelStats_.recordDrop(publisher, sub.subscriber);
+        }
+    }
+    
+    if (shared && sharedRefs > 0) {
+        shared->release(sharedRefs);
+    }
+    
+    totalMessagesSent_.fetch_add(delivered, std::memory_order_relaxed);
+    
+    topicIt->second->publishCount.fetch_add(1, std::memory_order_relaxed);
+    return delivered;
+}
+
+void IPCManager::setBlockingHooks(TaskStateHook onBlock, TaskStateHook onWake) {
+    onBlock_ = std::move(onBlock);
+    onWake_ = std::move(onWake);
+}
+
+MessageQueue* IPCManager::findQueue(TaskId taskId) const {
+    if (taskId >= MAX_IPC_TASKS) {
+        return nullptr;
+    }
+    RegistryChunk* chunk = registry_[taskId >> REGISTRY_CHUNK_BITS].load(std::memory_order_acquire);
+    if (!chunk) {
+        return nullptr;
+    }
+    return chunk->queues[taskId & (REGISTRY_CHUNK_SIZE - 1)].load(std::memory_order_acquire);
+}
+
+IPCManager::QueueRef IPCManager::referenceQueue(TaskId taskId) const {
+    EpochDomain::Guard guard;
+    return QueueRef(findQueue(taskId));
+}
+
+void IPCManager::blockWaiter(TaskId taskId) {
+    if (onBlock_) {
+        onBlock_(taskId);
+    }
+}
+
+void IPCManager::wakeWaiter(TaskId taskId) {
+    if (onWake_) {
+        onWake_(taskId);
+    }
 }
 
 std::string IPCManager::getIPCReport() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    EpochDomain::Guard guard;
     
     std::stringstream ss;
     ss << "=== IPC Manager Report ===\n";
-    ss << "Registered Tasks: " << messageQueues_.size() << "\n";
+    ss << "Registered Tasks: " << registeredCount_.load(std::memory_order_relaxed) << "\n";
     ss << "Total Messages Sent: " << totalMessagesSent_ << "\n";
     ss << "Total Messages Received: " << totalMessagesReceived_ << "\n";
+    ss << "Total Messages Dropped: " << totalMessagesDropped_ << "\n";
+    ss << "Synchronous Calls: " << directCalls_ << " direct, " << queuedCalls_ << " queued\n";
+    ss << "Pending Async Calls: " << getPendingCallCount() << "\n";
     ss << "Next Message ID: " << nextMessageId_ << "\n";
     
+    {
+        std::shared_lock<std::shared_mutex> topicLock(topicMutex_);
+        ss << "Topics: " << topics_.size() << "\n";
+        for (const auto& [id, topic] : topics_) {
+            ss << "  Topic " << id << " '" << topic->name << "': " 
+               << topic->subscriptions.size() << " subscribers, " 
+               << topic->publishCount.load(std::memory_order_relaxed) << " publishes\n";
+        }
+    }
+    {
+        std::shared_lock<std::shared_mutex> handleLock(handleMutex_);
+        ss << "Ports Created: " << nextPortId_.load(std::memory_order_relaxed) - 1 
+           << " (" << handleTables_.size() << " handle tables)\n";
+    }
+    ss << "Payload Blocks Created: " << PayloadPool::instance().getBlocksCreated() << "\n";
+    
     ss << "\nPending Messages per Task:\n";
-    for (const auto& [taskId, queue] : messageQueues_) {
-        ss << "  Task " << taskId << ": " << queue->size() << " messages\n";
+    for (size_t c = 0; c < REGISTRY_CHUNKS; ++c) {
+        RegistryChunk* chunk = registry_[c].load(std::memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+        for (const auto& slot : chunk->queues) {
+            MessageQueue* queue = slot.load(std::memory_order_acquire);
+            if (!queue) {
+                continue;
+            }
+            ss << "  Task " << queue->getOwner() << ": " << queue->size() << " / " 
+               << queue->capacity() << " messages";
+            if (queue->evictedCount() > 0) {
+                ss << ", " << queue->evictedCount() << " evicted";
+            }
+            ss << "\n";
+        }
     }
     
+    ss << "\n" << channelStats_.getChannelReport(5);
+    
     return ss.str();
 }
 
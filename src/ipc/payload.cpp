@@ -0,0 +1,163 @@
+#include "ipc/payload.hpp"
+#include <sstream>
+#include <new>
+
+namespace MiniOS {
+
+namespace {
+
+constexpr size_t LOCAL_CACHE_LIMIT = 64;
+constexpr size_t LOCAL_CACHE_BATCH = 32;
+
+}
+
+struct PayloadCache {
+    std::array<PayloadPool::FreeBlock*, PAYLOAD_SIZE_CLASSES> heads{};
+    std::array<size_t, PAYLOAD_SIZE_CLASSES> counts{};
+
+    ~PayloadCache() {
+        for (size_t c = 0; c < PAYLOAD_SIZE_CLASSES; ++c) {
+            flush(c, counts[c]);
+        }
+    }
+
+    void flush(size_t sizeClass, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        PayloadPool::FreeBlock* head = heads[sizeClass];
+        PayloadPool::FreeBlock* tail = head;
+        for (size_t i = 1; i < count; ++i) {
+            tail = tail->next;
+        }
+        heads[sizeClass] = tail->next;
+        counts[sizeClass] -= count;
+        PayloadPool::instance().returnBatch(sizeClass, head, tail, count);
+    }
+};
+
+static thread_local PayloadCache t_payloadCache;
+
+SharedPayload* SharedPayload::create(const void* data, size_t size) {
+    void* memory = ::operator new(sizeof(SharedPayload) + size);
+    auto* shared = new (memory) SharedPayload(size);
+    if (size > 0) {
+        std::memcpy(reinterpret_cast<uint8_t*>(shared + 1), data, size);
+    }
+    return shared;
+}
+
+void SharedPayload::release(uint32_t count) {
+    if (refs_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+        this->~SharedPayload();
+        ::operator delete(this);
+    }
+}
+
+PayloadPool& PayloadPool::instance() {
+    static PayloadPool pool;
+    return pool;
+}
+
+PayloadPool::~PayloadPool() {
+    for (auto& sc : classes_) {
+        while (sc.head) {
+            FreeBlock* next = sc.head->next;
+            ::operator delete(sc.head);
+            sc.head = next;
+        }
+    }
+}
+
+std::optional<size_t> PayloadPool::sizeClassFor(size_t size) {
+    for (size_t c = 0; c < PAYLOAD_SIZE_CLASSES; ++c) {
+        if (size <= classSize(c)) {
+            return c;
+        }
+    }
+    return std::nullopt;
+}
+
+uint8_t* PayloadPool::acquire(size_t sizeClass) {
+    PayloadCache& cache = t_payloadCache;
+
+    if (cache.counts[sizeClass] == 0) {
+        size_t taken = 0;
+        cache.heads[sizeClass] = takeBatch(sizeClass, LOCAL_CACHE_BATCH, taken);
+        cache.counts[sizeClass] = taken;
+    }
+
+    if (cache.counts[sizeClass] == 0) {
+        classes_[sizeClass].blocksCreated.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<uint8_t*>(::operator new(classSize(sizeClass)));
+    }
+
+    FreeBlock* block = cache.heads[sizeClass];
+    cache.heads[sizeClass] = block->next;
+    cache.counts[sizeClass]--;
+    return reinterpret_cast<uint8_t*>(block);
+}
+
+void PayloadPool::release(uint8_t* block, size_t sizeClass) {
+    PayloadCache& cache = t_payloadCache;
+
+    auto* freeBlock = reinterpret_cast<FreeBlock*>(block);
+    freeBlock->next = cache.heads[sizeClass];
+    cache.heads[sizeClass] = freeBlock;
+    cache.counts[sizeClass]++;
+
+    if (cache.counts[sizeClass] > LOCAL_CACHE_LIMIT) {
+        cache.flush(sizeClass, LOCAL_CACHE_BATCH);
+    }
+}
+
+PayloadPool::FreeBlock* PayloadPool::takeBatch(size_t sizeClass, size_t maxCount, size_t& taken) {
+    SizeClass& sc = classes_[sizeClass];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+
+    FreeBlock* head = sc.head;
+    FreeBlock* tail = nullptr;
+    taken = 0;
+
+    while (sc.head && taken < maxCount) {
+        tail = sc.head;
+        sc.head = sc.head->next;
+        taken++;
+    }
+
+    if (tail) {
+        tail->next = nullptr;
+    }
+    sc.freeCount -= taken;
+    return taken > 0 ? head : nullptr;
+}
+
+void PayloadPool::returnBatch(size_t sizeClass, FreeBlock* head, FreeBlock* tail, size_t count) {
+    SizeClass& sc = classes_[sizeClass];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+
+    tail->next = sc.head;
+    sc.head = head;
+    sc.freeCount += count;
+}
+
+uint64_t PayloadPool::getBlocksCreated() const {
+    uint64_t total = 0;
+    for (const auto& sc : classes_) {
+        total += sc.blocksCreated.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string PayloadPool::getPoolReport() const {
+    std::stringstream ss;
+    ss << "=== Payload Pool Report ===\n";
+    ss << "Inline Payload Limit: " << INLINE_PAYLOAD_SIZE << " bytes\n";
+    for (size_t c = 0; c < PAYLOAD_SIZE_CLASSES; ++c) {
+        ss << "  Class " << classSize(c) << " B: "
+           << classes_[c].blocksCreated.load(std::memory_order_relaxed) << " blocks created\n";
+    }
+    return ss.str();
+}
+
+}
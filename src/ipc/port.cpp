@@ -0,0 +1,247 @@
+#include "ipc/port.hpp"
+#include <algorithm>
+
+namespace MiniOS {
+
+Port::Port(PortId id, TaskId owner, const QueueLimits& limits)
+    : id_(id)
+    , owner_(owner)
+    , queue_(owner, limits)
+    , observer_(nullptr) {}
+
+Port::~Port() {
+    queue_.setReadinessObserver(nullptr);
+}
+
+uint32_t Port::poll() const {
+    uint32_t events = 0;
+    if (!queue_.isEmpty()) {
+        events |= WAIT_READABLE;
+    }
+    if (queue_.isClosed()) {
+        events |= WAIT_HANGUP;
+    }
+    return events;
+}
+
+bool Port::attach(ReadinessObserver* observer) {
+    std::lock_guard<std::mutex> lock(observerMutex_);
+    if (observer_) {
+        return false;
+    }
+    observer_ = observer;
+    queue_.setReadinessObserver(observer);
+    return true;
+}
+
+void Port::detach(ReadinessObserver* observer) {
+    std::lock_guard<std::mutex> lock(observerMutex_);
+    if (observer_ == observer) {
+        observer_ = nullptr;
+        queue_.setReadinessObserver(nullptr);
+    }
+}
+
+Mailbox::Mailbox(MessageQueue* queue) : queue_(queue) {
+    queue_->retain();
+}
+
+Mailbox::~Mailbox() {
+    if (queue_->release()) {
+        delete queue_;
+    }
+}
+
+uint32_t Mailbox::poll() const {
+    uint32_t events = 0;
+    if (!queue_->isEmpty() || queue_->hasSignal()) {
+        events |= WAIT_READABLE;
+    }
+    if (queue_->isClosed()) {
+        events |= WAIT_HANGUP;
+    }
+    return events;
+}
+
+// Several handles may name the same mailbox, so the queue's single observer
+// slot is claimed rather than overwritten.
+bool Mailbox::attach(ReadinessObserver* observer) {
+    return queue_->exchangeReadinessObserver(nullptr, observer);
+}
+
+void Mailbox::detach(ReadinessObserver* observer) {
+    queue_->exchangeReadinessObserver(observer, nullptr);
+}
+
+WaitSet::~WaitSet() {
+    close();
+}
+
+bool WaitSet::add(Handle handle, std::shared_ptr<WaitSource> source, uint64_t cookie) {
+    auto* member = new Member(this, handle, source, cookie);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || members_.count(handle) || !source->attach(member)) {
+            delete member;
+            return false;
+        }
+        members_[handle] = member;
+    }
+
+    if (source->poll() != 0) {
+        markReady(member);
+    }
+    return true;
+}
+
+bool WaitSet::remove(Handle handle) {
+    Member* member;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = members_.find(handle);
+        if (it == members_.end()) {
+            return false;
+        }
+        member = it->second;
+        member->removed = true;
+        members_.erase(it);
+        ready_.erase(std::remove(ready_.begin(), ready_.end(), member), ready_.end());
+    }
+
+    retireMember(member);
+    return true;
+}
+
+void WaitSet::close() {
+    std::vector<Member*> members;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return;
+        }
+        closed_ = true;
+        for (auto& [handle, member] : members_) {
+            member->removed = true;
+            members.push_back(member);
+        }
+        members_.clear();
+        ready_.clear();
+    }
+    condition_.notify_all();
+
+    for (Member* member : members) {
+        retireMember(member);
+    }
+}
+
+// Producers may still be inside onReady() for a member we just unlinked, so
+// it is freed through the epoch domain they are pinned to.
+void WaitSet::retireMember(Member* member) {
+    member->source->detach(member);
+    EpochDomain::instance().retire([member]() { delete member; });
+}
+
+void WaitSet::markReady(Member* member) {
+    if (member->queued.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (member->removed || closed_) {
+            member->queued.store(false, std::memory_order_release);
+            return;
+        }
+        ready_.push_back(member);
+    }
+    condition_.notify_one();
+}
+
+size_t WaitSet::wait(std::vector<WaitEvent>& events, size_t maxEvents, Deadline deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto hasReady = [this]() { return closed_ || !ready_.empty(); };
+
+    while (true) {
+        if (deadline == NO_DEADLINE) {
+            condition_.wait(lock, hasReady);
+        } else if (!condition_.wait_until(lock, deadline, hasReady)) {
+            return 0;
+        }
+        if (closed_) {
+            return 0;
+        }
+
+        size_t emitted = 0;
+        size_t scan = ready_.size();
+        while (scan-- > 0 && emitted < maxEvents) {
+            Member* member = ready_.front();
+            ready_.pop_front();
+            member->queued.store(false, std::memory_order_release);
+
+            uint32_t mask = member->source->poll();
+            if (mask == 0) {
+                continue;
+            }
+            events.push_back({member->handle, member->cookie, mask});
+            emitted++;
+
+            if (!member->queued.exchange(true, std::memory_order_acq_rel)) {
+                ready_.push_back(member);
+            }
+        }
+
+        if (emitted > 0) {
+            return emitted;
+        }
+    }
+}
+
+size_t WaitSet::memberCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return members_.size();
+}
+
+Handle HandleTable::insert(Capability capability) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Handle handle = nextHandle_++;
+    entries_.emplace(handle, std::move(capability));
+    return handle;
+}
+
+std::optional<Capability> HandleTable::lookup(Handle handle, uint32_t requiredRights) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(handle);
+    if (it == entries_.end() || (it->second.rights & requiredRights) != requiredRights) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<Capability> HandleTable::remove(Handle handle) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = entries_.find(handle);
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    Capability capability = std::move(it->second);
+    entries_.erase(it);
+    return capability;
+}
+
+std::vector<Capability> HandleTable::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::vector<Capability> removed;
+    removed.reserve(entries_.size());
+    for (auto& [handle, capability] : entries_) {
+        removed.push_back(std::move(capability));
+    }
+    entries_.clear();
+    return removed;
+}
+
+size_t HandleTable::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.size();
+}
+
+}
@@ -0,0 +1,519 @@
+#include "ipc/transport.hpp"
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace MiniOS {
+
+namespace {
+
+constexpr uint32_t TRANSPORT_MAGIC = 0x4D4E4950;
+constexpr int POLL_INTERVAL_MS = 50;
+
+size_t ringCapacityFor(size_t requested) {
+    size_t minimum = 4 * (sizeof(WireFrame) + MAX_MESSAGE_SIZE);
+    size_t capacity = 1;
+    while (capacity < requested || capacity < minimum) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+bool fillAddress(const std::string& path, sockaddr_un& addr) {
+    if (path.size() >= sizeof(addr.sun_path)) {
+        LOG_ERROR("IPC", "Socket path too long: " + path);
+        return false;
+    }
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Sends a fixed-size record, optionally passing a file descriptor alongside.
+template<typename T>
+bool sendRecord(int socket, const T& record, int fd) {
+    iovec iov{const_cast<T*>(&record), sizeof(T)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    return ::sendmsg(socket, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(T));
+}
+
+template<typename T>
+bool receiveRecord(int socket, T& record, int* fd) {
+    iovec iov{&record, sizeof(T)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (::recvmsg(socket, &msg, MSG_CMSG_CLOEXEC) != static_cast<ssize_t>(sizeof(T))) {
+        return false;
+    }
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    bool hasFd = cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS;
+    if (fd) {
+        *fd = -1;
+        if (hasFd) {
+            std::memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+        }
+    } else if (hasFd) {
+        int unexpected;
+        std::memcpy(&unexpected, CMSG_DATA(cmsg), sizeof(int));
+        ::close(unexpected);
+    }
+    return true;
+}
+
+}
+
+ShmRing::ShmRing(void* region, size_t capacity, bool initialize)
+    : header_(static_cast<Header*>(region))
+    , data_(static_cast<uint8_t*>(region) + sizeof(Header))
+    , mask_(capacity - 1)
+    , cachedHead_(0)
+    , corrupt_(false)
+{
+    if (initialize) {
+        new (header_) Header();
+        header_->head.store(0, std::memory_order_relaxed);
+        header_->tail.store(0, std::memory_order_relaxed);
+        header_->sleeping.store(0, std::memory_order_relaxed);
+        header_->capacity = capacity;
+    }
+}
+
+bool ShmRing::write(const Message& msg, TaskId receiver) {
+    size_t payload = msg.payload.size();
+    uint64_t bytes = frameBytes(payload);
+    uint64_t capacity = mask_ + 1;
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    uint64_t offset = tail & mask_;
+    uint64_t contiguous = capacity - offset;
+    uint64_t needed = bytes <= contiguous ? bytes : contiguous + bytes;
+
+    if (tail + needed - cachedHead_ > capacity) {
+        cachedHead_ = header_->head.load(std::memory_order_acquire);
+        if (tail + needed - cachedHead_ > capacity) {
+            return false;
+        }
+    }
+
+    if (bytes > contiguous) {
+        reinterpret_cast<WireFrame*>(data_ + offset)->length = PADDING;
+        tail += contiguous;
+        offset = 0;
+    }
+
+    auto* frame = reinterpret_cast<WireFrame*>(data_ + offset);
+    frame->length = static_cast<uint32_t>(payload);
+    frame->id = msg.id;
+    frame->sender = msg.senderId;
+    frame->receiver = receiver;
+    frame->correlationId = msg.correlationId;
+    frame->type = static_cast<uint8_t>(msg.type);
+    frame->priority = static_cast<uint8_t>(msg.priority);
+    frame->reserved = 0;
+    if (payload > 0) {
+        std::memcpy(frame + 1, msg.payload.data(), payload);
+    }
+
+    header_->tail.store(tail + bytes, std::memory_order_release);
+    return true;
+}
+
+bool ShmRing::empty() const {
+    return header_->head.load(std::memory_order_acquire) == header_->tail.load(std::memory_order_acquire);
+}
+
+bool ShmRing::armDoorbell() {
+    header_->sleeping.store(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!empty()) {
+        disarmDoorbell();
+        return false;
+    }
+    return true;
+}
+
+bool ShmRing::takeDoorbell() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return header_->sleeping.load(std::memory_order_relaxed) != 0 &&
+           header_->sleeping.exchange(0, std::memory_order_acq_rel) != 0;
+}
+
+IPCTransport::IPCTransport(IPCManager& ipc, NodeId localNode, size_t ringBytes)
+    : ipc_(ipc)
+    , localNode_(localNode)
+    , ringBytes_(ringCapacityFor(ringBytes))
+    , listenSocket_(-1)
+    , running_(true)
+    , framesSent_(0)
+    , framesReceived_(0)
+    , doorbells_(0)
+{
+    for (auto& link : links_) {
+        link.store(nullptr, std::memory_order_relaxed);
+    }
+    ipc_.setRemoteRouter(this);
+    LOG_INFO("IPC", "Transport initialized for node " + std::to_string(localNode_));
+}
+
+IPCTransport::~IPCTransport() {
+    // Senders call forward() under an epoch guard; let the ones that already
+    // loaded this router finish before the links and the object go away.
+    ipc_.setRemoteRouter(nullptr);
+    EpochDomain::instance().synchronize();
+    shutdown();
+}
+
+bool IPCTransport::listen(const std::string& path) {
+    sockaddr_un addr;
+    if (listenSocket_ >= 0 || !fillAddress(path, addr)) {
+        return false;
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        LOG_ERROR("IPC", systemError("socket"));
+        return false;
+    }
+
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        LOG_ERROR("IPC", systemError("Cannot listen on " + path));
+        ::close(fd);
+        return false;
+    }
+
+    listenSocket_ = fd;
+    listenPath_ = path;
+    acceptThread_ = std::thread(&IPCTransport::acceptLoop, this);
+    LOG_INFO("IPC", "Node " + std::to_string(localNode_) + " listening on " + path);
+    return true;
+}
+
+bool IPCTransport::connect(const std::string& path) {
+    sockaddr_un addr;
+    if (!fillAddress(path, addr)) {
+        return false;
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        LOG_ERROR("IPC", systemError("Cannot connect to " + path));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+
+    size_t regionBytes = 2 * ShmRing::regionSize(ringBytes_);
+    int memfd = ::memfd_create("minios-ipc", MFD_CLOEXEC);
+    void* region = MAP_FAILED;
+    if (memfd >= 0 && ::ftruncate(memfd, static_cast<off_t>(regionBytes)) == 0) {
+        region = ::mmap(nullptr, regionBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    }
+    if (region == MAP_FAILED) {
+        LOG_ERROR("IPC", systemError("Cannot map transport rings"));
+        if (memfd >= 0) {
+            ::close(memfd);
+        }
+        ::close(fd);
+        return false;
+    }
+
+    ShmRing(region, ringBytes_, true);
+    ShmRing(static_cast<uint8_t*>(region) + regionBytes / 2, ringBytes_, true);
+
+    Hello hello{TRANSPORT_MAGIC, localNode_, ringBytes_};
+    Hello reply{};
+    bool accepted = sendRecord(fd, hello, memfd) && receiveRecord(fd, reply, nullptr) &&
+                    reply.magic == TRANSPORT_MAGIC && reply.ringBytes == ringBytes_;
+    ::close(memfd);
+
+    if (!accepted || !addLink(fd, reply.node, region, regionBytes, true)) {
+        LOG_WARN("IPC", "Handshake with " + path + " failed");
+        ::munmap(region, regionBytes);
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+void IPCTransport::acceptLoop() {
+    while (running_.load(std::memory_order_acquire)) {
+        pollfd ready{listenSocket_, POLLIN, 0};
+        if (::poll(&ready, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+
+        int fd = ::accept4(listenSocket_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        Hello hello{};
+        int memfd = -1;
+        bool valid = receiveRecord(fd, hello, &memfd) && memfd >= 0 && hello.magic == TRANSPORT_MAGIC &&
+                     hello.ringBytes >= ringCapacityFor(0) && (hello.ringBytes & (hello.ringBytes - 1)) == 0;
+
+        // The rings must fit in the file the peer sent, or touching them
+        // past its end would fault.
+        struct stat file;
+        valid = valid && ::fstat(memfd, &file) == 0 && file.st_size > 0 &&
+                hello.ringBytes <= static_cast<uint64_t>(file.st_size) / 2 &&
+                2 * ShmRing::regionSize(hello.ringBytes) <= static_cast<uint64_t>(file.st_size);
+
+        size_t regionBytes = valid ? 2 * ShmRing::regionSize(hello.ringBytes) : 0;
+        void* region = valid ? ::mmap(nullptr, regionBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0)
+                             : MAP_FAILED;
+        if (memfd >= 0) {
+            ::close(memfd);
+        }
+
+        Hello reply{TRANSPORT_MAGIC, localNode_, hello.ringBytes};
+        if (region == MAP_FAILED || !sendRecord(fd, reply, -1) ||
+            !addLink(fd, hello.node, region, regionBytes, false)) {
+            LOG_WARN("IPC", "Rejected transport connection from node " + std::to_string(hello.node));
+            if (region != MAP_FAILED) {
+                ::munmap(region, regionBytes);
+            }
+            ::close(fd);
+        }
+    }
+}
+
+// The connecting side writes the first ring and reads the second.
+bool IPCTransport::addLink(int socket, NodeId peer, void* region, size_t regionBytes, bool initiator) {
+    if (peer == 0 || peer >= MAX_NODES || peer == localNode_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(linksMutex_);
+    if (!running_.load(std::memory_order_acquire) || links_[peer].load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    size_t ringBytes = regionBytes / 2 - sizeof(ShmRing::Header);
+    ShmRing first(region, ringBytes, false);
+    ShmRing second(static_cast<uint8_t*>(region) + regionBytes / 2, ringBytes, false);
+
+    auto link = std::make_unique<Link>();
+    link->peer = peer;
+    link->socket = socket;
+    link->region = region;
+    link->regionBytes = regionBytes;
+    link->outbound = initiator ? first : second;
+    link->inbound = initiator ? second : first;
+    link->connected.store(true, std::memory_order_release);
+    link->backlog.reserve(TRANSPORT_RECEIVE_BATCH);
+    link->receiver = std::thread(&IPCTransport::receiveLoop, this, link.get());
+
+    links_[peer].store(link.get(), std::memory_order_release);
+    ownedLinks_.push_back(std::move(link));
+
+    LOG_INFO("IPC", "Node " + std::to_string(localNode_) + " linked to node " + std::to_string(peer));
+    return true;
+}
+
+void IPCTransport::shutdown() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    if (acceptThread_.joinable()) {
+        acceptThread_.join();
+    }
+    if (listenSocket_ >= 0) {
+        ::close(listenSocket_);
+        ::unlink(listenPath_.c_str());
+        listenSocket_ = -1;
+    }
+
+    std::vector<std::unique_ptr<Link>> links;
+    {
+        std::lock_guard<std::mutex> lock(linksMutex_);
+        links.swap(ownedLinks_);
+        for (auto& link : links) {
+            links_[link->peer].store(nullptr, std::memory_order_release);
+        }
+    }
+
+    // Senders may still be writing into a ring they looked up before the
+    // slot was cleared, so the mapping and socket outlive their epoch.
+    for (auto& link : links) {
+        link->connected.store(false, std::memory_order_release);
+        if (link->receiver.joinable()) {
+            link->receiver.join();
+        }
+        Link* retired = link.release();
+        EpochDomain::instance().retire([retired]() {
+            ::munmap(retired->region, retired->regionBytes);
+            ::close(retired->socket);
+            delete retired;
+        });
+    }
+}
+
+bool IPCTransport::forward(Message& msg) {
+    EpochDomain::Guard guard;
+
+    NodeId node = nodeOf(msg.receiverId);
+    Link* link = links_[node].load(std::memory_order_acquire);
+    if (!link || !link->connected.load(std::memory_order_acquire)) {
+        LOG_WARN("IPC", "No transport link to node " + std::to_string(node));
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(link->sendMutex);
+        if (!link->outbound.write(msg, localTaskOf(msg.receiverId))) {
+            return false;
+        }
+    }
+    framesSent_.fetch_add(1, std::memory_order_relaxed);
+
+    if (link->outbound.takeDoorbell()) {
+        char bell = 1;
+        ::send(link->socket, &bell, 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+        doorbells_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void IPCTransport::receiveLoop(Link* link) {
+    while (running_.load(std::memory_order_acquire) && link->connected.load(std::memory_order_acquire)) {
+        if (deliverFrames(link) > 0) {
+            continue;
+        }
+        if (!link->backlog.empty()) {
+            // The queue at the front of the backlog is full; sleep until it
+            // drains instead of offering the batch again.
+            const Message& stalled = link->backlog.front();
+            ipc_.waitForSpace(stalled.receiverId, stalled.payload.size(),
+                              std::chrono::steady_clock::now() + std::chrono::milliseconds(POLL_INTERVAL_MS));
+            continue;
+        }
+        if (!link->inbound.armDoorbell()) {
+            continue;
+        }
+
+        pollfd ready{link->socket, POLLIN, 0};
+        if (::poll(&ready, 1, POLL_INTERVAL_MS) > 0) {
+            char bells[64];
+            ssize_t got = ::recv(link->socket, bells, sizeof(bells), MSG_DONTWAIT);
+            if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+                link->connected.store(false, std::memory_order_release);
+                LOG_INFO("IPC", "Node " + std::to_string(link->peer) + " disconnected");
+            }
+        }
+        link->inbound.disarmDoorbell();
+    }
+
+    while (deliverFrames(link) > 0) {
+    }
+    link->backlog.clear();
+}
+
+// Frames are converted into the link's backlog and handed over in batches;
+// whatever a full queue refuses stays in the backlog, so the ring stops
+// draining and the sender sees the ring fill up.
+size_t IPCTransport::deliverFrames(Link* link) {
+    size_t delivered = flushBacklog(link);
+    if (!link->backlog.empty()) {
+        return delivered;
+    }
+
+    link->inbound.drain(TRANSPORT_RECEIVE_BATCH, [&](const WireFrame& frame, const uint8_t* payload) {
+        if (frame.type >= MESSAGE_TYPE_COUNT || frame.priority >= MESSAGE_PRIORITY_COUNT) {
+            LOG_ERROR("IPC", "Corrupt frame from node " + std::to_string(link->peer) + "; closing link");
+            link->connected.store(false, std::memory_order_release);
+            return false;
+        }
+
+        TaskId sender = frame.sender < MAX_IPC_TASKS ? remoteTaskId(link->peer, frame.sender) : frame.sender;
+        Message& msg = link->backlog.emplace_back(frame.id, sender, frame.receiver, 
+                                                  static_cast<MessageType>(frame.type));
+        msg.priority = static_cast<MessagePriority>(frame.priority);
+        msg.correlationId = frame.correlationId;
+        if (frame.length > 0) {
+            msg.setPayload(payload, frame.length);
+        }
+        return true;
+    });
+    if (link->inbound.corrupt() && link->connected.exchange(false, std::memory_order_acq_rel)) {
+        LOG_ERROR("IPC", "Corrupt ring from node " + std::to_string(link->peer) + "; closing link");
+    }
+
+    return delivered + flushBacklog(link);
+}
+
+size_t IPCTransport::flushBacklog(Link* link) {
+    auto& backlog = link->backlog;
+    if (backlog.empty()) {
+        return 0;
+    }
+
+    size_t delivered = ipc_.deliverRemote(backlog.data(), backlog.size());
+    backlog.erase(backlog.begin(), backlog.begin() + static_cast<std::ptrdiff_t>(delivered));
+    framesReceived_.fetch_add(delivered, std::memory_order_relaxed);
+    return delivered;
+}
+
+bool IPCTransport::isConnected(NodeId node) const {
+    if (node >= MAX_NODES) {
+        return false;
+    }
+    EpochDomain::Guard guard;
+    Link* link = links_[node].load(std::memory_order_acquire);
+    return link && link->connected.load(std::memory_order_acquire);
+}
+
+std::string IPCTransport::getTransportReport() const {
+    std::stringstream ss;
+    ss << "=== IPC Transport Report ===\n";
+    ss << "Local Node: " << localNode_ << "\n";
+    ss << "Ring Size: " << ringBytes_ << " bytes\n";
+    {
+        std::lock_guard<std::mutex> lock(linksMutex_);
+        ss << "Links: " << ownedLinks_.size() << "\n";
+        for (const auto& link : ownedLinks_) {
+            ss << "  Node " << link->peer << ": "
+               << (link->connected.load(std::memory_order_relaxed) ? "connected" : "disconnected") << "\n";
+        }
+    }
+    ss << "Frames Sent: " << framesSent_.load(std::memory_order_relaxed) << "\n";
+    ss << "Frames Received: " << framesReceived_.load(std::memory_order_relaxed) << "\n";
+    ss << "Doorbells Rung: " << doorbells_.load(std::memory_order_relaxed) << "\n";
+    return ss.str();
+}
+
+}
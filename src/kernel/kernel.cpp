@@ -113,6 +113,7 @@ std::string Kernel::getKernelReport() const {
     
     ss << getSystemInfo() << "\n";
     ss << scheduler_->getTaskReport() << "\n";
+    ss << futexTable_->getFutexReport() << "\n";
     ss << memoryManager_->getMemoryReport() << "\n";
     ss << fileSystem_->getFileSystemReport() << "\n";
     ss << ipcManager_->getIPCReport() << "\n";
@@ -140,6 +141,11 @@ bool Kernel::initSubsystems() {
     
     LOG_INFO("Kernel", "  -> Scheduler");
     scheduler_ = std::make_unique<Scheduler>(SchedulerType::RoundRobin);
+    futexTable_ = std::make_unique<FutexTable>();
+    futexTable_->setBlockingHooks(
+        [this](TaskId id) { scheduler_->blockTask(id); },
+        [this](TaskId id) { scheduler_->unblockTask(id); }
+    );
     
     LOG_INFO("Kernel", "  -> Memory Manager");
     memoryManager_ = std::make_unique<MemoryManager>();
@@ -149,6 +155,14 @@ bool Kernel::initSubsystems() {
     
     LOG_INFO("Kernel", "  -> IPC Manager");
     ipcManager_ = std::make_unique<IPCManager>();
+    ipcManager_->attachMemoryManager(memoryManager_.get());
+    ipcManager_->setBlockingHooks(
+        [this](TaskId id) { scheduler_->blockTask(id); },
+        [this](TaskId id) { scheduler_->unblockTask(id); }
+    );
+    ipcManager_->setHandoffHook([this](TaskId from, TaskId to, bool blockFrom) {
+        scheduler_->handoff(from, to, blockFrom);
+    });
     
     LOG_INFO("Kernel", "  -> Interrupt Controller");
     interruptController_ = std::make_unique<InterruptController>();
@@ -159,8 +173,13 @@ bool Kernel::initSubsystems() {
     auto timerDriver = std::make_unique<TimerDriver>();
     auto keyboardDriver = std::make_unique<KeyboardDriver>();
     
+    auto ramDisk = std::make_unique<RamDisk>("ram0", RAM_DISK_SECTORS);
+    auto loopback = std::make_unique<VirtualNic>("lo", std::make_shared<FramePool>(LOOPBACK_FRAMES));
+    
     driverManager_->registerDriver(std::move(timerDriver));
     driverManager_->registerDriver(std::move(keyboardDriver));
+    driverManager_->registerDriver(std::move(ramDisk));
+    driverManager_->registerDriver(std::move(loopback));
     driverManager_->initAllDrivers();
     
     LOG_INFO("Kernel", "All subsystems initialized successfully");
@@ -177,15 +196,28 @@ void Kernel::setupInterruptHandlers() {
         },
         "Timer"
     );
-    
-    interruptController_->registerHandler(
+    interruptController_->openSoftirq(SoftirqId::Timer, [this]() { scheduler_->tick(); }, "Timer");
+    interruptController_->setIpiHandler(IpiType::Reschedule, [this](CpuId) { scheduler_->schedule(); });
+    
+    CoalescingPolicy keyboardPolicy;
+    keyboardPolicy.maxEvents = 32;
+    keyboardPolicy.maxDelay = std::chrono::milliseconds(1);
+    keyboardPolicy.adaptive = true;
+    keyboardPolicy.targetRate = 1000;
+    interruptController_->registerCoalescedHandler(
         static_cast<InterruptNumber>(InterruptType::Keyboard),
-        [](InterruptNumber num, void* data) {
-            LOG_DEBUG("Kernel", "Keyboard interrupt received");
+        [](InterruptNumber num, uint32_t events) {
+            LOG_DEBUG("Kernel", "Keyboard interrupt received (" + std::to_string(events) + " events)");
         },
+        keyboardPolicy,
         "Keyboard"
     );
     
+    networkStack_ = std::make_unique<NetworkStack>(*interruptController_);
+    if (auto* loopback = dynamic_cast<VirtualNic*>(driverManager_->getDriver("lo"))) {
+        networkStack_->attach(*loopback, static_cast<InterruptNumber>(InterruptType::Network));
+    }
+    
     interruptController_->registerHandler(
         static_cast<InterruptNumber>(InterruptType::SystemCall),
         [](InterruptNumber num, void* data) {
@@ -235,12 +267,16 @@ void Kernel::mainLoop() {
             nextTick = now + tickInterval;
         }
         
+        interruptController_->handlePendingInterrupts();
+        interruptController_->pollCoalescing(now);
+        interruptController_->runSoftirqs();
+        
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 }
 
 void Kernel::handleTimerInterrupt(InterruptNumber num, void* data) {
-    scheduler_->tick();
+    interruptController_->raiseSoftirq(SoftirqId::Timer);
 }
 
 int64_t SystemCall::dispatch(SystemCallId id, uint64_t arg1, uint64_t arg2, uint64_t arg3) {
@@ -333,6 +369,20 @@ int64_t SystemCall::dispatch(SystemCallId id, uint64_t arg1, uint64_t arg2, uint
                 static_cast<size_t>(arg3)
             );
             
+        case SystemCallId::Futex:
+            {
+                // The caller is the task current at entry, read before wait()
+                // blocks it and the scheduler moves on. All tasks share the one
+                // address space, so the queues are keyed by address alone.
+                auto* request = reinterpret_cast<const FutexRequest*>(arg1);
+                if (request && kernel.getState() == KernelState::Running) {
+                    TaskControlBlock* current = kernel.getScheduler().getCurrentTask();
+                    TaskId caller = current ? current->id : INVALID_TASK_ID;
+                    return kernel.getFutexTable().handle(caller, KERNEL_ADDRESS_SPACE, *request);
+                }
+            }
+            return -static_cast<int64_t>(FutexStatus::Invalid);
+            
         default:
             LOG_WARN("Syscall", "Unknown system call: " + std::to_string(static_cast<int>(id)));
             return -1;
@@ -9,6 +9,7 @@ MemoryManager::MemoryManager()
     : physicalMemory_(TOTAL_PHYSICAL_FRAMES * PAGE_SIZE, 0)
     , totalAllocatedPages_(0)
     , pageFaultCount_(0)
+    , nextRegionId_(1)
 {
     frameAllocationMap_.reset();
     LOG_INFO("MemoryManager", "Initialized with " + std::to_string(TOTAL_PHYSICAL_FRAMES) + 
@@ -32,13 +33,26 @@ bool MemoryManager::destroyAddressSpace(TaskId taskId) {
         return false;
     }
     
+    std::vector<RegionId> mappedRegions;
     for (auto& [pageNum, entry] : it->second->entries) {
-        if (entry.present) {
+        if (entry.region != INVALID_REGION_ID) {
+            if (mappedRegions.empty() || mappedRegions.back() != entry.region) {
+                mappedRegions.push_back(entry.region);
+            }
+        } else if (entry.present) {
             freeFrame(entry.frameNumber);
         }
     }
     
     pageTables_.erase(it);
+    
+    for (RegionId region : mappedRegions) {
+        auto regionIt = sharedRegions_.find(region);
+        if (regionIt != sharedRegions_.end()) {
+            regionIt->second->mappings.erase(taskId);
+            releaseRegionIfUnused(region);
+        }
+    }
     LOG_INFO("MemoryManager", "Destroyed address space for task " + std::to_string(taskId));
     return true;
 }
@@ -94,6 +108,12 @@ bool MemoryManager::freePage(TaskId taskId, PageNumber virtualPage) {
         return false;
     }
     
+    if (entryIt->second.region != INVALID_REGION_ID) {
+        LOG_WARN("MemoryManager", "Page " + std::to_string(virtualPage) + 
+                 " belongs to shared region " + std::to_string(entryIt->second.region));
+        return false;
+    }
+    
     freeFrame(entryIt->second.frameNumber);
     pageTable->entries.erase(entryIt);
     totalAllocatedPages_--;
@@ -129,6 +149,156 @@ bool MemoryManager::handlePageFault(TaskId taskId, PageNumber virtualPage) {
     return result.has_value();
 }
 
+RegionId MemoryManager::createSharedRegion(TaskId owner, size_t pageCount) {
+    if (pageCount == 0) {
+        return INVALID_REGION_ID;
+    }
+    
+    auto first = allocateContiguousFrames(pageCount);
+    if (!first) {
+        LOG_ERROR("MemoryManager", "Cannot allocate " + std::to_string(pageCount) + 
+                  " contiguous frames for shared region");
+        return INVALID_REGION_ID;
+    }
+    
+    RegionId id = nextRegionId_++;
+    sharedRegions_[id] = std::make_unique<SharedRegion>(id, owner, *first, pageCount);
+    
+    LOG_INFO("MemoryManager", "Created shared region " + std::to_string(id) + " (" + 
+             std::to_string(pageCount) + " pages) for task " + std::to_string(owner));
+    return id;
+}
+
+bool MemoryManager::destroySharedRegion(RegionId region) {
+    auto it = sharedRegions_.find(region);
+    if (it == sharedRegions_.end()) {
+        return false;
+    }
+    
+    it->second->destroyPending = true;
+    releaseRegionIfUnused(region);
+    return true;
+}
+
+bool MemoryManager::mapSharedRegion(RegionId region, TaskId taskId, PageNumber baseVirtualPage,
+                                    MemoryProtection protection) {
+    auto regionIt = sharedRegions_.find(region);
+    if (regionIt == sharedRegions_.end() || regionIt->second->destroyPending) {
+        return false;
+    }
+    
+    auto ptIt = pageTables_.find(taskId);
+    if (ptIt == pageTables_.end()) {
+        LOG_ERROR("MemoryManager", "No address space for task " + std::to_string(taskId));
+        return false;
+    }
+    
+    SharedRegion& shared = *regionIt->second;
+    if (shared.mappings.count(taskId)) {
+        LOG_WARN("MemoryManager", "Region " + std::to_string(region) + 
+                 " already mapped by task " + std::to_string(taskId));
+        return false;
+    }
+    
+    auto& entries = ptIt->second->entries;
+    for (size_t i = 0; i < shared.pageCount; ++i) {
+        auto entryIt = entries.find(baseVirtualPage + static_cast<PageNumber>(i));
+        if (entryIt != entries.end() && entryIt->second.present) {
+            LOG_WARN("MemoryManager", "Virtual range for region " + std::to_string(region) + 
+                     " overlaps page " + std::to_string(entryIt->first));
+            return false;
+        }
+    }
+    
+    for (size_t i = 0; i < shared.pageCount; ++i) {
+        PageTableEntry entry;
+        entry.frameNumber = shared.firstFrame + static_cast<FrameNumber>(i);
+        entry.present = true;
+        entry.protection = protection;
+        entry.region = region;
+        entries[baseVirtualPage + static_cast<PageNumber>(i)] = entry;
+    }
+    
+    shared.mappings[taskId] = baseVirtualPage;
+    
+    LOG_DEBUG("MemoryManager", "Mapped region " + std::to_string(region) + " into task " + 
+              std::to_string(taskId) + " at page " + std::to_string(baseVirtualPage));
+    return true;
+}
+
+bool MemoryManager::unmapSharedRegion(RegionId region, TaskId taskId) {
+    auto regionIt = sharedRegions_.find(region);
+    if (regionIt == sharedRegions_.end()) {
+        return false;
+    }
+    
+    SharedRegion& shared = *regionIt->second;
+    auto mapIt = shared.mappings.find(taskId);
+    if (mapIt == shared.mappings.end()) {
+        return false;
+    }
+    
+    auto ptIt = pageTables_.find(taskId);
+    if (ptIt != pageTables_.end()) {
+        for (size_t i = 0; i < shared.pageCount; ++i) {
+            ptIt->second->entries.erase(mapIt->second + static_cast<PageNumber>(i));
+        }
+    }
+    
+    shared.mappings.erase(mapIt);
+    releaseRegionIfUnused(region);
+    return true;
+}
+
+bool MemoryManager::transferRegion(RegionId region, TaskId from, TaskId to) {
+    auto it = sharedRegions_.find(region);
+    if (it == sharedRegions_.end() || it->second->owner != from) {
+        return false;
+    }
+    
+    it->second->owner = to;
+    return true;
+}
+
+bool MemoryManager::pinRegion(RegionId region) {
+    auto it = sharedRegions_.find(region);
+    if (it == sharedRegions_.end() || it->second->destroyPending) {
+        return false;
+    }
+    
+    it->second->pinCount++;
+    return true;
+}
+
+bool MemoryManager::unpinRegion(RegionId region) {
+    auto it = sharedRegions_.find(region);
+    if (it == sharedRegions_.end() || it->second->pinCount == 0) {
+        return false;
+    }
+    
+    it->second->pinCount--;
+    releaseRegionIfUnused(region);
+    return true;
+}
+
+const SharedRegion* MemoryManager::getSharedRegion(RegionId region) const {
+    auto it = sharedRegions_.find(region);
+    return (it != sharedRegions_.end()) ? it->second.get() : nullptr;
+}
+
+std::optional<void*> MemoryManager::getRegionAddress(RegionId region) {
+    auto it = sharedRegions_.find(region);
+    if (it == sharedRegions_.end()) {
+        return std::nullopt;
+    }
+    return physicalMemory_.data() + (it->second->firstFrame * PAGE_SIZE);
+}
+
+bool MemoryManager::isRegionMapped(RegionId region, TaskId taskId) const {
+    auto it = sharedRegions_.find(region);
+    return it != sharedRegions_.end() && it->second->mappings.count(taskId) > 0;
+}
+
 bool MemoryManager::setProtection(TaskId taskId, PageNumber virtualPage, MemoryProtection protection) {
     auto ptIt = pageTables_.find(taskId);
     if (ptIt == pageTables_.end()) {
@@ -190,6 +360,12 @@ std::string MemoryManager::getMemoryReport() const {
     ss << "Total Allocated Pages: " << totalAllocatedPages_ << "\n";
     ss << "Page Faults: " << pageFaultCount_ << "\n";
     ss << "Active Address Spaces: " << pageTables_.size() << "\n";
+    
+    size_t sharedPages = 0;
+    for (const auto& [_, region] : sharedRegions_) {
+        sharedPages += region->pageCount;
+    }
+    ss << "Shared Regions: " << sharedRegions_.size() << " (" << sharedPages << " pages)\n";
     return ss.str();
 }
 
@@ -227,6 +403,47 @@ std::optional<FrameNumber> MemoryManager::allocateFrame() {
     return std::nullopt;
 }
 
+std::optional<FrameNumber> MemoryManager::allocateContiguousFrames(size_t count) {
+    size_t runStart = 0;
+    size_t runLength = 0;
+    
+    for (size_t i = 0; i < TOTAL_PHYSICAL_FRAMES; ++i) {
+        if (frameAllocationMap_[i]) {
+            runLength = 0;
+            continue;
+        }
+        if (runLength == 0) {
+            runStart = i;
+        }
+        if (++runLength == count) {
+            for (size_t f = runStart; f < runStart + count; ++f) {
+                frameAllocationMap_.set(f);
+            }
+            return static_cast<FrameNumber>(runStart);
+        }
+    }
+    return std::nullopt;
+}
+
+void MemoryManager::releaseRegionIfUnused(RegionId region) {
+    auto it = sharedRegions_.find(region);
+    if (it == sharedRegions_.end()) {
+        return;
+    }
+    
+    SharedRegion& shared = *it->second;
+    if (!shared.destroyPending || !shared.mappings.empty() || shared.pinCount > 0) {
+        return;
+    }
+    
+    for (size_t i = 0; i < shared.pageCount; ++i) {
+        freeFrame(shared.firstFrame + static_cast<FrameNumber>(i));
+    }
+    
+    LOG_INFO("MemoryManager", "Released shared region " + std::to_string(region));
+    sharedRegions_.erase(it);
+}
+
 bool MemoryManager::freeFrame(FrameNumber frame) {
     if (frame >= TOTAL_PHYSICAL_FRAMES) {
         return false;
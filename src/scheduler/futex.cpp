@@ -0,0 +1,300 @@
+#include "scheduler/futex.hpp"
+#include "kernel/kernel.hpp"
+#include <sstream>
+
+namespace MiniOS {
+
+FutexTable::FutexTable()
+    : syscalls_(0)
+    , waits_(0)
+    , wakes_(0)
+    , requeued_(0)
+    , timeouts_(0)
+    , mismatches_(0) {}
+
+void FutexTable::setBlockingHooks(TaskStateHook onBlock, TaskStateHook onWake) {
+    onBlock_ = std::move(onBlock);
+    onWake_ = std::move(onWake);
+}
+
+size_t FutexTable::bucketIndex(const Key& key) {
+    uint64_t hash = (key.address >> 2) ^ (uint64_t(key.space) * 0x9E3779B97F4A7C15ull);
+    hash ^= hash >> 29;
+    return hash % FUTEX_HASH_BUCKETS;
+}
+
+// Called with the waiter's bucket locked and the waiter already unlinked.
+// Holding the bucket lock across the notify keeps the waiter's stack frame
+// alive until we are done with it; see dequeueWaiter().
+void FutexTable::signalWaiter(Waiter* waiter) {
+    std::lock_guard<std::mutex> lock(waiter->mutex);
+    waiter->woken = true;
+    waiter->condition.notify_one();
+}
+
+// Takes the waiter off whatever bucket it is on now (a requeue may have
+// moved it). Returns false if a waker got there first.
+bool FutexTable::dequeueWaiter(Waiter& waiter) {
+    while (true) {
+        Bucket* bucket = waiter.bucket.load(std::memory_order_acquire);
+        std::lock_guard<std::mutex> lock(bucket->mutex);
+        if (waiter.bucket.load(std::memory_order_relaxed) != bucket) {
+            continue;
+        }
+        if (!waiter.queued) {
+            return false;
+        }
+        bucket->waiters.erase(waiter.position);
+        waiter.queued = false;
+        return true;
+    }
+}
+
+FutexStatus FutexTable::wait(TaskId task, TaskId space, const FutexWord* word, uint32_t expected,
+                             Deadline deadline, uint32_t bitset) {
+    if (!word || bitset == 0) {
+        return FutexStatus::Invalid;
+    }
+
+    Waiter waiter;
+    waiter.task = task;
+    waiter.key = keyFor(space, word);
+    waiter.bitset = bitset;
+    waiter.woken = false;
+
+    Bucket& bucket = buckets_[bucketIndex(waiter.key)];
+    {
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        if (word->load(std::memory_order_acquire) != expected) {
+            mismatches_.fetch_add(1, std::memory_order_relaxed);
+            return FutexStatus::ValueMismatch;
+        }
+        waiter.position = bucket.waiters.insert(bucket.waiters.end(), &waiter);
+        waiter.queued = true;
+        waiter.bucket.store(&bucket, std::memory_order_release);
+    }
+    waits_.fetch_add(1, std::memory_order_relaxed);
+
+    if (onBlock_ && task != INVALID_TASK_ID) {
+        onBlock_(task);
+    }
+    {
+        std::unique_lock<std::mutex> lock(waiter.mutex);
+        auto woken = [&waiter]() { return waiter.woken; };
+        if (deadline == NO_DEADLINE) {
+            waiter.condition.wait(lock, woken);
+        } else {
+            waiter.condition.wait_until(lock, deadline, woken);
+        }
+    }
+    bool timedOut = dequeueWaiter(waiter);
+    if (onWake_ && task != INVALID_TASK_ID) {
+        onWake_(task);
+    }
+
+    if (timedOut) {
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        return FutexStatus::TimedOut;
+    }
+    return FutexStatus::Woken;
+}
+
+size_t FutexTable::wake(TaskId space, const FutexWord* word, size_t count, uint32_t bitset) {
+    if (!word || bitset == 0 || count == 0) {
+        return 0;
+    }
+
+    Key key = keyFor(space, word);
+    Bucket& bucket = buckets_[bucketIndex(key)];
+    size_t woken = 0;
+
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    for (auto it = bucket.waiters.begin(); it != bucket.waiters.end() && woken < count;) {
+        Waiter* waiter = *it;
+        if (!(waiter->key == key) || (waiter->bitset & bitset) == 0) {
+            ++it;
+            continue;
+        }
+        it = bucket.waiters.erase(it);
+        waiter->queued = false;
+        signalWaiter(waiter);
+        woken++;
+    }
+    wakes_.fetch_add(woken, std::memory_order_relaxed);
+    return woken;
+}
+
+std::optional<size_t> FutexTable::requeue(TaskId space, const FutexWord* from, const FutexWord* to,
+                                          size_t wakeCount, size_t requeueLimit,
+                                          std::optional<uint32_t> compare) {
+    if (!from || !to) {
+        return std::nullopt;
+    }
+
+    Key fromKey = keyFor(space, from);
+    Key toKey = keyFor(space, to);
+    Bucket& source = buckets_[bucketIndex(fromKey)];
+    Bucket& target = buckets_[bucketIndex(toKey)];
+
+    std::unique_lock<std::mutex> first(&source < &target ? source.mutex : target.mutex);
+    std::unique_lock<std::mutex> second;
+    if (&source != &target) {
+        second = std::unique_lock<std::mutex>(&source < &target ? target.mutex : source.mutex);
+    }
+
+    if (compare && from->load(std::memory_order_acquire) != *compare) {
+        mismatches_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    size_t woken = 0;
+    size_t moved = 0;
+    for (auto it = source.waiters.begin(); it != source.waiters.end();) {
+        Waiter* waiter = *it;
+        if (!(waiter->key == fromKey)) {
+            ++it;
+            continue;
+        }
+        if (woken < wakeCount) {
+            it = source.waiters.erase(it);
+            waiter->queued = false;
+            signalWaiter(waiter);
+            woken++;
+        } else if (moved < requeueLimit) {
+            auto next = std::next(it);
+            target.waiters.splice(target.waiters.end(), source.waiters, it);
+            waiter->key = toKey;
+            waiter->bucket.store(&target, std::memory_order_release);
+            moved++;
+            it = next;
+        } else {
+            break;
+        }
+    }
+
+    wakes_.fetch_add(woken, std::memory_order_relaxed);
+    requeued_.fetch_add(moved, std::memory_order_relaxed);
+    return woken + moved;
+}
+
+int64_t FutexTable::handle(TaskId task, TaskId space, const FutexRequest& request) {
+    syscalls_.fetch_add(1, std::memory_order_relaxed);
+
+    switch (request.op) {
+        case FutexOp::Wait:
+        case FutexOp::WaitBitset:
+            {
+                uint32_t bitset = request.op == FutexOp::Wait ? FUTEX_BITSET_MATCH_ANY : request.bitset;
+                FutexStatus status = wait(task, space, request.word, request.value,
+                                          request.deadline, bitset);
+                return -static_cast<int64_t>(status);
+            }
+
+        case FutexOp::Wake:
+        case FutexOp::WakeBitset:
+            {
+                uint32_t bitset = request.op == FutexOp::Wake ? FUTEX_BITSET_MATCH_ANY : request.bitset;
+                return static_cast<int64_t>(wake(space, request.word, request.value, bitset));
+            }
+
+        case FutexOp::Requeue:
+        case FutexOp::CmpRequeue:
+            {
+                std::optional<uint32_t> compare;
+                if (request.op == FutexOp::CmpRequeue) {
+                    compare = request.compare;
+                }
+                auto result = requeue(space, request.word, request.target, request.value,
+                                      request.requeueLimit, compare);
+                if (!result) {
+                    return -static_cast<int64_t>(request.word && request.target
+                                                 ? FutexStatus::ValueMismatch : FutexStatus::Invalid);
+                }
+                return static_cast<int64_t>(*result);
+            }
+    }
+    return -static_cast<int64_t>(FutexStatus::Invalid);
+}
+
+size_t FutexTable::getWaiterCount(TaskId space, const FutexWord* word) const {
+    Key key = keyFor(space, word);
+    const Bucket& bucket = buckets_[bucketIndex(key)];
+    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(bucket.mutex));
+    size_t count = 0;
+    for (const Waiter* waiter : bucket.waiters) {
+        if (waiter->key == key) {
+            count++;
+        }
+    }
+    return count;
+}
+
+std::string FutexTable::getFutexReport() const {
+    std::stringstream ss;
+    ss << "=== Futex Report ===\n";
+    ss << "Syscalls: " << syscalls_.load(std::memory_order_relaxed) << "\n";
+    ss << "Waits: " << waits_.load(std::memory_order_relaxed)
+       << " (" << timeouts_.load(std::memory_order_relaxed) << " timed out, "
+       << mismatches_.load(std::memory_order_relaxed) << " value mismatches)\n";
+    ss << "Wakes: " << wakes_.load(std::memory_order_relaxed) << "\n";
+    ss << "Requeued: " << requeued_.load(std::memory_order_relaxed) << "\n";
+    return ss.str();
+}
+
+static constexpr int64_t FUTEX_REJECTED = -static_cast<int64_t>(FutexStatus::Invalid);
+
+static int64_t futexCall(const FutexRequest& request) {
+    return SystemCall::dispatch(SystemCallId::Futex, reinterpret_cast<uint64_t>(&request));
+}
+
+bool FutexMutex::lockContended() {
+    while (word_.exchange(2, std::memory_order_acquire) != 0) {
+        if (futexCall({FutexOp::Wait, &word_, 2}) == FUTEX_REJECTED) {
+            LOG_ERROR("Futex", "Contended lock refused by the kernel");
+            return false;
+        }
+    }
+    return true;
+}
+
+void FutexMutex::unlockContended() {
+    word_.store(0, std::memory_order_release);
+    futexCall({FutexOp::Wake, &word_, 1});
+}
+
+bool FutexCondition::waitUntil(FutexMutex& mutex, Deadline deadline) {
+    uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    mutex.unlock();
+
+    FutexRequest request{FutexOp::Wait, &sequence_, sequence};
+    request.deadline = deadline;
+    int64_t result = futexCall(request);
+
+    // A notifyAll() may have moved us onto the mutex word, where only a
+    // contended unlock wakes anyone; relock as a contender so ours does too.
+    bool relocked = mutex.lockContended();
+    return relocked && result != FUTEX_REJECTED &&
+           result != -static_cast<int64_t>(FutexStatus::TimedOut);
+}
+
+void FutexCondition::notifyOne() {
+    sequence_.fetch_add(1, std::memory_order_release);
+    futexCall({FutexOp::Wake, &sequence_, 1});
+}
+
+void FutexCondition::notifyAll(FutexMutex& held) {
+    uint32_t sequence = sequence_.fetch_add(1, std::memory_order_release) + 1;
+
+    // Mark the mutex contended so our unlock wakes the first requeued waiter.
+    held.word_.store(2, std::memory_order_relaxed);
+
+    FutexRequest request{FutexOp::CmpRequeue, &sequence_, 1};
+    request.target = &held.word_;
+    request.requeueLimit = UINT32_MAX;
+    request.compare = sequence;
+    if (futexCall(request) < 0) {
+        futexCall({FutexOp::Wake, &sequence_, UINT32_MAX});
+    }
+}
+
+}
@@ -9,6 +9,7 @@ Scheduler::Scheduler(SchedulerType type)
     , nextTaskId_(1)
     , currentTaskId_(INVALID_TASK_ID)
     , tickCount_(0)
+    , handoffCount_(0)
     , schedulerRunning_(false)
 {
     LOG_INFO("Scheduler", "Initializing scheduler with " + 
@@ -16,6 +17,8 @@ Scheduler::Scheduler(SchedulerType type)
 }
 
 TaskId Scheduler::createTask(const std::string& name, TaskFunction func, TaskPriority priority) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     TaskId id = nextTaskId_++;
     
     auto tcb = std::make_unique<TaskControlBlock>(id, name, priority);
@@ -33,6 +36,8 @@ TaskId Scheduler::createTask(const std::string& name, TaskFunction func, TaskPri
 }
 
 bool Scheduler::terminateTask(TaskId id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     auto it = tasks_.find(id);
     if (it == tasks_.end()) {
         LOG_ERROR("Scheduler", "Cannot terminate non-existent task " + std::to_string(id));
@@ -53,6 +58,8 @@ bool Scheduler::terminateTask(TaskId id) {
 }
 
 bool Scheduler::blockTask(TaskId id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     auto it = tasks_.find(id);
     if (it == tasks_.end()) {
         return false;
@@ -75,6 +82,8 @@ bool Scheduler::blockTask(TaskId id) {
 }
 
 bool Scheduler::unblockTask(TaskId id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     auto it = tasks_.find(id);
     if (it == tasks_.end()) {
         return false;
@@ -92,7 +101,51 @@ bool Scheduler::unblockTask(TaskId id) {
     return true;
 }
 
+// Switches from one task straight to another without consulting the ready
+// queue. The target runs on whatever is left of the source's time slice.
+bool Scheduler::handoff(TaskId from, TaskId to, bool blockFrom) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
+    TaskControlBlock* target = getTask(to);
+    if (!target || target->state == TaskState::Terminated) {
+        return false;
+    }
+    
+    TaskControlBlock* source = getTask(from);
+    uint32_t donated = TIME_QUANTUM_MS;
+    if (source && source->state != TaskState::Terminated) {
+        donated = std::max<uint32_t>(source->timeSliceRemaining, 1);
+        removeFromReadyQueue(from);
+        if (blockFrom) {
+            source->state = TaskState::Blocked;
+            source->timeSliceRemaining = 0;
+        } else if (source->state == TaskState::Running) {
+            source->state = TaskState::Ready;
+            addToReadyQueue(from);
+        }
+    }
+    
+    removeFromReadyQueue(to);
+    handoffCount_++;
+    
+    if (currentTaskId_ != from && currentTaskId_ != INVALID_TASK_ID) {
+        target->state = TaskState::Ready;
+        addToReadyQueue(to, true);
+        return true;
+    }
+    
+    contextSwitch(source, target);
+    
+    currentTaskId_ = to;
+    target->state = TaskState::Running;
+    target->lastScheduledTime = std::chrono::steady_clock::now();
+    target->timeSliceRemaining = donated;
+    return true;
+}
+
 void Scheduler::schedule() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     TaskId nextTask = selectNextTask();
     
     if (nextTask == INVALID_TASK_ID) {
@@ -122,6 +175,8 @@ void Scheduler::schedule() {
 }
 
 void Scheduler::tick() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     tickCount_++;
     
     TaskControlBlock* current = getCurrentTask();
@@ -142,6 +197,8 @@ void Scheduler::tick() {
 }
 
 void Scheduler::yield() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     TaskControlBlock* current = getCurrentTask();
     if (current) {
         current->timeSliceRemaining = 0;
@@ -151,6 +208,8 @@ void Scheduler::yield() {
 }
 
 TaskControlBlock* Scheduler::getCurrentTask() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     if (currentTaskId_ == INVALID_TASK_ID) {
         return nullptr;
     }
@@ -159,11 +218,15 @@ TaskControlBlock* Scheduler::getCurrentTask() {
 }
 
 TaskControlBlock* Scheduler::getTask(TaskId id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     auto it = tasks_.find(id);
     return (it != tasks_.end()) ? it->second.get() : nullptr;
 }
 
 void Scheduler::setSchedulerType(SchedulerType type) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     if (type_ != type) {
         type_ = type;
         LOG_INFO("Scheduler", "Switched to " + 
@@ -172,6 +235,8 @@ void Scheduler::setSchedulerType(SchedulerType type) {
 }
 
 size_t Scheduler::getReadyQueueSize() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     if (type_ == SchedulerType::RoundRobin) {
         return readyQueue_.size();
     } else {
@@ -184,6 +249,8 @@ size_t Scheduler::getReadyQueueSize() const {
 }
 
 void Scheduler::printTaskStates() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     std::cout << "\n=== Task States ===" << std::endl;
     std::cout << std::setw(6) << "ID" << " | "
               << std::setw(15) << "Name" << " | "
@@ -203,6 +270,8 @@ void Scheduler::printTaskStates() const {
 }
 
 std::string Scheduler::getTaskReport() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    
     std::stringstream ss;
     ss << "=== Scheduler Report ===\n";
     ss << "Type: " << (type_ == SchedulerType::RoundRobin ? "Round-Robin" : "Priority") << "\n";
@@ -210,6 +279,7 @@ std::string Scheduler::getTaskReport() const {
     ss << "Ready Queue Size: " << getReadyQueueSize() << "\n";
     ss << "Current Task: " << (currentTaskId_ != INVALID_TASK_ID ? std::to_string(currentTaskId_) : "None") << "\n";
     ss << "Total Ticks: " << tickCount_ << "\n";
+    ss << "Direct Handoffs: " << handoffCount_ << "\n";
     return ss.str();
 }
 
@@ -247,17 +317,15 @@ TaskId Scheduler::selectPriority() {
     return INVALID_TASK_ID;
 }
 
-void Scheduler::addToReadyQueue(TaskId id) {
+void Scheduler::addToReadyQueue(TaskId id, bool front) {
     auto it = tasks_.find(id);
     if (it == tasks_.end()) return;
     
-    if (type_ == SchedulerType::RoundRobin) {
-        if (std::find(readyQueue_.begin(), readyQueue_.end(), id) == readyQueue_.end()) {
-            readyQueue_.push_back(id);
-        }
-    } else {
-        auto& queue = priorityQueues_[it->second->priority];
-        if (std::find(queue.begin(), queue.end(), id) == queue.end()) {
+    auto& queue = (type_ == SchedulerType::RoundRobin) ? readyQueue_ : priorityQueues_[it->second->priority];
+    if (std::find(queue.begin(), queue.end(), id) == queue.end()) {
+        if (front) {
+            queue.push_front(id);
+        } else {
             queue.push_back(id);
         }
     }
@@ -0,0 +1,410 @@
+#include "scheduler/uthread.hpp"
+#include "kernel/kernel.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace MiniOS {
+
+struct UThreadStack {
+    ucontext_t context;
+    std::unique_ptr<uint8_t[]> memory;
+};
+
+static thread_local UThreadRuntime* t_runtime = nullptr;
+static thread_local void* t_carrier = nullptr;
+
+// A UThread that parks on one carrier may resume on another, so the
+// thread-local must be re-read after every switch rather than cached by the
+// compiler across swapcontext().
+__attribute__((noinline)) UThreadRuntime::Carrier* UThreadRuntime::currentCarrier() {
+    return static_cast<Carrier*>(t_carrier);
+}
+
+UThreadRuntime::UThreadRuntime(const UThreadConfig& config)
+    : stackSize_(config.stackSize)
+    , nextId_(1)
+    , nextCarrier_(0)
+    , live_(0)
+    , stopping_(false)
+    , sleepers_(0)
+    , idleBlocking_(0)
+{
+    size_t count = std::max<size_t>(1, config.carriers);
+    for (size_t i = 0; i < count; ++i) {
+        auto carrier = std::make_unique<Carrier>();
+        carrier->index = i;
+        if (config.scheduler) {
+            carrier->task = config.scheduler->createTask("uthread-carrier-" + std::to_string(i), []() {});
+        }
+        carriers_.push_back(std::move(carrier));
+    }
+    for (auto& carrier : carriers_) {
+        carrier->thread = std::thread([this, c = carrier.get()]() { carrierLoop(*c); });
+    }
+    size_t helpers = std::clamp<size_t>(config.blockingThreads, 1, UTHREAD_MAX_BLOCKING_THREADS);
+    for (size_t i = 0; i < helpers; ++i) {
+        blockingThreads_.emplace_back([this]() { blockingLoop(); });
+    }
+
+    LOG_INFO("UThread", "Runtime started with " + std::to_string(count) + " carriers");
+}
+
+UThreadRuntime::~UThreadRuntime() {
+    waitAll();
+
+    stopping_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+    }
+    idleCondition_.notify_all();
+    for (auto& carrier : carriers_) {
+        carrier->thread.join();
+        for (UThreadStack* stack : carrier->freeStacks) {
+            delete stack;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(blockingMutex_);
+    }
+    blockingCondition_.notify_all();
+    // No UThread is left to start a helper, so the list is final.
+    for (auto& thread : blockingThreads_) {
+        thread.join();
+    }
+}
+
+UThreadId UThreadRuntime::spawn(std::function<void()> function) {
+    auto* thread = new UThread;
+    thread->id = nextId_.fetch_add(1, std::memory_order_relaxed);
+    thread->function = std::move(function);
+    thread->state.store(UThreadState::Runnable, std::memory_order_relaxed);
+    thread->permit.store(false, std::memory_order_relaxed);
+    thread->refs.store(1, std::memory_order_relaxed);
+    thread->runtime = this;
+    thread->stack = nullptr;
+    live_.fetch_add(1, std::memory_order_relaxed);
+
+    // Children stay on their parent's carrier; siblings steal them if idle.
+    Carrier* local = currentCarrier();
+    size_t target = local && t_runtime == this
+        ? local->index
+        : nextCarrier_.fetch_add(1, std::memory_order_relaxed) % carriers_.size();
+    thread->carrier = target;
+    // Once queued the thread may be stolen, run and freed at any moment.
+    UThreadId id = thread->id;
+    enqueue(target, thread);
+    return id;
+}
+
+void UThreadRuntime::waitAll() {
+    std::unique_lock<std::mutex> lock(doneMutex_);
+    doneCondition_.wait(lock, [this]() { return live_.load(std::memory_order_acquire) == 0; });
+}
+
+void UThreadRuntime::enqueue(size_t index, UThread* thread) {
+    Carrier& carrier = *carriers_[index];
+    {
+        std::lock_guard<std::mutex> lock(carrier.mutex);
+        carrier.queue.push_back(thread);
+    }
+    if (sleepers_.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        idleCondition_.notify_one();
+    }
+}
+
+UThread* UThreadRuntime::next(Carrier& carrier) {
+    {
+        std::lock_guard<std::mutex> lock(carrier.mutex);
+        if (!carrier.queue.empty()) {
+            UThread* thread = carrier.queue.front();
+            carrier.queue.pop_front();
+            return thread;
+        }
+    }
+    return steal(carrier);
+}
+
+// Takes up to half of a victim's queue from its back, the end its owner
+// reaches last. The first stolen thread is returned to run right away.
+UThread* UThreadRuntime::steal(Carrier& thief) {
+    size_t count = carriers_.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Carrier& victim = *carriers_[(thief.index + offset) % count];
+        std::vector<UThread*> taken;
+        {
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || victim.queue.empty()) {
+                continue;
+            }
+            size_t amount = std::min(UTHREAD_STEAL_BATCH, (victim.queue.size() + 1) / 2);
+            for (size_t i = 0; i < amount; ++i) {
+                taken.push_back(victim.queue.back());
+                victim.queue.pop_back();
+            }
+        }
+
+        thief.steals.fetch_add(taken.size(), std::memory_order_relaxed);
+        if (taken.size() > 1) {
+            std::lock_guard<std::mutex> lock(thief.mutex);
+            for (size_t i = taken.size(); i-- > 1;) {
+                taken[i]->carrier = thief.index;
+                thief.queue.push_back(taken[i]);
+            }
+        }
+        taken[0]->carrier = thief.index;
+        return taken[0];
+    }
+    return nullptr;
+}
+
+void UThreadRuntime::carrierLoop(Carrier& carrier) {
+    t_runtime = this;
+    t_carrier = &carrier;
+
+    while (true) {
+        UThread* thread = next(carrier);
+        if (thread) {
+            dispatch(carrier, thread);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        if (stopping_.load(std::memory_order_acquire)) {
+            break;
+        }
+        sleepers_.fetch_add(1, std::memory_order_acq_rel);
+        // Spawns only notify when they see a sleeper, so the timeout covers
+        // a push that raced with the increment above.
+        idleCondition_.wait_for(lock, std::chrono::milliseconds(1));
+        sleepers_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    t_runtime = nullptr;
+    t_carrier = nullptr;
+}
+
+void UThreadRuntime::dispatch(Carrier& carrier, UThread* thread) {
+    if (!thread->stack) {
+        thread->stack = acquireStack(carrier);
+        getcontext(&thread->stack->context);
+        thread->stack->context.uc_stack.ss_sp = thread->stack->memory.get();
+        thread->stack->context.uc_stack.ss_size = stackSize_;
+        thread->stack->context.uc_link = nullptr;
+        makecontext(&thread->stack->context, &UThreadRuntime::trampoline, 0);
+    }
+
+    thread->state.store(UThreadState::Running, std::memory_order_relaxed);
+    carrier.current = thread;
+    carrier.switches.fetch_add(1, std::memory_order_relaxed);
+    swapcontext(&carrier.context, &thread->stack->context);
+    carrier.current = nullptr;
+
+    switch (carrier.reason) {
+        case SwitchReason::Yield:
+            thread->state.store(UThreadState::Runnable, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(carrier.mutex);
+                carrier.queue.push_back(thread);
+            }
+            break;
+
+        case SwitchReason::Park:
+            // Whoever moves Parked -> Runnable first requeues the thread; an
+            // unpark that landed while it was still switching out shows up
+            // as the permit.
+            thread->state.store(UThreadState::Parked, std::memory_order_seq_cst);
+            if (thread->permit.load(std::memory_order_seq_cst)) {
+                UThreadState expected = UThreadState::Parked;
+                if (thread->state.compare_exchange_strong(expected, UThreadState::Runnable)) {
+                    thread->permit.store(false, std::memory_order_relaxed);
+                    enqueue(carrier.index, thread);
+                }
+            }
+            break;
+
+        case SwitchReason::Exit:
+            thread->state.store(UThreadState::Done, std::memory_order_release);
+            releaseStack(carrier, thread->stack);
+            thread->stack = nullptr;
+            thread->function = nullptr;
+            release(thread);
+            if (live_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(doneMutex_);
+                doneCondition_.notify_all();
+            }
+            break;
+    }
+}
+
+void UThreadRuntime::release(UThread* thread) {
+    if (thread->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete thread;
+    }
+}
+
+UThreadStack* UThreadRuntime::acquireStack(Carrier& carrier) {
+    if (!carrier.freeStacks.empty()) {
+        UThreadStack* stack = carrier.freeStacks.back();
+        carrier.freeStacks.pop_back();
+        return stack;
+    }
+    auto* stack = new UThreadStack;
+    // Left uninitialised so that only the pages the thread touches, the top
+    // one or two for most, become resident.
+    stack->memory.reset(new uint8_t[stackSize_]);
+    return stack;
+}
+
+void UThreadRuntime::releaseStack(Carrier& carrier, UThreadStack* stack) {
+    if (carrier.freeStacks.size() < UTHREAD_STACK_CACHE) {
+        carrier.freeStacks.push_back(stack);
+    } else {
+        delete stack;
+    }
+}
+
+void UThreadRuntime::trampoline() {
+    UThread* self = currentCarrier()->current;
+    try {
+        self->function();
+    } catch (const std::exception& e) {
+        LOG_ERROR("UThread", "Thread " + std::to_string(self->id) + " threw: " + e.what());
+    }
+    switchOut(SwitchReason::Exit);
+}
+
+// Returns to the carrier's dispatch loop. The carrier is looked up again on
+// resume because a stolen thread continues on a different host thread.
+void UThreadRuntime::switchOut(SwitchReason reason) {
+    Carrier* carrier = currentCarrier();
+    UThread* self = carrier->current;
+    carrier->reason = reason;
+    swapcontext(&self->stack->context, &carrier->context);
+}
+
+UThread* UThreadRuntime::current() {
+    Carrier* carrier = currentCarrier();
+    return carrier ? carrier->current : nullptr;
+}
+
+void UThreadRuntime::yield() {
+    if (!current()) {
+        std::this_thread::yield();
+        return;
+    }
+    switchOut(SwitchReason::Yield);
+}
+
+void UThreadRuntime::park() {
+    UThread* self = current();
+    if (!self || self->permit.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    switchOut(SwitchReason::Park);
+}
+
+void UThreadRuntime::unpark(UThread* thread) {
+    thread->permit.store(true, std::memory_order_seq_cst);
+    UThreadState expected = UThreadState::Parked;
+    if (thread->state.compare_exchange_strong(expected, UThreadState::Runnable)) {
+        thread->permit.store(false, std::memory_order_relaxed);
+        thread->runtime->enqueue(thread->carrier, thread);
+    }
+}
+
+void UThreadRuntime::runBlocking(std::function<void()> job) {
+    UThread* self = current();
+    if (!self) {
+        job();
+        return;
+    }
+
+    UThreadRuntime* runtime = self->runtime;
+    std::atomic<bool> done{false};
+    self->refs.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(runtime->blockingMutex_);
+        runtime->blockingJobs_.push_back([runtime, self, &job, &done]() {
+            job();
+            done.store(true, std::memory_order_release);
+            unpark(self);
+            runtime->release(self);
+        });
+        if (runtime->idleBlocking_ < runtime->blockingJobs_.size() &&
+            runtime->blockingThreads_.size() < UTHREAD_MAX_BLOCKING_THREADS) {
+            runtime->blockingThreads_.emplace_back([runtime]() { runtime->blockingLoop(); });
+        }
+    }
+    runtime->blockingCondition_.notify_one();
+
+    while (!done.load(std::memory_order_acquire)) {
+        park();
+    }
+}
+
+void UThreadRuntime::blockingLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(blockingMutex_);
+            idleBlocking_++;
+            blockingCondition_.wait(lock, [this]() {
+                return !blockingJobs_.empty() || stopping_.load(std::memory_order_acquire);
+            });
+            idleBlocking_--;
+            if (blockingJobs_.empty()) {
+                return;
+            }
+            job = std::move(blockingJobs_.front());
+            blockingJobs_.pop_front();
+        }
+        job();
+    }
+}
+
+int64_t UThreadRuntime::syscall(SystemCallId id, uint64_t arg1, uint64_t arg2, uint64_t arg3) {
+    return blocking([=]() { return SystemCall::dispatch(id, arg1, arg2, arg3); });
+}
+
+size_t UThreadRuntime::getBlockingThreadCount() const {
+    std::lock_guard<std::mutex> lock(blockingMutex_);
+    return blockingThreads_.size();
+}
+
+uint64_t UThreadRuntime::getSwitchCount() const {
+    uint64_t total = 0;
+    for (const auto& carrier : carriers_) {
+        total += carrier->switches.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t UThreadRuntime::getStealCount() const {
+    uint64_t total = 0;
+    for (const auto& carrier : carriers_) {
+        total += carrier->steals.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string UThreadRuntime::getRuntimeReport() const {
+    std::stringstream ss;
+    ss << "=== UThread Runtime Report ===\n";
+    ss << "Live Threads: " << getLiveCount() << "\n";
+    ss << "Spawned: " << nextId_.load(std::memory_order_relaxed) - 1 << "\n";
+    ss << "Stack Size: " << stackSize_ << " bytes\n";
+    ss << "Blocking Threads: " << getBlockingThreadCount() << "\n";
+    for (const auto& carrier : carriers_) {
+        ss << "  Carrier " << carrier->index;
+        if (carrier->task != INVALID_TASK_ID) {
+            ss << " (task " << carrier->task << ")";
+        }
+        ss << ": " << carrier->switches.load(std::memory_order_relaxed) << " switches, "
+           << carrier->steals.load(std::memory_order_relaxed) << " stolen\n";
+    }
+    return ss.str();
+}
+
+}
@@ -0,0 +1,745 @@
+#include "drivers/driver.hpp"
+#include "drivers/block.hpp"
+#include "drivers/elevator.hpp"
+#include "drivers/network.hpp"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <array>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+
+using namespace MiniOS;
+
+void test_vector_table() {
+    std::cout << "Testing interrupt vector table... ";
+
+    InterruptController controller;
+    int timerCount = 0;
+    void* lastData = nullptr;
+
+    assert(controller.registerHandler(0, [&](InterruptNumber num, void* data) {
+        assert(num == 0);
+        timerCount++;
+        lastData = data;
+    }, "Timer"));
+    assert(!controller.registerHandler(0, [](InterruptNumber, void*) {}, "Duplicate"));
+    assert(!controller.registerHandler(INTERRUPT_VECTORS, [](InterruptNumber, void*) {}, "OutOfRange"));
+
+    controller.triggerInterrupt(0);
+    assert(timerCount == 0);
+
+    controller.enableInterrupts();
+    int value = 7;
+    controller.triggerInterrupt(0, &value);
+    assert(timerCount == 1);
+    assert(lastData == &value);
+
+    controller.disableInterrupt(0);
+    assert(!controller.isEnabled(0));
+    controller.triggerInterrupt(0);
+    assert(timerCount == 1);
+    controller.enableInterrupt(0);
+    controller.triggerInterrupt(0);
+    assert(timerCount == 2);
+
+    uint64_t rawCount = 0;
+    assert(controller.registerHandler(255, [](InterruptNumber num, void* context, void*) {
+        assert(num == 255);
+        (*static_cast<uint64_t*>(context))++;
+    }, &rawCount, "Raw"));
+    for (int i = 0; i < 100; ++i) {
+        controller.triggerInterrupt(255);
+    }
+    assert(rawCount == 100);
+
+    controller.triggerInterrupt(42);
+    controller.triggerInterrupt(1000);
+
+    assert(controller.unregisterHandler(255));
+    assert(!controller.unregisterHandler(255));
+    assert(!controller.isEnabled(255));
+    controller.triggerInterrupt(255);
+    assert(rawCount == 100);
+    assert(controller.registerHandler(255, [](InterruptNumber, void*) {}, "Reused"));
+
+    std::cout << "PASSED\n";
+}
+
+void test_softirq_batching() {
+    std::cout << "Testing softirq bottom halves... ";
+
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    int pendingPackets = 0;
+    int processed = 0;
+    int batches = 0;
+    assert(controller.openSoftirq(SoftirqId::NetRx, [&]() {
+        batches++;
+        processed += pendingPackets;
+        pendingPackets = 0;
+    }, "NetRx"));
+    assert(!controller.openSoftirq(SoftirqId::NetRx, []() {}, "NetRx"));
+
+    controller.registerHandler(3, [&](InterruptNumber, void*) {
+        pendingPackets++;
+        controller.raiseSoftirq(SoftirqId::NetRx);
+    }, "Network");
+
+    assert(!controller.hasPendingSoftirqs());
+    assert(controller.runSoftirqs() == 0);
+
+    for (int i = 0; i < 50; ++i) {
+        controller.triggerInterrupt(3);
+    }
+    assert(processed == 0);
+    assert(controller.hasPendingSoftirqs());
+    assert(controller.runSoftirqs() == 1);
+    assert(processed == 50);
+    assert(batches == 1);
+    assert(!controller.hasPendingSoftirqs());
+
+    // A handler that keeps re-raising itself is cut off and resumed later.
+    int reraised = 0;
+    controller.openSoftirq(SoftirqId::Block, [&]() {
+        if (++reraised < 100) {
+            controller.raiseSoftirq(SoftirqId::Block);
+        }
+    }, "Block");
+    controller.raiseSoftirq(SoftirqId::Block);
+    assert(controller.runSoftirqs() == SOFTIRQ_MAX_RESTART);
+    assert(controller.hasPendingSoftirqs());
+    while (controller.runSoftirqs() > 0) {
+    }
+    assert(reraised == 100);
+
+    std::atomic<int> raisedByDevice{0};
+    std::atomic<bool> stop{false};
+    int drained = 0;
+    controller.openSoftirq(SoftirqId::Timer, [&]() { drained++; }, "Timer");
+    std::thread device([&]() {
+        for (int i = 0; i < 10000; ++i) {
+            controller.raiseSoftirq(SoftirqId::Timer);
+            raisedByDevice++;
+        }
+        stop = true;
+    });
+    while (!stop) {
+        controller.runSoftirqs();
+    }
+    device.join();
+    controller.runSoftirqs();
+    assert(drained > 0 && drained <= raisedByDevice);
+    assert(!controller.hasPendingSoftirqs());
+
+    std::cout << "PASSED\n";
+}
+
+void test_tasklets() {
+    std::cout << "Testing tasklets... ";
+
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    std::vector<int> order;
+    Tasklet first([&]() { order.push_back(1); });
+    Tasklet second([&]() { order.push_back(2); });
+
+    controller.registerHandler(1, [&](InterruptNumber, void*) {
+        controller.scheduleTasklet(first);
+        controller.scheduleTasklet(second);
+    }, "Keyboard");
+
+    for (int i = 0; i < 10; ++i) {
+        controller.triggerInterrupt(1);
+    }
+    assert(order.empty());
+    assert(controller.runSoftirqs() == 1);
+    assert((order == std::vector<int>{1, 2}));
+    assert(first.runCount == 1);
+    assert(!first.scheduled);
+
+    int reruns = 0;
+    Tasklet* selfRef = nullptr;
+    Tasklet again([&]() {
+        if (++reruns < 3) {
+            controller.scheduleTasklet(*selfRef);
+        }
+    });
+    selfRef = &again;
+    controller.scheduleTasklet(again);
+    controller.runSoftirqs();
+    assert(reruns == 3);
+    assert(again.runCount == 3);
+
+    std::cout << "PASSED\n";
+}
+
+void test_interrupt_coalescing() {
+    std::cout << "Testing interrupt coalescing... ";
+
+    InterruptController controller;
+    controller.enableInterrupts();
+
+    std::vector<uint32_t> batches;
+    CoalescingPolicy fixed;
+    fixed.maxEvents = 4;
+    fixed.maxDelay = std::chrono::microseconds(500);
+    assert(controller.registerCoalescedHandler(2, [&](InterruptNumber num, uint32_t events) {
+        assert(num == 2);
+        batches.push_back(events);
+    }, fixed, "Disk"));
+
+    for (int i = 0; i < 10; ++i) {
+        controller.triggerInterrupt(2);
+    }
+    assert((batches == std::vector<uint32_t>{4, 4}));
+
+    auto now = std::chrono::steady_clock::now();
+    assert(controller.pollCoalescing(now) == 0);
+    assert(controller.pollCoalescing(now + std::chrono::milliseconds(1)) == 1);
+    assert((batches == std::vector<uint32_t>{4, 4, 2}));
+    assert(controller.pollCoalescing(now + std::chrono::milliseconds(2)) == 0);
+
+    auto stats = controller.getCoalescingStats(2);
+    assert(stats && stats->events == 10 && stats->deliveries == 3 && stats->threshold == 4);
+    assert(!controller.getCoalescingStats(3));
+
+    CoalescingPolicy adaptive;
+    adaptive.maxEvents = 64;
+    adaptive.maxDelay = std::chrono::microseconds(200);
+    adaptive.adaptive = true;
+    adaptive.targetRate = 1000;
+    CoalescingPolicy noDelay = adaptive;
+    noDelay.maxDelay = std::chrono::microseconds(0);
+    assert(!controller.setCoalescingPolicy(2, noDelay));
+    assert(controller.setCoalescingPolicy(2, adaptive));
+    assert(controller.getCoalescingStats(2)->threshold == 1);
+
+    // A quiet device is delivered one event at a time.
+    batches.clear();
+    controller.triggerInterrupt(2);
+    assert((batches == std::vector<uint32_t>{1}));
+
+    // Under a flood the threshold climbs to the ceiling.
+    batches.clear();
+    for (int i = 0; i < 100000; ++i) {
+        controller.triggerInterrupt(2);
+    }
+    auto later = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    controller.pollCoalescing(later);
+    assert(controller.getCoalescingStats(2)->threshold == 64);
+    uint64_t delivered = 0;
+    for (uint32_t events : batches) {
+        delivered += events;
+    }
+    assert(delivered == 100000);
+    assert(batches.size() < 100000 / 16);
+
+    // Once the flood stops, the rate estimate falls back within a few
+    // timer-driven deliveries.
+    for (int i = 0; i < 20 && controller.getCoalescingStats(2)->threshold > 1; ++i) {
+        controller.triggerInterrupt(2);
+        later += std::chrono::milliseconds(50);
+        controller.pollCoalescing(later);
+    }
+    assert(controller.getCoalescingStats(2)->threshold == 1);
+
+    assert(controller.unregisterHandler(2));
+    assert(!controller.getCoalescingStats(2));
+
+    // Unregistering while another CPU is inside the vector waits for it, and
+    // nothing runs the handler once it returns.
+    InterruptController racing(2);
+    std::atomic<int> active{0};
+    std::atomic<uint64_t> calls{0};
+    fixed.maxEvents = 2;
+    assert(racing.registerCoalescedHandler(4, [&](InterruptNumber, uint32_t) {
+        active++;
+        calls++;
+        active--;
+    }, fixed, "Racing"));
+    std::atomic<bool> stop{false};
+    std::thread cpu1([&]() {
+        InterruptController::setCurrentCpu(1);
+        racing.enableInterrupts();
+        while (!stop) {
+            racing.triggerInterrupt(4);
+            racing.pollCoalescing(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+        }
+    });
+    while (calls < 100) {
+        std::this_thread::yield();
+    }
+    assert(racing.unregisterHandler(4));
+    assert(active == 0);
+    uint64_t settled = calls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    assert(calls == settled);
+    stop = true;
+    cpu1.join();
+
+    std::cout << "PASSED\n";
+}
+
+void test_per_cpu_interrupts() {
+    std::cout << "Testing per-CPU interrupt routing... ";
+
+    const size_t cpuCount = 4;
+    const int perCpu = 20000;
+    InterruptController controller(cpuCount);
+    assert(controller.getCpuCount() == cpuCount);
+
+    std::atomic<uint64_t> handled{0};
+    std::array<std::atomic<int>, cpuCount> seenOn{};
+    controller.registerHandler(3, [&](InterruptNumber, void*) {
+        handled++;
+        seenOn[InterruptController::currentCpu()]++;
+    }, "Network");
+    controller.registerHandler(2, [&](InterruptNumber, void*) {
+        seenOn[InterruptController::currentCpu()]++;
+    }, "Disk");
+
+    assert(controller.getAffinity(3) == 0xF);
+    assert(!controller.setAffinity(2, 0x30));
+    assert(controller.setAffinity(2, 0x4));
+
+    // CPU 0 is enabled, the rest are not yet.
+    controller.enableInterrupts();
+    std::thread idle([&]() {
+        InterruptController::setCurrentCpu(1);
+        assert(!controller.areInterruptsEnabled());
+        controller.triggerInterrupt(3);
+    });
+    idle.join();
+    assert(handled == 0);
+
+    // A device raising the disk IRQ from CPU 0 is routed to CPU 2.
+    auto target = controller.raiseInterrupt(2);
+    assert(target && *target == 2);
+    assert(controller.handlePendingInterrupts() == 0);
+    assert(controller.raiseInterrupt(3) == 0);
+
+    std::atomic<int> rescheduled{0};
+    controller.setIpiHandler(IpiType::Reschedule, [&](CpuId cpu) {
+        assert(cpu == InterruptController::currentCpu());
+        rescheduled++;
+    });
+    std::atomic<int> calledOn{-1};
+
+    std::atomic<bool> start{false};
+    std::atomic<size_t> ready{0};
+    std::vector<std::thread> cpus;
+    for (CpuId c = 1; c < cpuCount; ++c) {
+        cpus.emplace_back([&, c]() {
+            InterruptController::setCurrentCpu(c);
+            controller.enableInterrupts();
+            ready++;
+            while (!start) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < perCpu; ++i) {
+                controller.triggerInterrupt(3);
+            }
+            while (rescheduled < 1 || calledOn < 0) {
+                controller.handlePendingInterrupts();
+                std::this_thread::yield();
+            }
+            controller.handlePendingInterrupts();
+        });
+    }
+    while (ready < cpuCount - 1) {
+        std::this_thread::yield();
+    }
+    start = true;
+    for (int i = 0; i < perCpu; ++i) {
+        controller.triggerInterrupt(3);
+    }
+    assert(controller.handlePendingInterrupts() == 1);
+    assert(controller.sendIpi(1, IpiType::Reschedule));
+    assert(!controller.sendIpi(cpuCount, IpiType::Reschedule));
+    assert(controller.callOnCpu(3, [&]() { calledOn = InterruptController::currentCpu(); }));
+    for (auto& cpu : cpus) {
+        cpu.join();
+    }
+
+    assert(handled == cpuCount * perCpu + 1);
+    assert(controller.getInterruptCount(3) == cpuCount * perCpu + 1);
+    assert(controller.getInterruptCount(3, 0) == perCpu + 1);
+    assert(controller.getInterruptCount(3, 1) == perCpu);
+    assert(controller.getInterruptCount(2, 2) == 1);
+    assert(seenOn[2] == perCpu + 1);
+    assert(rescheduled == 1);
+    assert(calledOn == 3);
+
+    std::string report = controller.getInterruptReport();
+    assert(report.find("CPUs: 4 (interrupts enabled on 4)") != std::string::npos);
+    assert(report.find("CPU 3:") != std::string::npos);
+
+    std::cout << "PASSED\n";
+}
+
+void test_block_queue() {
+    std::cout << "Testing block request queue... ";
+
+    RamDisk disk("ram-test", 256);
+    assert(disk.getType() == DriverType::Block);
+    assert(disk.init());
+    BlockQueue queue(disk, 1, 64);
+
+    // Eight adjacent 4 KB writes submitted out of order become one request.
+    std::vector<uint8_t> data(8 * PAGE_SIZE);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+    int completed = 0;
+    for (int page : {3, 0, 7, 1, 2, 6, 4, 5}) {
+        Bio bio;
+        bio.op = BlockOp::Write;
+        bio.sector = page * (PAGE_SIZE / SECTOR_SIZE);
+        bio.segments.push_back({data.data() + page * PAGE_SIZE, PAGE_SIZE});
+        bio.onComplete = [&completed](BlockStatus status) {
+            assert(status == BlockStatus::Ok);
+            completed++;
+        };
+        assert(queue.submit(std::move(bio)));
+    }
+    assert(completed == 0);
+    assert(queue.unplug() == 1);
+    assert(completed == 8);
+    BlockQueueStats stats = queue.getStats();
+    assert(stats.bios == 8 && stats.requests == 1 && stats.merges == 7);
+    assert(stats.sectors == 64);
+
+    // Scatter-gather read spanning two buffers.
+    std::vector<uint8_t> head(SECTOR_SIZE * 3);
+    std::vector<uint8_t> tail(SECTOR_SIZE * 5);
+    Bio read;
+    read.op = BlockOp::Read;
+    read.sector = 4;
+    read.segments.push_back({head.data(), static_cast<uint32_t>(head.size())});
+    read.segments.push_back({tail.data(), static_cast<uint32_t>(tail.size())});
+    assert(queue.submitAndWait(std::move(read)) == BlockStatus::Ok);
+    assert(std::equal(head.begin(), head.end(), data.begin() + 4 * SECTOR_SIZE));
+    assert(std::equal(tail.begin(), tail.end(), data.begin() + 7 * SECTOR_SIZE));
+
+    // Reads and writes never merge with each other, or across a flush.
+    uint8_t sector[SECTOR_SIZE] = {};
+    for (int i = 0; i < 3; ++i) {
+        Bio bio;
+        bio.op = i == 1 ? BlockOp::Read : BlockOp::Write;
+        bio.sector = 100 + i;
+        bio.segments.push_back({sector, SECTOR_SIZE});
+        queue.submit(std::move(bio));
+    }
+    Bio flush;
+    flush.op = BlockOp::Flush;
+    queue.submit(std::move(flush));
+    Bio after;
+    after.op = BlockOp::Write;
+    after.sector = 103;
+    after.segments.push_back({sector, SECTOR_SIZE});
+    queue.submit(std::move(after));
+    assert(queue.run() == 5);
+
+    Bio outside;
+    outside.op = BlockOp::Read;
+    outside.sector = 255;
+    outside.segments.push_back({sector, 2 * SECTOR_SIZE});
+    assert(!queue.submit(std::move(outside)));
+    // Sectors near UINT64_MAX must not wrap around the range check.
+    for (SectorNumber start : {UINT64_MAX - 1, UINT64_MAX - 7, UINT64_MAX}) {
+        Bio wrapping;
+        wrapping.op = BlockOp::Write;
+        wrapping.sector = start;
+        wrapping.segments.push_back({data.data(), PAGE_SIZE});
+        assert(!queue.submit(std::move(wrapping)));
+
+        Bio direct;
+        direct.op = BlockOp::Write;
+        direct.sector = start;
+        direct.segments.push_back({data.data(), PAGE_SIZE});
+        BlockRequest request{BlockOp::Write, start, PAGE_SIZE / SECTOR_SIZE, 0, {}};
+        request.bios.push_back(std::move(direct));
+        assert(disk.execute(0, request) == BlockStatus::OutOfRange);
+    }
+
+    Bio partial;
+    partial.op = BlockOp::Read;
+    partial.segments.push_back({sector, 100});
+    assert(!queue.submit(std::move(partial)));
+
+    // The byte-stream Driver interface reads whole sectors at a seek offset.
+    uint64_t offset = PAGE_SIZE;
+    uint64_t sectors = 0;
+    assert(disk.ioctl(BLOCK_IOCTL_GET_SECTORS, &sectors) && sectors == 256);
+    assert(disk.ioctl(BLOCK_IOCTL_SEEK, &offset));
+    std::vector<uint8_t> stream(PAGE_SIZE);
+    assert(disk.read(stream.data(), stream.size()) == static_cast<ssize_t>(PAGE_SIZE));
+    assert(std::equal(stream.begin(), stream.end(), data.begin() + PAGE_SIZE));
+    assert(disk.read(stream.data(), 100) == -1);
+
+    std::string path = "/tmp/minios-block-test-" + std::to_string(::getpid()) + ".img";
+    {
+        FileBlockDevice file("file-test", path, 64, 2);
+        assert(file.init());
+        BlockQueue fileQueue(file, 2);
+        Bio bio;
+        bio.op = BlockOp::Write;
+        bio.sector = 8;
+        bio.segments.push_back({data.data(), PAGE_SIZE});
+        assert(fileQueue.submitAndWait(std::move(bio)) == BlockStatus::Ok);
+        BlockRequest wrapping{BlockOp::Read, UINT64_MAX - 1, PAGE_SIZE / SECTOR_SIZE, 0, {}};
+        assert(file.execute(0, wrapping) == BlockStatus::OutOfRange);
+        Bio sync;
+        sync.op = BlockOp::Flush;
+        assert(fileQueue.submitAndWait(std::move(sync)) == BlockStatus::Ok);
+        assert(file.shutdown());
+    }
+    {
+        FileBlockDevice file("file-test", path, 64);
+        assert(file.init());
+        BlockQueue fileQueue(file);
+        std::vector<uint8_t> back(PAGE_SIZE);
+        Bio bio;
+        bio.op = BlockOp::Read;
+        bio.sector = 8;
+        bio.segments.push_back({back.data(), PAGE_SIZE});
+        assert(fileQueue.submitAndWait(std::move(bio)) == BlockStatus::Ok);
+        assert(std::equal(back.begin(), back.end(), data.begin()));
+    }
+    ::unlink(path.c_str());
+
+    std::cout << "PASSED\n";
+}
+
+BlockRequest makeRequest(BlockOp op, SectorNumber sector, uint32_t sectors, TaskId task = 0) {
+    return BlockRequest{op, sector, sectors, task, {}};
+}
+
+void test_io_schedulers() {
+    std::cout << "Testing I/O schedulers... ";
+
+    auto now = std::chrono::steady_clock::now();
+
+    // Deadline sweeps upward by sector until a FIFO deadline passes.
+    DeadlineElevator sorted(std::chrono::seconds(1), std::chrono::seconds(1), 1);
+    for (SectorNumber sector : {30, 10, 20}) {
+        sorted.insert(makeRequest(BlockOp::Read, sector, 1), now);
+    }
+    assert(sorted.size() == 3);
+    for (SectorNumber sector : {10, 20, 30}) {
+        assert(sorted.dispatch(now)->sector == sector);
+    }
+    assert(!sorted.dispatch(now));
+
+    DeadlineElevator expired(std::chrono::seconds(1), std::chrono::seconds(1), 1);
+    for (SectorNumber sector : {30, 10, 20}) {
+        expired.insert(makeRequest(BlockOp::Read, sector, 1), now);
+    }
+    auto later = now + std::chrono::seconds(2);
+    for (SectorNumber sector : {30, 10, 20}) {
+        assert(expired.dispatch(later)->sector == sector);
+    }
+
+    // Reads go first, but writes are only passed over writesStarved times.
+    DeadlineElevator mixed(std::chrono::seconds(1), std::chrono::seconds(5), 1, 2);
+    mixed.insert(makeRequest(BlockOp::Write, 0, 1), now);
+    for (SectorNumber sector : {10, 20, 30}) {
+        mixed.insert(makeRequest(BlockOp::Read, sector, 1), now);
+    }
+    assert(mixed.dispatch(now)->op == BlockOp::Read);
+    assert(mixed.dispatch(now)->op == BlockOp::Read);
+    assert(mixed.dispatch(now)->op == BlockOp::Write);
+    assert(mixed.dispatch(now)->op == BlockOp::Read);
+
+    // A light task is not stuck behind a streaming one.
+    BudgetFairElevator fair(128);
+    for (SectorNumber i = 0; i < 20; ++i) {
+        fair.insert(makeRequest(BlockOp::Read, i * 64, 64, 1), now);
+    }
+    fair.insert(makeRequest(BlockOp::Read, 5000, 8, 2), now);
+    fair.insert(makeRequest(BlockOp::Read, 9000, 8, 2), now);
+    size_t lastLight = 0;
+    for (size_t i = 0; i < 22; ++i) {
+        if (fair.dispatch(now)->task == 2) {
+            lastLight = i;
+        }
+    }
+    assert(lastLight < 4);
+    assert(fair.size() == 0);
+
+    // Backlogged tasks share the device in proportion to their weights.
+    BudgetFairElevator weighted(64);
+    weighted.setWeight(1, 3);
+    for (SectorNumber i = 0; i < 100; ++i) {
+        weighted.insert(makeRequest(BlockOp::Write, i * 64, 64, 1), now);
+        weighted.insert(makeRequest(BlockOp::Write, 10000 + i * 64, 64, 2), now);
+    }
+    size_t heavy = 0;
+    for (size_t i = 0; i < 40; ++i) {
+        heavy += weighted.dispatch(now)->task == 1;
+    }
+    assert(heavy >= 28 && heavy <= 32);
+
+    // Through a queue: deadline serves reads ahead of earlier writes, and
+    // switching elevators keeps what is still queued.
+    RamDisk disk("sched-test", 256);
+    assert(disk.init());
+    BlockQueue queue(disk, 1, 64);
+    assert(queue.getElevatorName() == "noop");
+    assert(queue.setElevator("deadline"));
+    assert(!queue.setElevator("cfq"));
+    queue.setQueueDepth(1);
+
+    uint8_t sector[SECTOR_SIZE] = {};
+    std::vector<BlockOp> completions;
+    for (int i = 0; i < 8; ++i) {
+        Bio bio;
+        bio.op = i % 2 ? BlockOp::Read : BlockOp::Write;
+        bio.sector = i * 8;
+        bio.task = i % 2 ? 20 : 10;
+        bio.segments.push_back({sector, SECTOR_SIZE});
+        bio.onComplete = [&completions, op = bio.op](BlockStatus) { completions.push_back(op); };
+        assert(queue.submit(std::move(bio)));
+    }
+    assert(queue.unplug() == 1);
+    assert(queue.getPendingRequests() == 7);
+    assert(queue.setElevator("bfq"));
+    assert(queue.getElevatorName() == "bfq");
+    assert(queue.getPendingRequests() == 7);
+    assert(queue.setElevator("deadline"));
+    assert(queue.run() == 7);
+    assert(queue.getPendingRequests() == 0);
+    assert(completions.size() == 8);
+    assert(std::count(completions.begin(), completions.begin() + 4, BlockOp::Read) == 4);
+
+    auto reads = queue.getTaskStats(20);
+    assert(reads && reads->ios == 4 && reads->sectors == 4);
+    assert(reads->maxLatencyNs > 0 && reads->latencyPercentile(0.5) > 0);
+    assert(queue.getTaskStats(10)->ios == 4);
+    assert(!queue.getTaskStats(30));
+    assert(queue.getQueueReport().find("task 20") != std::string::npos);
+
+    std::cout << "PASSED\n";
+}
+
+void test_virtual_nic() {
+    std::cout << "Testing virtual NIC and NAPI polling... ";
+
+    DescriptorRing ring(5);
+    assert(ring.capacity() == 8);
+    PacketDescriptor descriptors[10] = {};
+    for (uint32_t i = 0; i < 10; ++i) {
+        descriptors[i].frame = i;
+    }
+    assert(ring.push(descriptors, 10) == 8);
+    assert(ring.pop(descriptors, 3) == 3 && descriptors[2].frame == 2);
+    assert(ring.size() == 5);
+
+    // A NIC on its own loops back; with no handler packets wait for read().
+    auto pool = std::make_shared<FramePool>(1024);
+    VirtualNic lo("lo-test", pool);
+    assert(lo.getType() == DriverType::Network);
+    assert(lo.init());
+    assert(lo.write("hello", 5) == 5);
+    assert(lo.poll(NAPI_WEIGHT) == 1);
+    char text[16] = {};
+    assert(lo.read(text, sizeof(text)) == 5 && std::string(text) == "hello");
+    assert(lo.read(text, sizeof(text)) == 0);
+    uint32_t frameSize = 0;
+    assert(lo.ioctl(NET_IOCTL_GET_FRAME_SIZE, &frameSize) && frameSize == FRAME_SIZE);
+
+    // Attached to a stack: one interrupt, then NAPI polling from NetRx.
+    InterruptController controller;
+    controller.enableInterrupts();
+    NetworkStack stack(controller);
+    constexpr InterruptNumber NIC_IRQ = 40;
+    assert(stack.attach(lo, NIC_IRQ));
+    assert(!stack.attach(lo, NIC_IRQ + 1));
+
+    uint32_t expected = 0;
+    size_t received = 0;
+    lo.setReceiveHandler([&](const PacketView* packets, size_t count) {
+        assert(count <= NAPI_WEIGHT);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t value;
+            assert(packets[i].length == sizeof(value));
+            std::memcpy(&value, packets[i].data, sizeof(value));
+            assert(value == expected++);
+        }
+        received += count;
+    });
+
+    std::vector<uint32_t> payload(400);
+    std::vector<PacketView> packets(payload.size());
+    for (uint32_t i = 0; i < payload.size(); ++i) {
+        payload[i] = i;
+        packets[i] = PacketView{reinterpret_cast<const uint8_t*>(&payload[i]), sizeof(uint32_t)};
+    }
+    assert(lo.transmit(packets.data(), 10) == 10);
+    assert(controller.handlePendingInterrupts() == 1);
+    assert(received == 0);
+    controller.runSoftirqs();
+    assert(received == 10 && lo.getStats().interrupts == 1);
+
+    // A burst larger than one NetRx budget: still one interrupt, and the
+    // rest is picked up by NetRx re-raising itself rather than by new ones.
+    assert(lo.transmit(packets.data() + 10, 390) == 390);
+    assert(controller.handlePendingInterrupts() == 1);
+    controller.runSoftirqs();
+    assert(received == 400);
+    NicStats stats = lo.getStats();
+    assert(stats.interrupts == 2 && stats.polls >= 7);
+    assert(stats.txPackets == 401 && stats.rxPackets == 401);
+
+    // Drained, so the interrupt is armed again.
+    expected = 0;
+    assert(lo.transmit(packets.data(), 1) == 1);
+    assert(controller.handlePendingInterrupts() == 1);
+    controller.runSoftirqs();
+    assert(lo.getStats().interrupts == 3);
+    assert(stack.getNetworkReport().find("lo-test") != std::string::npos);
+
+    // A connected pair; a full RX ring pushes back on the sender until the
+    // receiver has polled.
+    VirtualNic a("veth0", pool, 8);
+    VirtualNic b("veth1", pool, 8);
+    VirtualNic other("veth2", std::make_shared<FramePool>(16));
+    assert(!VirtualNic::connect(a, other));
+    assert(VirtualNic::connect(a, b));
+    assert(!VirtualNic::connect(a, b));
+    assert(a.init() && b.init());
+    assert(a.transmit(packets.data(), 30) == 16);
+    assert(a.getStats().txBusy == 14);
+    assert(a.poll(NAPI_WEIGHT) == 0);
+    assert(b.poll(NAPI_WEIGHT) == 8);
+    assert(b.hasPendingRx());
+    assert(b.poll(NAPI_WEIGHT) == 8);
+    assert(b.read(text, sizeof(text)) == sizeof(uint32_t));
+    assert(a.shutdown() && b.shutdown() && lo.shutdown());
+    assert(pool->available() == pool->getFrameCount());
+
+    std::cout << "PASSED\n";
+}
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Error);
+
+    std::cout << "\n=== Driver Unit Tests ===\n\n";
+
+    test_vector_table();
+    test_softirq_batching();
+    test_tasklets();
+    test_interrupt_coalescing();
+    test_per_cpu_interrupts();
+    test_block_queue();
+    test_io_schedulers();
+    test_virtual_nic();
+
+    std::cout << "\nAll driver tests passed!\n\n";
+    return 0;
+}
@@ -1,7 +1,17 @@
 #include "ipc/ipc.hpp"
+#include "ipc/transport.hpp"
+#include "ipc/schema.hpp"
+#include "scheduler/scheduler.hpp"
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
 
 using namespace MiniOS;
 
@@ -102,10 +112,10 @@ void test_message_types() {
     ipc.sendMessage(1, 2, nullptr, 0, MessageType::Request);
     
     auto msg1 = ipc.receiveMessage(2, false);
-    assert(msg1.has_value() && msg1->type == MessageType::Data);
+    assert(msg1.has_value() && msg1->type == MessageType::Signal);
     
     auto msg2 = ipc.receiveMessage(2, false);
-    assert(msg2.has_value() && msg2->type == MessageType::Signal);
+    assert(msg2.has_value() && msg2->type == MessageType::Data);
     
     auto msg3 = ipc.receiveMessage(2, false);
     assert(msg3.has_value() && msg3->type == MessageType::Request);
@@ -113,6 +123,96 @@ void test_message_types() {
     std::cout << "PASSED\n";
 }
 
+void test_priority_levels() {
+    std::cout << "Testing priority levels... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    
+    for (int i = 0; i < 20; ++i) {
+        ipc.sendMessage(1, 2, &i, sizeof(i), MessageType::Data);
+    }
+    MessageId low = ipc.sendMessage(1, 2, nullptr, 0, MessageType::Data, false, 0, MessagePriority::Low);
+    for (int i = 0; i < 10; ++i) {
+        ipc.sendMessage(1, 2, nullptr, 0, MessageType::Notification);
+    }
+    MessageId signal = ipc.sendMessage(1, 2, nullptr, 0, MessageType::Signal);
+    assert(ipc.getMessageCount(2) == 32);
+    
+    std::vector<Message> out;
+    assert(ipc.receiveBatch(2, 100, out) == 32);
+    assert(out[0].id == signal);
+    for (int i = 1; i <= 4; ++i) {
+        assert(out[i].type == MessageType::Notification);
+    }
+    
+    size_t lowIndex = 0;
+    int expected = 0;
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (out[i].id == low) {
+            lowIndex = i;
+        } else if (out[i].type == MessageType::Data) {
+            assert(out[i].getData<int>() == expected++);
+        }
+    }
+    assert(lowIndex > 0 && lowIndex < 8);
+    assert(expected == 20);
+    
+    int value = 1;
+    MessageSpec urgent(&value, sizeof(value));
+    urgent.priority = MessagePriority::Control;
+    std::vector<MessageSpec> specs(8, MessageSpec(&value, sizeof(value)));
+    specs.push_back(urgent);
+    assert(ipc.sendBatch(1, 2, specs) == 9);
+    auto first = ipc.receiveMessage(2, false);
+    assert(first.has_value() && first->priority == MessagePriority::Control);
+    
+    // Messages a selective receive stashed keep their turn in the round:
+    // single and batched receives see the same order as from the rings.
+    auto fill = [&ipc](TaskId receiver, bool stash) {
+        MessageId base = ipc.sendMessage(1, receiver, nullptr, 0, MessageType::Data);
+        for (int i = 0; i < 11; ++i) {
+            ipc.sendMessage(1, receiver, nullptr, 0, MessageType::Data);
+        }
+        ipc.sendMessage(1, receiver, nullptr, 0, MessageType::Data, false, 0, MessagePriority::Low);
+        if (stash) {
+            assert(!ipc.receiveMatching(receiver, MessageFilter::ofType(MessageType::Signal)).has_value());
+        }
+        for (int i = 0; i < 6; ++i) {
+            ipc.sendMessage(1, receiver, nullptr, 0, MessageType::Notification);
+        }
+        return base;
+    };
+    for (TaskId id = 3; id <= 5; ++id) {
+        ipc.registerTask(id);
+    }
+    
+    MessageId base = fill(3, false);
+    std::vector<MessageId> expectedOrder;
+    std::vector<Message> direct;
+    ipc.receiveBatch(3, 100, direct);
+    for (const auto& msg : direct) {
+        expectedOrder.push_back(msg.id - base);
+    }
+    assert(expectedOrder.size() == 19);
+    
+    base = fill(4, true);
+    for (MessageId offset : expectedOrder) {
+        auto msg = ipc.receiveMessage(4, false);
+        assert(msg.has_value() && msg->id - base == offset);
+    }
+    
+    base = fill(5, true);
+    std::vector<Message> stashed;
+    assert(ipc.receiveBatch(5, 100, stashed) == 19);
+    for (size_t i = 0; i < stashed.size(); ++i) {
+        assert(stashed[i].id - base == expectedOrder[i]);
+    }
+    
+    std::cout << "PASSED\n";
+}
+
 void test_no_messages() {
     std::cout << "Testing empty queue handling... ";
     
@@ -128,6 +228,1143 @@ void test_no_messages() {
     std::cout << "PASSED\n";
 }
 
+void test_queue_capacity() {
+    std::cout << "Testing bounded queue capacity... ";
+    
+    MessageQueue queue(1, 4);
+    assert(queue.capacity() == 4);
+    
+    for (MessageId id = 1; id <= 4; ++id) {
+        assert(queue.enqueue(Message(id, 2, 1, MessageType::Data)));
+    }
+    assert(!queue.enqueue(Message(5, 2, 1, MessageType::Data)));
+    assert(queue.size() == 4);
+    
+    auto first = queue.dequeue();
+    assert(first.has_value() && first->id == 1);
+    assert(queue.enqueue(Message(6, 2, 1, MessageType::Data)));
+    
+    MessageId expected[] = {2, 3, 4, 6};
+    for (MessageId id : expected) {
+        auto msg = queue.dequeue();
+        assert(msg.has_value() && msg->id == id);
+    }
+    assert(queue.isEmpty());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_flow_control() {
+    std::cout << "Testing queue limits and flow control... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2, QueueLimits{8, 256, OverflowPolicy::FailFast});
+    ipc.registerTask(3, QueueLimits{4, DEFAULT_QUEUE_BYTES, OverflowPolicy::DropOldest});
+    ipc.registerTask(4, QueueLimits{2, DEFAULT_QUEUE_BYTES, OverflowPolicy::Block});
+    
+    SendWindow window = ipc.getSendWindow(2);
+    assert(window.messages == 8 && window.bytes == 256);
+    
+    uint8_t chunk[100] = {};
+    assert(ipc.sendMessage(1, 2, chunk, sizeof(chunk)) != 0);
+    assert(ipc.sendMessage(1, 2, chunk, sizeof(chunk)) != 0);
+    assert(ipc.sendMessage(1, 2, chunk, sizeof(chunk)) == 0);
+    window = ipc.getSendWindow(2);
+    assert(window.messages == 6 && window.bytes == 56);
+    assert(ipc.sendMessage(1, 2, chunk, 56) != 0);
+    assert(ipc.getSendWindow(2).bytes == 0);
+    
+    ipc.receiveMessage(2, false);
+    assert(ipc.getSendWindow(2).bytes == 100);
+    
+    for (int i = 0; i < 8; ++i) {
+        assert(ipc.sendMessage(1, 3, &i, sizeof(i)) != 0);
+    }
+    std::vector<Message> survivors;
+    assert(ipc.receiveBatch(3, 16, survivors) == 4);
+    for (int i = 0; i < 4; ++i) {
+        assert(survivors[i].getData<int>() == 4 + i);
+    }
+    
+    // Well past twice the limit: producers evict, and the newest message is
+    // always the one that gets in. The oldest message is High priority, so
+    // only Normal ones make way for the rest.
+    int urgent = -1;
+    assert(ipc.sendMessage(1, 3, &urgent, sizeof(urgent), MessageType::Data, false, 0,
+                           MessagePriority::High) != 0);
+    for (int i = 0; i < 25; ++i) {
+        assert(ipc.sendMessage(1, 3, &i, sizeof(i)) != 0);
+        assert(ipc.getSendWindow(3).messages == 0 || i < 3);
+    }
+    survivors.clear();
+    assert(ipc.receiveBatch(3, 16, survivors) == 4);
+    assert(survivors[0].getData<int>() == -1);
+    for (int i = 1; i < 4; ++i) {
+        assert(survivors[i].getData<int>() == 21 + i);
+    }
+    
+    int value = 0;
+    assert(ipc.sendMessage(1, 4, &value, sizeof(value)) != 0);
+    assert(ipc.sendMessage(1, 4, &value, sizeof(value)) != 0);
+    std::atomic<bool> delivered{false};
+    std::thread blocked([&]() {
+        int last = 99;
+        assert(ipc.sendMessage(1, 4, &last, sizeof(last)) != 0);
+        delivered = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(!delivered);
+    assert(ipc.receiveMessage(4, false).has_value());
+    blocked.join();
+    assert(delivered);
+    ipc.receiveMessage(4, false);
+    assert(ipc.receiveMessage(4, false)->getData<int>() == 99);
+
+    // A full Block queue holds senders only until their deadline.
+    assert(ipc.sendMessage(1, 4, &value, sizeof(value)) != 0);
+    assert(ipc.sendMessage(1, 4, &value, sizeof(value)) != 0);
+    auto start = std::chrono::steady_clock::now();
+    assert(ipc.sendMessage(1, 4, &value, sizeof(value), start + std::chrono::milliseconds(10)) == 0);
+    assert(!ipc.sendAndWaitReply(1, 4, &value, sizeof(value), std::chrono::milliseconds(10)));
+    assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    assert(ipc.getMessageCount(4) == 2);
+
+    // A message larger than the whole byte limit can never fit: fail at once
+    // rather than wait forever.
+    ipc.registerTask(5, QueueLimits{4, 64, OverflowPolicy::Block});
+    assert(ipc.sendMessage(1, 5, chunk, sizeof(chunk)) == 0);
+    assert(ipc.sendMessage(1, 5, chunk, 64) != 0);
+
+    // Ports honour the Block policy too.
+    Handle blockingPort = ipc.createPort(5, QueueLimits{1, DEFAULT_QUEUE_BYTES, OverflowPolicy::Block});
+    Handle sendSide = ipc.grantHandle(5, blockingPort, 1, RIGHT_SEND);
+    assert(ipc.sendToPort(1, sendSide, &value, sizeof(value)) != 0);
+    std::atomic<bool> portDelivered{false};
+    std::thread portSender([&]() {
+        int next = 7;
+        assert(ipc.sendToPort(1, sendSide, &next, sizeof(next)) != 0);
+        portDelivered = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(!portDelivered);
+    assert(ipc.receiveFromPort(5, blockingPort, Deadline::min()).has_value());
+    portSender.join();
+    assert(ipc.receiveFromPort(5, blockingPort, Deadline::min())->getData<int>() == 7);
+
+    std::cout << "PASSED\n";
+}
+
+void test_concurrent_senders() {
+    std::cout << "Testing concurrent senders... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(100);
+    
+    constexpr int senderCount = 4;
+    constexpr int messagesPerSender = 2000;
+    
+    std::vector<std::thread> senders;
+    for (int s = 1; s <= senderCount; ++s) {
+        ipc.registerTask(s);
+        senders.emplace_back([&ipc, s]() {
+            for (int i = 0; i < messagesPerSender; ++i) {
+                while (ipc.sendMessage(s, 100, &i, sizeof(i)) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    
+    std::vector<int> nextExpected(senderCount + 1, 0);
+    int received = 0;
+    while (received < senderCount * messagesPerSender) {
+        auto msg = ipc.receiveMessage(100, false);
+        if (!msg) {
+            std::this_thread::yield();
+            continue;
+        }
+        auto value = msg->getData<int>();
+        assert(value.has_value());
+        assert(*value == nextExpected[msg->senderId]);
+        nextExpected[msg->senderId]++;
+        received++;
+    }
+    
+    for (auto& t : senders) {
+        t.join();
+    }
+    assert(ipc.getMessageCount(100) == 0);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_registry_churn() {
+    std::cout << "Testing registry churn under concurrent sends... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    assert(!ipc.registerTask(static_cast<TaskId>(MAX_IPC_TASKS)));
+    
+    LogLevel previousLevel = Logger::instance().getLevel();
+    Logger::instance().setLevel(LogLevel::Critical);
+    assert(ipc.registerTask(static_cast<TaskId>(MAX_IPC_TASKS - 1)));
+    
+    std::atomic<bool> running{true};
+    std::vector<std::thread> senders;
+    for (int t = 0; t < 3; ++t) {
+        senders.emplace_back([&ipc, &running, t]() {
+            int value = t;
+            while (running) {
+                for (TaskId target = 10; target < 20; ++target) {
+                    ipc.sendMessage(1, target, &value, sizeof(value));
+                    ipc.getMessageCount(target);
+                }
+            }
+        });
+    }
+    
+    for (int round = 0; round < 200; ++round) {
+        for (TaskId target = 10; target < 20; ++target) {
+            assert(ipc.registerTask(target));
+        }
+        for (TaskId target = 10; target < 20; ++target) {
+            ipc.receiveMessage(target, false);
+            assert(ipc.unregisterTask(target));
+        }
+    }
+    
+    running = false;
+    for (auto& t : senders) {
+        t.join();
+    }
+    Logger::instance().setLevel(previousLevel);
+    
+    EpochDomain::instance().collect();
+    assert(EpochDomain::instance().pendingCount() == 0);
+    assert(!ipc.hasMessages(10));
+
+    // A parked receiver holds its queue, not the epoch: other queues are
+    // reclaimed while it sleeps, and its own outlives unregistering it.
+    ipc.registerTask(30);
+    ipc.registerTask(31);
+    std::atomic<bool> returned{false};
+    std::thread parked([&]() {
+        assert(!ipc.receiveMessage(30, true));
+        returned = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(ipc.unregisterTask(31));
+    assert(EpochDomain::instance().pendingCount() == 0);
+    assert(ipc.unregisterTask(30));
+    parked.join();
+    assert(returned);
+    assert(EpochDomain::instance().pendingCount() == 0);
+
+    std::cout << "PASSED\n";
+}
+
+void test_payload_storage() {
+    std::cout << "Testing pooled payload storage... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    
+    uint8_t small[INLINE_PAYLOAD_SIZE];
+    std::memset(small, 0xAB, sizeof(small));
+    std::vector<uint8_t> large(1500, 0xCD);
+    
+    ipc.sendMessage(1, 2, small, sizeof(small));
+    ipc.sendMessage(1, 2, large.data(), large.size());
+    
+    MessageQueue queue(2, 4);
+    Message probe(1, 1, 2, MessageType::Data);
+    probe.setPayload(large.data(), large.size());
+    queue.enqueue(std::move(probe));
+    const Message* view = queue.peek();
+    assert(view != nullptr && view == queue.peek());
+    assert(view->payload.size() == large.size());
+    
+    auto msg = ipc.receiveMessage(2, false);
+    assert(msg.has_value() && msg->payload.isInline());
+    assert(msg->payload.size() == sizeof(small));
+    assert(std::memcmp(msg->payload.data(), small, sizeof(small)) == 0);
+    
+    msg = ipc.receiveMessage(2, false);
+    assert(msg.has_value() && !msg->payload.isInline());
+    assert(std::memcmp(msg->payload.data(), large.data(), large.size()) == 0);
+    msg.reset();
+    
+    for (int i = 0; i < 16; ++i) {
+        ipc.sendMessage(1, 2, large.data(), large.size());
+        ipc.receiveMessage(2, false);
+    }
+    uint64_t createdBefore = PayloadPool::instance().getBlocksCreated();
+    for (int i = 0; i < 1000; ++i) {
+        ipc.sendMessage(1, 2, large.data(), large.size());
+        ipc.receiveMessage(2, false);
+    }
+    assert(PayloadPool::instance().getBlocksCreated() == createdBefore);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_page_grants() {
+    std::cout << "Testing page grant messages... ";
+    
+    MemoryManager mm;
+    IPCManager ipc;
+    ipc.attachMemoryManager(&mm);
+    
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    mm.createAddressSpace(1);
+    mm.createAddressSpace(2);
+    
+    std::vector<uint8_t> big(MAX_MESSAGE_SIZE + 1, 0);
+    assert(ipc.sendMessage(1, 2, big.data(), big.size()) == 0);
+    
+    constexpr size_t pages = 512;
+    RegionId region = mm.createSharedRegion(1, pages);
+    assert(region != INVALID_REGION_ID);
+    assert(mm.mapSharedRegion(region, 1, 0));
+    
+    auto* base = static_cast<uint8_t*>(*mm.getRegionAddress(region));
+    std::memset(base, 0x5A, pages * PAGE_SIZE);
+    
+    assert(ipc.sendPageGrant(3, 2, region, GrantMode::Share) == 0);
+    assert(ipc.sendPageGrant(1, 2, region, GrantMode::Transfer) != 0);
+    assert(!mm.isRegionMapped(region, 1));
+    assert(ipc.getMessageCount(2) == 1);
+    
+    auto grant = ipc.receiveMessage(2, false);
+    assert(grant.has_value() && grant->type == MessageType::Grant);
+    assert(grant->payload.size() == sizeof(PageGrant));
+    assert(ipc.acceptPageGrant(2, *grant, 100, MemoryProtection::Read));
+    
+    assert(mm.getSharedRegion(region)->owner == 2);
+    assert(mm.getSharedRegion(region)->pinCount == 0);
+    assert(mm.translateAddress(2, 100 + pages - 1).has_value());
+    assert(static_cast<uint8_t*>(*mm.getRegionAddress(region)) == base);
+    assert(base[pages * PAGE_SIZE - 1] == 0x5A);
+    
+    assert(ipc.sendPageGrant(2, 1, region, GrantMode::Share) != 0);
+    auto shared = ipc.receiveMessage(1, false);
+    assert(shared.has_value());
+    assert(ipc.releasePageGrant(*shared));
+    assert(mm.getSharedRegion(region)->pinCount == 0);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_blocking_receive() {
+    std::cout << "Testing blocking receive... ";
+    
+    IPCManager ipc;
+    Scheduler scheduler;
+    TaskId receiver = scheduler.createTask("receiver", []() {});
+    ipc.registerTask(receiver);
+    ipc.registerTask(50);
+    ipc.setBlockingHooks(
+        [&scheduler](TaskId id) { scheduler.blockTask(id); },
+        [&scheduler](TaskId id) { scheduler.unblockTask(id); }
+    );
+    
+    std::optional<Message> received;
+    std::thread waiter([&]() {
+        received = ipc.receiveMessage(receiver, true);
+    });
+    
+    while (scheduler.getTask(receiver)->state != TaskState::Blocked) {
+        std::this_thread::yield();
+    }
+    
+    int value = 7;
+    ipc.sendMessage(50, receiver, &value, sizeof(value));
+    waiter.join();
+    
+    assert(received.has_value() && received->getData<int>() == 7);
+    assert(scheduler.getTask(receiver)->state == TaskState::Ready);
+    
+    auto start = std::chrono::steady_clock::now();
+    auto timedOut = ipc.receiveMessage(receiver, start + std::chrono::milliseconds(20));
+    assert(!timedOut.has_value());
+    assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+    
+    std::thread closer([&]() {
+        received = ipc.receiveMessage(receiver, true);
+    });
+    while (scheduler.getTask(receiver)->state != TaskState::Blocked) {
+        std::this_thread::yield();
+    }
+    ipc.unregisterTask(receiver);
+    closer.join();
+    assert(!received.has_value());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_send_and_wait_reply() {
+    std::cout << "Testing send and wait reply... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    
+    std::thread server([&ipc]() {
+        for (int i = 0; i < 100; ++i) {
+            auto request = ipc.receiveMessage(2, true);
+            assert(request.has_value() && request->type == MessageType::Request);
+            int reply = *request->getData<int>() * 2;
+            ipc.sendMessage(2, request->senderId, &reply, sizeof(reply), MessageType::Response);
+        }
+    });
+    
+    for (int i = 0; i < 100; ++i) {
+        auto reply = ipc.sendAndWaitReply(1, 2, &i, sizeof(i), std::chrono::milliseconds(1000));
+        assert(reply.has_value() && reply->getData<int>() == i * 2);
+    }
+    server.join();
+    
+    auto none = ipc.sendAndWaitReply(1, 2, nullptr, 0, std::chrono::milliseconds(10));
+    assert(!none.has_value());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_synchronous_call() {
+    std::cout << "Testing synchronous call fast path... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    
+    std::vector<std::pair<TaskId, TaskId>> handoffs;
+    std::mutex handoffMutex;
+    ipc.setHandoffHook([&](TaskId from, TaskId to, bool) {
+        std::lock_guard<std::mutex> lock(handoffMutex);
+        handoffs.emplace_back(from, to);
+    });
+    
+    int early = 5;
+    assert(ipc.sendMessage(1, 2, &early, sizeof(early), MessageType::Request) != 0);
+    
+    std::thread server([&ipc]() {
+        auto request = ipc.receiveCall(2);
+        for (int i = 0; i < 100; ++i) {
+            int value = *request->getData<int>() * 3;
+            request = ipc.replyWait(2, *request, &value, sizeof(value));
+            assert(request.has_value());
+        }
+        int last = *request->getData<int>() * 3;
+        ipc.reply(2, *request, &last, sizeof(last));
+    });
+    
+    auto queuedReply = ipc.receiveMessage(1, std::chrono::steady_clock::now() + std::chrono::seconds(2));
+    assert(queuedReply.has_value() && queuedReply->type == MessageType::Response);
+    assert(queuedReply->getData<int>() == 15);
+    
+    for (int i = 0; i < 100; ++i) {
+        auto reply = ipc.call(1, 2, &i, sizeof(i));
+        assert(reply.has_value() && reply->type == MessageType::Response);
+        assert(reply->getData<int>() == i * 3);
+    }
+    server.join();
+
+    // A stale reply occupies the slot, so the real one falls back to the
+    // mailbox; the caller must still find it and leave the Blocked state.
+    std::atomic<int> parked{0};
+    ipc.setBlockingHooks([&parked](TaskId) { parked.fetch_add(1); },
+                         [&parked](TaskId) { parked.fetch_sub(1); });
+    std::thread fallbackServer([&ipc]() {
+        auto request = ipc.receiveCall(2);
+        assert(request.has_value());
+        Message stale(*request);
+        stale.id = request->id + 1000;
+        int old = -1;
+        assert(ipc.reply(2, stale, &old, sizeof(old)));
+        int value = 77;
+        assert(ipc.reply(2, *request, &value, sizeof(value)));
+    });
+    auto fallback = ipc.call(1, 2, nullptr, 0, std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    fallbackServer.join();
+    assert(fallback.has_value() && fallback->getData<int>() == 77);
+    assert(parked.load() <= 0);
+    ipc.setBlockingHooks(nullptr, nullptr);
+
+    assert(!ipc.call(1, 2, nullptr, 0, std::chrono::steady_clock::now() + std::chrono::milliseconds(10)));
+    assert(!ipc.call(1, 99, nullptr, 0));
+    assert(!handoffs.empty());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_async_calls() {
+    std::cout << "Testing pipelined async calls... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    ipc.registerTask(3);
+    
+    const int inFlight = 200;
+    std::vector<ReplyFuture> futures;
+    std::vector<MessageId> requestIds(inFlight);
+    for (int i = 0; i < inFlight; ++i) {
+        futures.push_back(ipc.callAsync(1, 2, &i, sizeof(i), &requestIds[i]));
+    }
+    assert(ipc.getPendingCallCount() == inFlight);
+    
+    std::thread server([&ipc]() {
+        std::vector<Message> requests;
+        while (requests.size() < inFlight) {
+            auto request = ipc.receiveCall(2);
+            assert(request.has_value());
+            requests.push_back(std::move(*request));
+        }
+        for (auto it = requests.rbegin(); it != requests.rend(); ++it) {
+            int value = *it->getData<int>() + 1000;
+            if (value % 2 == 0) {
+                assert(ipc.replyTo(2, it->id, &value, sizeof(value)));
+            } else {
+                assert(ipc.reply(2, *it, &value, sizeof(value)));
+            }
+        }
+    });
+    
+    for (int i = inFlight - 1; i >= 0; --i) {
+        auto reply = futures[i].get();
+        assert(reply.has_value() && reply->getData<int>() == i + 1000);
+        assert(reply->correlationId == requestIds[i]);
+        assert(reply->receiverId == 1);
+    }
+    server.join();
+    assert(ipc.getPendingCallCount() == 0);
+    
+    MessageId stray = 0;
+    auto cancelled = ipc.callAsync(1, 2, nullptr, 0, &stray);
+    assert(!ipc.replyTo(3, stray, nullptr, 0));
+    assert(ipc.cancelCall(stray));
+    assert(!cancelled.get().has_value());
+    assert(!ipc.replyTo(2, stray, nullptr, 0));
+    
+    auto orphaned = ipc.callAsync(1, 3, nullptr, 0);
+    ipc.unregisterTask(3);
+    assert(!orphaned.get().has_value());
+    assert(!ipc.callAsync(1, 3, nullptr, 0).get().has_value());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_selective_receive() {
+    std::cout << "Testing selective receive... ";
+    
+    IPCManager ipc;
+    for (TaskId id = 1; id <= 4; ++id) {
+        ipc.registerTask(id);
+    }
+    
+    MessageId first = ipc.sendMessage(2, 1, nullptr, 0, MessageType::Data);
+    MessageId second = ipc.sendMessage(3, 1, nullptr, 0, MessageType::Data);
+    MessageId third = ipc.sendMessage(2, 1, nullptr, 0, MessageType::Signal);
+    MessageId fourth = ipc.sendMessage(4, 1, nullptr, 0, MessageType::Response, false, 77);
+    MessageId fifth = ipc.sendMessage(3, 1, nullptr, 0, MessageType::Data);
+    
+    auto fromThree = ipc.receiveMessageFrom(1, 3, false);
+    assert(fromThree.has_value() && fromThree->id == second);
+    
+    auto correlated = ipc.receiveMatching(1, MessageFilter::forCorrelation(77));
+    assert(correlated.has_value() && correlated->id == fourth);
+    
+    auto signal = ipc.receiveMatching(1, MessageFilter::ofType(MessageType::Signal));
+    assert(signal.has_value() && signal->id == third);
+    
+    assert(!ipc.receiveMessageFrom(1, 4, false).has_value());
+    assert(ipc.getMessageCount(1) == 2);
+    
+    auto next = ipc.receiveMessage(1, false);
+    assert(next.has_value() && next->id == first);
+    next = ipc.receiveMessage(1, false);
+    assert(next.has_value() && next->id == fifth);
+    assert(!ipc.hasMessages(1));
+    
+    std::thread server([&ipc]() {
+        ipc.receiveMessage(2, true);
+        ipc.sendMessage(3, 1, nullptr, 0, MessageType::Data);
+        ipc.sendMessage(2, 1, nullptr, 0, MessageType::Notification);
+        ipc.sendMessage(2, 1, nullptr, 0, MessageType::Response);
+    });
+    
+    auto reply = ipc.sendAndWaitReply(1, 2, nullptr, 0, std::chrono::milliseconds(1000));
+    server.join();
+    assert(reply.has_value() && reply->senderId == 2 && reply->type == MessageType::Response);
+    assert(ipc.getMessageCount(1) == 2);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_batched_messaging() {
+    std::cout << "Testing batched send and receive... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    
+    int values[40];
+    std::vector<MessageSpec> specs;
+    for (int i = 0; i < 40; ++i) {
+        values[i] = i;
+        specs.emplace_back(&values[i], sizeof(int));
+    }
+    specs[5].type = MessageType::Signal;
+    
+    MessageId firstId = 0;
+    assert(ipc.sendBatch(1, 2, specs, &firstId) == 40);
+    assert(firstId != 0);
+    assert(ipc.getMessageCount(2) == 40);
+    
+    auto signal = ipc.receiveMatching(2, MessageFilter::ofType(MessageType::Signal));
+    assert(signal.has_value() && signal->id == firstId + 5);
+    
+    std::vector<Message> out;
+    assert(ipc.receiveBatch(2, 16, out) == 16);
+    assert(ipc.receiveBatch(2, 100, out) == 23);
+    assert(out.size() == 39);
+    
+    int expected = 0;
+    for (const auto& msg : out) {
+        if (expected == 5) {
+            expected++;
+        }
+        assert(msg.id == firstId + static_cast<MessageId>(expected));
+        assert(msg.getData<int>() == expected);
+        expected++;
+    }
+    
+    out.clear();
+    assert(ipc.receiveBatch(2, 8, out) == 0);
+    
+    MessageQueue small(3, 8);
+    std::vector<Message> overflow;
+    for (MessageId id = 1; id <= 10; ++id) {
+        overflow.emplace_back(id, 1, 3, MessageType::Data);
+    }
+    assert(small.enqueueBatch(overflow.data(), overflow.size()) == 8);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_topics() {
+    std::cout << "Testing publish/subscribe topics... ";
+    
+    IPCManager ipc;
+    for (TaskId t = 1; t <= 5; ++t) {
+        ipc.registerTask(t);
+    }
+    
+    TopicId topic = ipc.createTopic("sensors");
+    assert(topic != INVALID_TOPIC_ID);
+    assert(ipc.createTopic("sensors") == INVALID_TOPIC_ID);
+    assert(ipc.findTopic("sensors") == topic);
+    assert(ipc.findTopic("missing") == INVALID_TOPIC_ID);
+    
+    ipc.subscribe(topic, 2);
+    ipc.subscribe(topic, 3);
+    ipc.subscribe(topic, 4, [](const Message& msg) {
+        return msg.payload.size() < 100;
+    });
+    SubscriptionId dropped = ipc.subscribe(topic, 5);
+    assert(ipc.getSubscriberCount(topic) == 4);
+    assert(ipc.unsubscribe(topic, dropped));
+    assert(!ipc.unsubscribe(topic, dropped));
+    
+    std::vector<uint8_t> large(1024, 0x5A);
+    assert(ipc.publish(topic, 1, large.data(), large.size()) == 2);
+    assert(ipc.getMessageCount(4) == 0);
+    assert(ipc.getMessageCount(5) == 0);
+    
+    auto first = ipc.receiveMessage(2, false);
+    auto second = ipc.receiveMessage(3, false);
+    assert(first.has_value() && second.has_value());
+    assert(first->type == MessageType::Notification);
+    assert(first->payload.isShared());
+    assert(first->payload.shared() == second->payload.shared());
+    assert(first->payload.shared()->refCount() == 2);
+    assert(first->payload.data()[1023] == 0x5A);
+    
+    second.reset();
+    assert(first->payload.shared()->refCount() == 1);
+    
+    int small = 7;
+    assert(ipc.publish(topic, 1, &small, sizeof(small)) == 3);
+    auto inlineCopy = ipc.receiveMessage(4, false);
+    assert(inlineCopy.has_value() && inlineCopy->payload.isInline());
+    assert(inlineCopy->getData<int>() == 7);
+    
+    assert(ipc.destroyTopic(topic));
+    assert(ipc.publish(topic, 1, &small, sizeof(small)) == 0);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_ports_and_wait_sets() {
+    std::cout << "Testing capability ports and wait sets... ";
+    
+    IPCManager ipc;
+    const TaskId server = 1;
+    const TaskId client = 2;
+    
+    std::vector<Handle> ports;
+    Handle waitSet = ipc.createWaitSet(server);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        Handle port = ipc.createPort(server);
+        assert(port != INVALID_HANDLE);
+        assert(ipc.waitSetAdd(server, waitSet, port, i));
+        ports.push_back(port);
+    }
+    
+    Handle sendOnly = ipc.grantHandle(server, ports[42], client, RIGHT_SEND);
+    assert(sendOnly != INVALID_HANDLE);
+    assert(ipc.grantHandle(server, ports[42], client, RIGHT_RECEIVE) == INVALID_HANDLE);
+    assert(ipc.grantHandle(client, sendOnly, 3, RIGHT_SEND) == INVALID_HANDLE);
+    assert(!ipc.receiveFromPort(client, sendOnly).has_value());
+    assert(ipc.sendToPort(3, sendOnly, nullptr, 0) == 0);
+    
+    int value = 5;
+    assert(ipc.sendToPort(client, sendOnly, &value, sizeof(value)) != 0);
+    assert(ipc.sendToPort(server, ports[7], &value, sizeof(value)) != 0);
+    assert(ipc.sendToPort(server, ports[999], &value, sizeof(value)) != 0);
+    
+    std::vector<WaitEvent> events;
+    assert(ipc.waitForEvents(server, waitSet, events, 64, Deadline::min()) == 3);
+    std::vector<uint64_t> cookies;
+    for (const auto& event : events) {
+        assert(event.events == WAIT_READABLE);
+        cookies.push_back(event.cookie);
+        auto msg = ipc.receiveFromPort(server, event.handle);
+        assert(msg.has_value() && msg->getData<int>() == 5);
+    }
+    std::sort(cookies.begin(), cookies.end());
+    assert((cookies == std::vector<uint64_t>{7, 42, 999}));
+    
+    events.clear();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    assert(ipc.waitForEvents(server, waitSet, events, 64, deadline) == 0);
+    
+    std::thread producer([&ipc, client, sendOnly]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        int late = 9;
+        ipc.sendToPort(client, sendOnly, &late, sizeof(late));
+    });
+    assert(ipc.waitForEvents(server, waitSet, events, 64) == 1);
+    assert(events[0].cookie == 42);
+    producer.join();
+    
+    assert(ipc.waitSetRemove(server, waitSet, ports[42]));
+    assert(!ipc.waitSetRemove(server, waitSet, ports[42]));
+    
+    assert(ipc.closeHandle(server, ports[7]));
+    assert(ipc.sendToPort(server, ports[7], &value, sizeof(value)) == 0);
+    
+    // The task's own mailbox is watched from the same set as its ports.
+    assert(ipc.waitSetRemove(server, waitSet, ports[7]));
+    assert(ipc.openMailbox(server) == INVALID_HANDLE);
+    ipc.registerTask(server);
+    ipc.registerTask(client);
+    Handle mailbox = ipc.openMailbox(server);
+    assert(mailbox != INVALID_HANDLE);
+    assert(ipc.grantHandle(server, mailbox, client, RIGHT_SEND) == INVALID_HANDLE);
+    assert(ipc.waitSetAdd(server, waitSet, mailbox, 5000));
+    Handle otherSet = ipc.createWaitSet(server);
+    assert(!ipc.waitSetAdd(server, otherSet, ipc.openMailbox(server), 1));
+    
+    events.clear();
+    ipc.sendMessage(client, server, &value, sizeof(value));
+    assert(ipc.waitForEvents(server, waitSet, events, 64, Deadline::min()) == 1);
+    assert(events[0].cookie == 5000 && events[0].events == WAIT_READABLE);
+    assert(ipc.receiveMessage(server, false).has_value());
+    
+    events.clear();
+    Handle doorbell = ipc.createNotification(server);
+    assert(ipc.bindNotification(server, doorbell));
+    std::thread ringer([&ipc, server, doorbell]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ipc.signal(server, doorbell, 0x4);
+    });
+    assert(ipc.waitForEvents(server, waitSet, events, 64) == 1);
+    assert(events[0].cookie == 5000);
+    ringer.join();
+    auto rung = ipc.receiveMessage(server, false);
+    assert(rung.has_value() && rung->type == MessageType::Signal);
+    
+    assert(ipc.waitSetRemove(server, waitSet, mailbox));
+    assert(ipc.closeHandle(server, mailbox));
+    assert(ipc.sendMessage(client, server, &value, sizeof(value)) != 0);
+    assert(ipc.receiveMessage(server, false).has_value());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_notifications() {
+    std::cout << "Testing notification doorbells... ";
+    
+    IPCManager ipc;
+    const TaskId server = 1;
+    const TaskId client = 2;
+    ipc.registerTask(server);
+    
+    Handle doorbell = ipc.createNotification(server);
+    Handle clientSide = ipc.grantHandle(server, doorbell, client, RIGHT_SEND);
+    assert(clientSide != INVALID_HANDLE);
+    assert(ipc.waitNotification(client, clientSide, Deadline::min()) == 0);
+    
+    assert(ipc.signal(client, clientSide, 0x1));
+    assert(ipc.signal(client, clientSide, 0x4));
+    assert(ipc.signal(client, clientSide, 0x1));
+    assert(ipc.waitNotification(server, doorbell, Deadline::min()) == 0x5);
+    assert(ipc.waitNotification(server, doorbell, Deadline::min()) == 0);
+    
+    std::thread ringer([&ipc, client, clientSide]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ipc.signal(client, clientSide, 0x80);
+    });
+    assert(ipc.waitNotification(server, doorbell) == 0x80);
+    ringer.join();
+    
+    Handle waitSet = ipc.createWaitSet(server);
+    Handle port = ipc.createPort(server);
+    assert(ipc.waitSetAdd(server, waitSet, doorbell, 1));
+    assert(ipc.waitSetAdd(server, waitSet, port, 2));
+    ipc.signal(client, clientSide, 0x2);
+    std::vector<WaitEvent> events;
+    assert(ipc.waitForEvents(server, waitSet, events, 8, Deadline::min()) == 1);
+    assert(events[0].cookie == 1 && events[0].events == WAIT_READABLE);
+    assert(ipc.waitNotification(server, doorbell, Deadline::min()) == 0x2);
+    events.clear();
+    assert(ipc.waitForEvents(server, waitSet, events, 8, Deadline::min()) == 0);
+
+    // Every wait set watching the doorbell hears about it, up to the
+    // observer limit; past it the add is refused rather than stealing one.
+    std::vector<Handle> otherSets;
+    for (size_t i = 1; i < NOTIFICATION_OBSERVERS; ++i) {
+        otherSets.push_back(ipc.createWaitSet(server));
+        assert(ipc.waitSetAdd(server, otherSets.back(), doorbell, 10 + i));
+    }
+    Handle overflowSet = ipc.createWaitSet(server);
+    assert(!ipc.waitSetAdd(server, overflowSet, doorbell, 99));
+    ipc.signal(client, clientSide, 0x8);
+    assert(ipc.waitForEvents(server, waitSet, events, 8, Deadline::min()) == 1);
+    for (Handle other : otherSets) {
+        events.clear();
+        assert(ipc.waitForEvents(server, other, events, 8, Deadline::min()) == 1);
+        assert(events[0].events == WAIT_READABLE);
+    }
+    assert(ipc.waitNotification(server, doorbell, Deadline::min()) == 0x8);
+    assert(ipc.waitSetRemove(server, otherSets.back(), doorbell));
+    assert(ipc.waitSetAdd(server, overflowSet, doorbell, 99));
+    events.clear();
+
+    Handle bound = ipc.createNotification(server);
+    assert(ipc.bindNotification(server, bound));
+    assert(!ipc.bindNotification(server, doorbell));
+    Handle boundSide = ipc.grantHandle(server, bound, client, RIGHT_SEND);
+    std::thread sender([&ipc, client, boundSide]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ipc.signal(client, boundSide, 0x10);
+    });
+    auto msg = ipc.receiveMessage(server, true);
+    sender.join();
+    assert(msg.has_value() && msg->type == MessageType::Signal);
+    assert(msg->getData<uint64_t>() == 0x10);
+    
+    int value = 3;
+    ipc.sendMessage(client, server, &value, sizeof(value));
+    ipc.signal(client, boundSide, 0x20);
+    auto first = ipc.receiveMessage(server, false);
+    auto second = ipc.receiveMessage(server, false);
+    assert(first->type == MessageType::Data);
+    assert(second->type == MessageType::Signal && second->getData<uint64_t>() == 0x20);
+    assert(!ipc.receiveMessage(server, false).has_value());
+    
+    assert(!ipc.signal(server + 10, clientSide, 1));
+    
+    std::cout << "PASSED\n";
+}
+
+void test_remote_transport() {
+    std::cout << "Testing cross-process transport... ";
+    
+    IPCManager local;
+    IPCManager remote;
+    local.registerTask(5);
+    remote.registerTask(7);
+    
+    std::string path = "/tmp/minios-test-" + std::to_string(::getpid()) + ".sock";
+    IPCTransport server(local, 1, 16 * 1024);
+    IPCTransport client(remote, 2, 16 * 1024);
+    assert(server.listen(path));
+    assert(client.connect(path));
+    assert(client.isConnected(1));
+    assert(!client.connect(path));
+    
+    const char greeting[] = "hello";
+    assert(remote.sendMessage(7, remoteTaskId(1, 5), greeting, sizeof(greeting)) != 0);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    auto msg = local.receiveMessage(5, deadline);
+    assert(msg.has_value());
+    assert(msg->senderId == remoteTaskId(2, 7));
+    assert(std::strcmp(reinterpret_cast<const char*>(msg->payload.data()), "hello") == 0);
+    
+    std::vector<uint8_t> large(3000, 0x3C);
+    assert(local.sendMessage(5, msg->senderId, large.data(), large.size(), MessageType::Response, 
+                             false, msg->id) != 0);
+    auto reply = remote.receiveMessage(7, deadline);
+    assert(reply.has_value() && reply->type == MessageType::Response);
+    assert(reply->correlationId == msg->id);
+    assert(reply->payload.size() == 3000 && reply->payload.data()[2999] == 0x3C);
+    
+    const uint64_t total = 5000;
+    std::thread sender([&remote, total]() {
+        for (uint64_t i = 0; i < total; ++i) {
+            while (remote.sendMessage(7, remoteTaskId(1, 5), &i, sizeof(i)) == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint64_t i = 0; i < total; ++i) {
+        auto next = local.receiveMessage(5, deadline + std::chrono::seconds(5));
+        assert(next.has_value() && next->getData<uint64_t>() == i);
+    }
+    sender.join();
+    assert(client.getFramesSent() == total + 1);
+    
+    assert(remote.sendMessage(7, remoteTaskId(9, 5), greeting, sizeof(greeting)) == 0);
+
+    // Tearing a transport down under a live sender: forward() calls already
+    // in flight finish first, later sends find no router.
+    IPCManager churn;
+    churn.registerTask(8);
+    auto transient = std::make_unique<IPCTransport>(churn, 3, 16 * 1024);
+    assert(transient->connect(path));
+    std::atomic<bool> sending{true};
+    std::atomic<uint64_t> attempts{0};
+    LogLevel previousLevel = Logger::instance().getLevel();
+    Logger::instance().setLevel(LogLevel::Critical);
+    std::thread racer([&]() {
+        while (sending) {
+            churn.sendMessage(8, remoteTaskId(1, 5), greeting, sizeof(greeting));
+            attempts++;
+        }
+    });
+    while (attempts < 100) {
+        std::this_thread::yield();
+    }
+    transient.reset();
+    assert(churn.sendMessage(8, remoteTaskId(1, 5), greeting, sizeof(greeting)) == 0);
+    sending = false;
+    racer.join();
+    Logger::instance().setLevel(previousLevel);
+
+    // The peer controls every byte of a ring: a frame whose length runs past
+    // what was published marks the ring corrupt rather than being read.
+    const size_t ringBytes = 16 * 1024;
+    void* region = ::mmap(nullptr, ShmRing::regionSize(ringBytes), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(region != MAP_FAILED);
+    ShmRing ring(region, ringBytes, true);
+    Message probe(1, 7, 5, MessageType::Data);
+    probe.setPayload(greeting, sizeof(greeting));
+    assert(ring.write(probe, 5));
+    auto accept = [](const WireFrame&, const uint8_t*) { return true; };
+    assert(ring.drain(TRANSPORT_RECEIVE_BATCH, accept) == 1);
+    assert(ring.write(probe, 5));
+    uint64_t head = static_cast<ShmRing::Header*>(region)->head.load();
+    uint32_t forged = MAX_MESSAGE_SIZE;
+    std::memcpy(static_cast<uint8_t*>(region) + sizeof(ShmRing::Header) + head, &forged, sizeof(forged));
+    assert(ring.drain(TRANSPORT_RECEIVE_BATCH, accept) == 0);
+    assert(ring.corrupt());
+    ::munmap(region, ShmRing::regionSize(ringBytes));
+
+    std::cout << "PASSED\n";
+}
+
+namespace {
+
+using SensorReadingV1 = Schema<7, 1, Scalar<uint32_t>, Scalar<double>, Bytes>;
+using SensorReadingV2 = Schema<7, 2, Scalar<uint32_t>, Scalar<double>, Bytes, Array<uint16_t>, Scalar<uint8_t>>;
+enum SensorField { SensorId, Reading, Label, Samples, Flags };
+
+}
+
+void test_schema_messages() {
+    std::cout << "Testing schema views and builders... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    
+    const std::string label = "thermocouple-north";
+    Message msg(0, 1, 2, MessageType::Data);
+    SchemaBuilder<SensorReadingV2> builder(msg, {label.size(), 300});
+    assert(builder.ok());
+    builder.set<SensorId>(42);
+    builder.set<Reading>(21.5);
+    builder.assign<Label>(label.data());
+    for (uint16_t i = 0; i < 300; ++i) {
+        builder.setElement<Samples>(i, static_cast<uint16_t>(i * 3));
+    }
+    builder.set<Flags>(0x5);
+    const uint8_t* written = msg.payload.data();
+    assert(ipc.sendPrepared(std::move(msg)) != 0);
+    
+    auto received = ipc.receiveMessage(2, false);
+    assert(received.has_value());
+    assert(received->payload.data() == written);
+    
+    auto view = viewAs<SensorReadingV2>(*received);
+    assert(view.has_value() && view->version() == 2);
+    assert(view->get<SensorId>() == 42);
+    assert(view->get<Reading>() == 21.5);
+    assert(view->text<Label>() == label);
+    assert(view->text<Label>().data() >= reinterpret_cast<const char*>(received->payload.data()));
+    auto samples = view->array<Samples>();
+    assert(samples.size() == 300 && samples[299] == 897);
+    assert(view->get<Flags>() == 0x5);
+    
+    auto older = viewAs<SensorReadingV1>(*received);
+    assert(older.has_value() && older->get<SensorId>() == 42);
+    
+    Message legacy(0, 1, 2, MessageType::Data);
+    SchemaBuilder<SensorReadingV1> legacyBuilder(legacy, {3});
+    legacyBuilder.set<SensorId>(9);
+    legacyBuilder.assign<Label>("old");
+    auto upgraded = viewAs<SensorReadingV2>(legacy);
+    assert(upgraded.has_value() && upgraded->version() == 1);
+    assert(upgraded->has<Label>() && !upgraded->has<Samples>() && !upgraded->has<Flags>());
+    assert(upgraded->text<Label>() == "old");
+    assert(upgraded->array<Samples>().empty() && upgraded->get<Flags>() == 0);
+    
+    std::vector<uint8_t> corrupt(legacy.payload.data(), legacy.payload.data() + legacy.payload.size());
+    VariableSlot bogus{static_cast<uint32_t>(corrupt.size() - 2), 16};
+    std::memcpy(corrupt.data() + SensorReadingV1::offsetOf(Label), &bogus, sizeof(bogus));
+    assert(!SchemaView<SensorReadingV1>::parse(corrupt.data(), corrupt.size()).has_value());
+    assert(!SchemaView<SensorReadingV1>::parse(corrupt.data(), 6).has_value());
+    assert(!(SchemaView<Schema<8, 1, Scalar<uint32_t>>>::parse(legacy.payload).has_value()));
+    
+    Message oversized(0, 1, 2, MessageType::Data);
+    assert(!SchemaBuilder<SensorReadingV2>(oversized, {MAX_MESSAGE_SIZE, 0}).ok());
+    
+    std::cout << "PASSED\n";
+}
+
+void test_channel_stats() {
+    std::cout << "Testing per-channel tracing... ";
+    
+    IPCManager ipc;
+    ipc.registerTask(1);
+    ipc.registerTask(2);
+    QueueLimits small;
+    small.maxMessages = 4;
+    ipc.registerTask(3, small);
+    
+    auto find = [&](TaskId sender, TaskId receiver) {
+        for (const auto& channel : ipc.getChannelStats()) {
+            if (channel.sender == sender && channel.receiver == receiver) {
+                return std::optional<ChannelSnapshot>(channel);
+            }
+        }
+        return std::optional<ChannelSnapshot>();
+    };
+    
+    uint8_t data[100] = {};
+    std::thread producer([&]() {
+        for (int i = 0; i < 10; ++i) {
+            assert(ipc.sendMessage(1, 2, data, sizeof(data)) != 0);
+        }
+    });
+    producer.join();
+    for (int i = 0; i < 5; ++i) {
+        assert(ipc.sendMessage(1, 2, data, 8) != 0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    std::vector<Message> batch;
+    assert(ipc.receiveBatch(2, 15, batch) == 15);
+    
+    auto hot = find(1, 2);
+    assert(hot && hot->sent == 15 && hot->received == 15);
+    assert(hot->bytes == 10 * sizeof(data) + 5 * 8);
+    assert(hot->depthHighWater == 15 && hot->drops == 0);
+    assert(hot->latencyPercentile(0.5) >= 1000000);
+    
+    for (int i = 0; i < 6; ++i) {
+        ipc.sendMessage(2, 3, data, 8);
+    }
+    auto full = find(2, 3);
+    assert(full && full->sent == 4 && full->drops == 2 && full->depthHighWater == 4);
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+    assert(!ipc.receiveMessageFrom(1, 2, deadline).has_value());
+    assert(!ipc.receiveMessage(1, false).has_value());
+    auto slow = find(2, 1);
+    assert(slow && slow->timeouts == 1 && slow->sent == 0);
+    assert(!find(ANY_SENDER, 1));
+    
+    std::string report = ipc.getIPCReport();
+    assert(report.find("=== Channel Report ===") != std::string::npos);
+    assert(report.find("1 -> 2: 15 sent, 15 received") != std::string::npos);
+
+    MessageId requestId = 0;
+    ReplyFuture pending = ipc.callAsync(1, 2, data, 8, &requestId);
+    assert(ipc.receiveCall(2, Deadline::min()).has_value());
+    assert(ipc.replyTo(2, requestId, data, 4));
+    assert(pending.get().has_value());
+    hot = find(1, 2);
+    assert(hot->sent == 16 && hot->received == 16);
+    slow = find(2, 1);
+    assert(slow->sent == 1 && slow->received == 1 && slow->bytes == 4);
+
+    ipc.setChannelTracing(false);
+    ipc.sendMessage(1, 2, data, 8);
+    assert(find(1, 2)->sent == 16);
+    
+    // Threads that exit fold their shards into the totals, and a thread
+    // outliving a stats instance never touches it again.
+    auto transient = std::make_unique<ChannelStats>();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < 25; ++i) {
+                transient->recordSend(7, 8, 1, 16, 0);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto totals = transient->snapshot();
+    assert(totals.size() == 1 && totals[0].sent == 100 && totals[0].bytes == 1600);
+    
+    std::atomic<bool> destroyed{false};
+    std::thread survivor([&] {
+        transient->recordSend(7, 8, 1, 16, 0);
+        while (!destroyed.load()) {
+            std::this_thread::yield();
+        }
+        ChannelStats replacement;
+        replacement.recordSend(7, 8, 1, 16, 0);
+        assert(replacement.snapshot()[0].sent == 1);
+    });
+    while (transient->snapshot()[0].sent != 101) {
+        std::this_thread::yield();
+    }
+    transient.reset();
+    destroyed = true;
+    survivor.join();
+    
+    std::cout << "PASSED\n";
+}
+
 int main() {
     Logger::instance().setLevel(LogLevel::Error);
     
@@ -138,7 +1375,26 @@ int main() {
     test_message_receiving();
     test_async_messaging();
     test_message_types();
+    test_priority_levels();
     test_no_messages();
+    test_queue_capacity();
+    test_flow_control();
+    test_concurrent_senders();
+    test_registry_churn();
+    test_payload_storage();
+    test_page_grants();
+    test_blocking_receive();
+    test_send_and_wait_reply();
+    test_synchronous_call();
+    test_async_calls();
+    test_selective_receive();
+    test_batched_messaging();
+    test_topics();
+    test_ports_and_wait_sets();
+    test_notifications();
+    test_remote_transport();
+    test_schema_messages();
+    test_channel_stats();
     
     std::cout << "\nAll IPC tests passed!\n\n";
     return 0;
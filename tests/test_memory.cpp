@@ -133,6 +133,45 @@ void test_page_fault_handling() {
     std::cout << "PASSED\n";
 }
 
+void test_shared_regions() {
+    std::cout << "Testing shared memory regions... ";
+    
+    MemoryManager mm;
+    mm.createAddressSpace(1);
+    mm.createAddressSpace(2);
+    size_t freeBefore = mm.getFreeFrameCount();
+    
+    RegionId region = mm.createSharedRegion(1, 4);
+    assert(region != INVALID_REGION_ID);
+    assert(mm.getFreeFrameCount() == freeBefore - 4);
+    
+    assert(mm.mapSharedRegion(region, 1, 10));
+    assert(mm.mapSharedRegion(region, 2, 50, MemoryProtection::Read));
+    assert(!mm.mapSharedRegion(region, 2, 60));
+    
+    assert(mm.translateAddress(1, 12) == mm.translateAddress(2, 52));
+    assert(mm.getProtection(2, 50) == MemoryProtection::Read);
+    assert(mm.freePage(1, 10) == false);
+    
+    auto base = mm.getRegionAddress(region);
+    assert(base.has_value());
+    
+    assert(mm.destroySharedRegion(region));
+    assert(mm.getSharedRegion(region) != nullptr);
+    
+    assert(mm.unmapSharedRegion(region, 1));
+    assert(!mm.translateAddress(1, 10).has_value());
+    assert(mm.getFreeFrameCount() == freeBefore - 4);
+    
+    mm.destroyAddressSpace(2);
+    assert(mm.getSharedRegion(region) == nullptr);
+    assert(mm.getFreeFrameCount() == freeBefore);
+    
+    mm.destroyAddressSpace(1);
+    
+    std::cout << "PASSED\n";
+}
+
 int main() {
     Logger::instance().setLevel(LogLevel::Error);
     
@@ -144,6 +183,7 @@ int main() {
     test_memory_protection();
     test_heap_allocator();
     test_page_fault_handling();
+    test_shared_regions();
     
     std::cout << "\nAll memory tests passed!\n\n";
     return 0;
@@ -1,6 +1,10 @@
 #include "scheduler/scheduler.hpp"
+#include "scheduler/uthread.hpp"
+#include "kernel/kernel.hpp"
 #include <iostream>
 #include <cassert>
+#include <thread>
+#include <vector>
 
 using namespace MiniOS;
 
@@ -108,6 +112,347 @@ void test_task_termination() {
     std::cout << "PASSED\n";
 }
 
+void test_direct_handoff() {
+    std::cout << "Testing direct handoff... ";
+    
+    Scheduler scheduler(SchedulerType::RoundRobin);
+    
+    TaskId client = scheduler.createTask("client", []() {});
+    TaskId server = scheduler.createTask("server", []() {});
+    TaskId other = scheduler.createTask("other", []() {});
+    
+    scheduler.schedule();
+    assert(scheduler.getCurrentTask()->id == client);
+    scheduler.tick();
+    scheduler.tick();
+    scheduler.blockTask(server);
+    
+    uint32_t remaining = scheduler.getTask(client)->timeSliceRemaining;
+    assert(scheduler.handoff(client, server, true));
+    assert(scheduler.getCurrentTask()->id == server);
+    assert(scheduler.getTask(client)->state == TaskState::Blocked);
+    assert(scheduler.getTask(server)->timeSliceRemaining == remaining);
+    assert(scheduler.getReadyQueueSize() == 1);
+    
+    assert(scheduler.handoff(server, client, false));
+    assert(scheduler.getCurrentTask()->id == client);
+    assert(scheduler.getTask(server)->state == TaskState::Ready);
+    assert(scheduler.getTask(other)->state == TaskState::Ready);
+    assert(scheduler.getHandoffCount() == 2);
+    
+    scheduler.terminateTask(other);
+    assert(!scheduler.handoff(client, other, false));
+    
+    std::cout << "PASSED\n";
+}
+
+void test_futex_wait_wake() {
+    std::cout << "Testing futex wait and wake... ";
+    
+    Scheduler scheduler(SchedulerType::RoundRobin);
+    TaskId waiterTask = scheduler.createTask("waiter", []() {});
+    std::atomic<int> blocked{0};
+    FutexTable futex;
+    futex.setBlockingHooks(
+        [&](TaskId id) { blocked++; scheduler.blockTask(id); },
+        [&](TaskId id) { scheduler.unblockTask(id); }
+    );
+    
+    const TaskId space = 1;
+    FutexWord word{0};
+    assert(futex.wait(waiterTask, space, &word, 1) == FutexStatus::ValueMismatch);
+    assert(futex.wait(waiterTask, space, &word, 0, std::chrono::steady_clock::now() + 
+                      std::chrono::milliseconds(5)) == FutexStatus::TimedOut);
+    assert(futex.getWaiterCount(space, &word) == 0);
+    
+    auto waitUntilQueued = [&](const FutexWord* w, size_t count) {
+        while (futex.getWaiterCount(space, w) < count) {
+            std::this_thread::yield();
+        }
+    };
+    
+    std::atomic<int> woken{0};
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 4; ++i) {
+        waiters.emplace_back([&, i]() {
+            uint32_t bitset = i < 2 ? 0x1 : 0x2;
+            if (futex.wait(waiterTask, space, &word, 0, NO_DEADLINE, bitset) == FutexStatus::Woken) {
+                woken++;
+            }
+        });
+    }
+    waitUntilQueued(&word, 4);
+    
+    assert(futex.wake(space + 1, &word, 4) == 0);
+    assert(futex.wake(space, &word, 4, 0x4) == 0);
+    assert(futex.wake(space, &word, 1, 0x2) == 1);
+    assert(futex.wake(space, &word, 8, 0x1) == 2);
+    assert(futex.getWaiterCount(space, &word) == 1);
+    
+    FutexWord target{0};
+    assert(!futex.requeue(space, &word, &target, 0, 8, 7u));
+    assert(futex.requeue(space, &word, &target, 0, 8, 0u) == 1u);
+    assert(futex.getWaiterCount(space, &target) == 1);
+    assert(futex.wake(space, &target, 1) == 1);
+    for (auto& t : waiters) {
+        t.join();
+    }
+    assert(woken == 4);
+    assert(blocked == 5);
+    assert(scheduler.getTask(waiterTask)->state == TaskState::Ready);
+    
+    std::cout << "PASSED\n";
+}
+
+void test_futex_user_locks() {
+    std::cout << "Testing futex-backed mutex and condition... ";
+    
+    Kernel& kernel = Kernel::instance();
+    assert(kernel.boot());
+    kernel.getScheduler().schedule();
+    FutexTable& futex = kernel.getFutexTable();
+    
+    FutexMutex mutex;
+    uint64_t before = futex.getSyscallCount();
+    for (int i = 0; i < 1000; ++i) {
+        mutex.lock();
+        mutex.unlock();
+    }
+    assert(mutex.try_lock());
+    mutex.unlock();
+    assert(futex.getSyscallCount() == before);
+    
+    uint64_t counter = 0;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < 10000; ++i) {
+                std::lock_guard<FutexMutex> lock(mutex);
+                counter++;
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    assert(counter == 40000);
+    
+    FutexCondition ready;
+    bool go = false;
+    int running = 0;
+    std::vector<std::thread> consumers;
+    for (int t = 0; t < 3; ++t) {
+        consumers.emplace_back([&]() {
+            std::lock_guard<FutexMutex> lock(mutex);
+            while (!go) {
+                ready.wait(mutex);
+            }
+            running++;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+        std::lock_guard<FutexMutex> lock(mutex);
+        go = true;
+        ready.notifyAll(mutex);
+    }
+    for (auto& t : consumers) {
+        t.join();
+    }
+    assert(running == 3);
+    
+    mutex.lock();
+    assert(!ready.waitUntil(mutex, std::chrono::steady_clock::now() + std::chrono::milliseconds(5)));
+    mutex.unlock();
+
+    // The kernel takes the waiter from the current task at entry: blocking
+    // it switches the scheduler to another task, and that task's wake must
+    // still find the waiter.
+    Scheduler& scheduler = kernel.getScheduler();
+    scheduler.createTask("futex_holder", []() {});
+    TaskId waiter = scheduler.createTask("futex_waiter", []() {});
+    assert(mutex.lock());
+    TaskControlBlock* current = scheduler.getCurrentTask();
+    assert(scheduler.handoff(current ? current->id : INVALID_TASK_ID, waiter, false));
+    bool acquired = false;
+    std::thread contender([&]() {
+        assert(mutex.lock());
+        acquired = true;
+        mutex.unlock();
+    });
+    while (scheduler.getTask(waiter)->state != TaskState::Blocked) {
+        std::this_thread::yield();
+    }
+    mutex.unlock();
+    contender.join();
+    assert(acquired);
+    assert(scheduler.getTask(waiter)->state != TaskState::Blocked);
+    kernel.shutdown();
+
+    // Once the kernel halts the contended path fails instead of spinning.
+    FutexMutex orphan;
+    assert(orphan.lock());
+    std::thread refused([&orphan]() { assert(!orphan.lock()); });
+    refused.join();
+    orphan.unlock();
+    
+    std::cout << "PASSED\n";
+}
+
+void test_uthread_runtime() {
+    std::cout << "Testing M:N user-level threads... ";
+    
+    Scheduler scheduler(SchedulerType::RoundRobin);
+    {
+        UThreadConfig config;
+        config.scheduler = &scheduler;
+        UThreadRuntime runtime(config);
+        assert(scheduler.getTotalTasks() == runtime.getCarrierCount());
+        
+        std::atomic<uint64_t> steps{0};
+        runtime.spawn([&]() {
+            for (int i = 0; i < 2000; ++i) {
+                UThreadRuntime::current()->runtime->spawn([&]() {
+                    for (int j = 0; j < 10; ++j) {
+                        steps++;
+                        UThreadRuntime::yield();
+                    }
+                });
+            }
+        });
+        runtime.waitAll();
+        assert(steps == 20000);
+        assert(runtime.getLiveCount() == 0);
+        assert(runtime.getStealCount() > 0);
+        
+        UThread* sleeper = nullptr;
+        std::atomic<int> rounds{0};
+        std::atomic<bool> ready{false};
+        runtime.spawn([&]() {
+            sleeper = UThreadRuntime::current();
+            ready = true;
+            while (rounds < 100) {
+                UThreadRuntime::park();
+            }
+        });
+        runtime.spawn([&]() {
+            while (!ready) {
+                UThreadRuntime::yield();
+            }
+            for (int i = 0; i < 100; ++i) {
+                rounds++;
+                UThreadRuntime::unpark(sleeper);
+                UThreadRuntime::yield();
+            }
+        });
+        runtime.waitAll();
+        assert(rounds == 100);
+    }
+    
+    UThreadConfig single;
+    single.carriers = 1;
+    single.blockingThreads = 16;
+    UThreadRuntime runtime(single);
+    
+    std::atomic<int> slept{0};
+    std::atomic<uint64_t> spins{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 32; ++i) {
+        runtime.spawn([&]() {
+            int value = UThreadRuntime::blocking([]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return 1;
+            });
+            slept += value;
+        });
+    }
+    runtime.spawn([&]() {
+        while (slept < 32) {
+            spins++;
+            UThreadRuntime::yield();
+        }
+    });
+    runtime.waitAll();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert(slept == 32);
+    assert(spins > 0);
+    assert(elapsed < std::chrono::milliseconds(32 * 20 / 2));
+    
+    // Threads that have not run yet are bare control blocks.
+    const size_t million = 1000000;
+    std::atomic<size_t> finished{0};
+    size_t peakLive = 0;
+    runtime.spawn([&]() {
+        for (size_t i = 0; i < million; ++i) {
+            runtime.spawn([&finished]() { finished++; });
+        }
+        peakLive = runtime.getLiveCount();
+    });
+    runtime.waitAll();
+    assert(peakLive == million + 1);
+    assert(finished == million);
+
+    // Threads that have run and parked each keep a stack.
+    const size_t parkedCount = 20000;
+    std::vector<UThread*> parked(parkedCount);
+    std::atomic<size_t> arrived{0};
+    std::atomic<bool> release{false};
+    std::atomic<size_t> resumed{0};
+    for (size_t i = 0; i < parkedCount; ++i) {
+        runtime.spawn([&, i]() {
+            parked[i] = UThreadRuntime::current();
+            arrived++;
+            while (!release) {
+                UThreadRuntime::park();
+            }
+            resumed++;
+        });
+    }
+    size_t liveWhileParked = 0;
+    runtime.spawn([&]() {
+        while (arrived < parkedCount) {
+            UThreadRuntime::yield();
+        }
+        liveWhileParked = runtime.getLiveCount();
+        release = true;
+        for (UThread* thread : parked) {
+            UThreadRuntime::unpark(thread);
+        }
+    });
+    runtime.waitAll();
+    assert(liveWhileParked == parkedCount + 1);
+    assert(resumed == parkedCount);
+
+    // More blocking calls that wait on each other than starting helpers.
+    UThreadConfig narrow;
+    narrow.carriers = 1;
+    narrow.blockingThreads = 2;
+    UThreadRuntime pool(narrow);
+    const int blockers = 8;
+    std::atomic<int> waiting{0};
+    std::atomic<int> passed{0};
+    for (int i = 0; i < blockers; ++i) {
+        pool.spawn([&]() {
+            bool all = UThreadRuntime::blocking([&]() {
+                waiting++;
+                auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (waiting < blockers && std::chrono::steady_clock::now() < giveUp) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                return waiting == blockers;
+            });
+            if (all) {
+                passed++;
+            }
+        });
+    }
+    pool.waitAll();
+    assert(passed == blockers);
+    assert(pool.getBlockingThreadCount() >= static_cast<size_t>(blockers));
+    
+    std::cout << "PASSED\n";
+}
+
 int main() {
     Logger::instance().setLevel(LogLevel::Error);
     
@@ -118,6 +463,10 @@ int main() {
     test_round_robin();
     test_priority_scheduling();
     test_task_termination();
+    test_direct_handoff();
+    test_futex_wait_wake();
+    test_futex_user_locks();
+    test_uthread_runtime();
     
     std::cout << "\nAll scheduler tests passed!\n\n";
     return 0;